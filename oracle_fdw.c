@@ -8,20 +8,28 @@
 #include "postgres.h"
 
 #include "fmgr.h"
+#include "funcapi.h"
+#include "access/genam.h"
 #include "access/htup_details.h"
 #include "access/reloptions.h"
 #include "access/sysattr.h"
+#if PG_VERSION_NUM >= 120000
+#include "access/table.h"
+#endif  /* PG_VERSION_NUM */
 #include "access/xact.h"
 #include "catalog/indexing.h"
+#include "catalog/pg_aggregate.h"
 #include "catalog/pg_attribute.h"
 #include "catalog/pg_cast.h"
 #include "catalog/pg_collation.h"
 #include "catalog/pg_foreign_data_wrapper.h"
 #include "catalog/pg_foreign_server.h"
 #include "catalog/pg_foreign_table.h"
+#include "catalog/pg_inherits.h"
 #include "catalog/pg_namespace.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_proc.h"
+#include "catalog/pg_statistic.h"
 #include "catalog/pg_user_mapping.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
@@ -36,6 +44,35 @@
 #include "commands/explain_format.h"
 #endif  /* PG_VERSION_NUM */
 #include "commands/vacuum.h"
+/* overflow checks for integer arithmetic are new in v11, backport */
+#if PG_VERSION_NUM >= 110000
+#include "common/int.h"
+#else
+static inline bool
+pg_add_s32_overflow(int32 a, int32 b, int32 *result)
+{
+	int64 res = (int64) a + (int64) b;
+
+	if (res > INT_MAX || res < INT_MIN)
+		return true;
+	*result = (int32) res;
+	return false;
+}
+
+static inline bool
+pg_mul_s32_overflow(int32 a, int32 b, int32 *result)
+{
+	int64 res = (int64) a * (int64) b;
+
+	if (res > INT_MAX || res < INT_MIN)
+		return true;
+	*result = (int32) res;
+	return false;
+}
+#endif  /* PG_VERSION_NUM */
+#if PG_VERSION_NUM >= 140000
+#include "executor/execAsync.h"
+#endif  /* PG_VERSION_NUM */
 #include "foreign/fdwapi.h"
 #include "foreign/foreign.h"
 /* for "hash_bytes_extended" or "hash_bytes" */
@@ -57,6 +94,9 @@
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
+#if PG_VERSION_NUM >= 160000
+#include "nodes/miscnodes.h"
+#endif  /* PG_VERSION_NUM */
 #include "nodes/nodeFuncs.h"
 #include "nodes/pg_list.h"
 #include "optimizer/cost.h"
@@ -66,8 +106,8 @@
 #include "optimizer/pathnode.h"
 #if PG_VERSION_NUM >= 130000
 #include "optimizer/inherit.h"
-#include "optimizer/paths.h"
 #endif  /* PG_VERSION_NUM */
+#include "optimizer/paths.h"
 #include "optimizer/planmain.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
@@ -75,7 +115,16 @@
 #include "parser/parsetree.h"
 #include "pgtime.h"
 #include "port.h"
+#if PG_VERSION_NUM >= 100000
+#include "port/atomics.h"
+#endif  /* PG_VERSION_NUM */
+#if PG_VERSION_NUM >= 140000
+#include "storage/fd.h"
+#endif  /* PG_VERSION_NUM */
 #include "storage/ipc.h"
+#if PG_VERSION_NUM >= 140000
+#include "storage/latch.h"
+#endif  /* PG_VERSION_NUM */
 #include "storage/lock.h"
 #include "tcop/tcopprot.h"
 #include "utils/array.h"
@@ -87,13 +136,17 @@
 #include "utils/fmgroids.h"
 #include "utils/formatting.h"
 #include "utils/guc.h"
+#include "utils/hsearch.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/numeric.h"
 #include "utils/rel.h"
 #include "utils/resowner.h"
+#include "utils/selfuncs.h"
 #include "utils/timestamp.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
+#include "utils/typcache.h"
 #include "utils/timestamp.h"
 #if PG_VERSION_NUM < 120000
 #include "nodes/relation.h"
@@ -105,8 +158,14 @@
 #include "access/heapam.h"
 #endif
 
+#include <float.h>
+#include <limits.h>
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
 #include "oracle_fdw.h"
 
@@ -140,6 +199,42 @@
 #undef JOIN_API
 #endif  /* PG_VERSION_NUM */
 
+/* direct modification of foreign tables is new in v9.6 */
+#if PG_VERSION_NUM >= 90600
+#define DIRECT_MODIFY_API
+#else
+#undef DIRECT_MODIFY_API
+#endif  /* PG_VERSION_NUM */
+
+/*
+ * Asynchronous Append needs a file descriptor to wait for, and we use a pipe
+ * for that.  On Windows, only sockets can be waited for.
+ */
+#if PG_VERSION_NUM >= 140000 && !defined(WIN32)
+#define ASYNC_API
+#else
+#undef ASYNC_API
+#endif  /* PG_VERSION_NUM */
+
+/* parallel scans need ReInitializeDSMForeignScan, which is new in v10 */
+#if PG_VERSION_NUM >= 100000
+#define PARALLEL_API
+#else
+#undef PARALLEL_API
+#endif  /* PG_VERSION_NUM */
+
+/* aggregate pushdown needs the grouping target of the upper relation, new in v10 */
+#if PG_VERSION_NUM >= 100000
+#define UPPER_API
+
+/* the useful macro IS_UPPER_REL is defined in v11, backport */
+#ifndef IS_UPPER_REL
+#define IS_UPPER_REL(rel) ((rel)->reloptkind == RELOPT_UPPER_REL)
+#endif
+#else
+#undef UPPER_API
+#endif  /* PG_VERSION_NUM */
+
 #if PG_VERSION_NUM < 110000
 /* backport macro from V11 */
 #define TupleDescAttr(tupdesc, i) ((tupdesc)->attrs[(i)])
@@ -160,6 +255,16 @@
 #define table_close(x, y) heap_close(x, y)
 #endif  /* PG_VERSION_NUM */
 
+/*
+ * These macros identify the element types of array parameters
+ * that can be bound as Oracle collections of NUMBER or VARCHAR2.
+ * "character" is not among them, because PostgreSQL ignores trailing
+ * blanks when comparing such values, but Oracle does not for VARCHAR2.
+ */
+#define isNumberArrayElem(x) ((x) == INT2OID || (x) == INT4OID || (x) == INT8OID \
+			|| (x) == FLOAT4OID || (x) == FLOAT8OID || (x) == NUMERICOID)
+#define isStringArrayElem(x) ((x) == TEXTOID || (x) == VARCHAROID)
+
 #if PG_VERSION_NUM >= 180000
 PG_MODULE_MAGIC_EXT(.name = "oracle_fdw", .version = ORACLE_FDW_VERSION);
 #else
@@ -171,6 +276,31 @@ PG_MODULE_MAGIC;
  */
 static bool dml_in_transaction = false;
 
+/*
+ * Cache for the estimates of the Oracle optimizer with "use_remote_estimate",
+ * so that planning the same query again needs no round trip.
+ * The key is a hash of the connect string, the user and the query.
+ */
+struct remoteEstimate
+{
+	uint64 key;
+	double rows;   /* estimated number of result rows */
+	int width;     /* estimated average width of a result row */
+	double cost;   /* Oracle's cost, measured in single block reads */
+};
+
+static HTAB *remote_estimates = NULL;
+
+/*
+ * A value from an Oracle frequency histogram and its frequency,
+ * used to sort the most common values imported with "import_statistics".
+ */
+struct mcvItem
+{
+	Datum value;
+	float4 freq;
+};
+
 /*
  * PostGIS geometry type, set in initializePostGIS().
  */
@@ -203,6 +333,16 @@ struct OracleFdwOption
 #define OPT_SAMPLE "sample_percent"
 #define OPT_PREFETCH "prefetch"
 #define OPT_LOB_PREFETCH "lob_prefetch"
+#define OPT_FETCH_MEMORY "fetch_memory"
+#define OPT_PIPELINE_FETCH "pipeline_fetch"
+#define OPT_ASYNC_CAPABLE "async_capable"
+#define OPT_USE_REMOTE_ESTIMATE "use_remote_estimate"
+#define OPT_PARALLEL_WORKERS "parallel_workers"
+#define OPT_BATCH_SIZE "batch_size"
+#define OPT_LOAD_MODE "load_mode"
+#define OPT_TRUNCATABLE "truncatable"
+#define OPT_TRUNCATE_STORAGE "truncate_storage"
+#define OPT_IMPORT_STATISTICS "import_statistics"
 #define OPT_SET_TIMEZONE "set_timezone"
 /* these options are only for IMPORT FOREIGN SCHEMA */
 #define OPT_CASE "case"
@@ -216,6 +356,16 @@ struct OracleFdwOption
 #define DEFAULT_PREFETCH 50
 #define MAXIMUM_PREFETCH 10240
 #define DEFAULT_LOB_PREFETCH 1048576
+/* maximum "fetch_memory" in kilobytes (1GB) */
+#define MAXIMUM_FETCH_MEMORY 1048576
+/* upper limit for the number of rows fetched with "fetch_memory" */
+#define MAXIMUM_FETCH_ROWS 1048576
+#define MAXIMUM_PARALLEL_WORKERS 1024
+#define MAXIMUM_BATCH_SIZE 10240
+/* without "sample_percent", ANALYZE fetches about that many times the rows it needs */
+#define AUTO_SAMPLE_FACTOR 3
+/* the SAMPLE clause is written with "%f", so Oracle sees the percentage rounded like this */
+#define ROUND_SAMPLE_PERCENT(x) (rint((x) * 1000000.0) / 1000000.0)
 
 /*
  * Options for case folding for names in IMPORT FOREIGN TABLE.
@@ -240,6 +390,23 @@ static struct OracleFdwOption valid_options[] = {
 	{OPT_SAMPLE, ForeignTableRelationId, false},
 	{OPT_PREFETCH, ForeignTableRelationId, false},
 	{OPT_LOB_PREFETCH, ForeignTableRelationId, false},
+	{OPT_FETCH_MEMORY, ForeignServerRelationId, false},
+	{OPT_FETCH_MEMORY, ForeignTableRelationId, false},
+	{OPT_PIPELINE_FETCH, ForeignTableRelationId, false},
+	{OPT_ASYNC_CAPABLE, ForeignServerRelationId, false},
+	{OPT_ASYNC_CAPABLE, ForeignTableRelationId, false},
+	{OPT_USE_REMOTE_ESTIMATE, ForeignServerRelationId, false},
+	{OPT_USE_REMOTE_ESTIMATE, ForeignTableRelationId, false},
+	{OPT_PARALLEL_WORKERS, ForeignTableRelationId, false},
+	{OPT_BATCH_SIZE, ForeignServerRelationId, false},
+	{OPT_BATCH_SIZE, ForeignTableRelationId, false},
+	{OPT_LOAD_MODE, ForeignTableRelationId, false},
+	{OPT_TRUNCATABLE, ForeignServerRelationId, false},
+	{OPT_TRUNCATABLE, ForeignTableRelationId, false},
+	{OPT_TRUNCATE_STORAGE, ForeignServerRelationId, false},
+	{OPT_TRUNCATE_STORAGE, ForeignTableRelationId, false},
+	{OPT_IMPORT_STATISTICS, ForeignServerRelationId, false},
+	{OPT_IMPORT_STATISTICS, ForeignTableRelationId, false},
 	{OPT_KEY, AttributeRelationId, false},
 	{OPT_STRIP_ZEROS, AttributeRelationId, false},
 	{OPT_SET_TIMEZONE, ForeignServerRelationId, false}
@@ -255,6 +422,51 @@ static struct OracleFdwOption valid_options[] = {
 
 static regproc *output_funcs;
 
+/*
+ * Value of the "oracle_fdw.fetch_memory" parameter, the default for
+ * the "fetch_memory" option (in kilobytes, 0 means "not set").
+ */
+static int default_fetch_memory = 0;
+
+/*
+ * How a result column has to be converted to a PostgreSQL Datum.
+ */
+typedef enum
+{
+	CONV_NONE,       /* column is not fetched, always NULL */
+	CONV_GEOMETRY,   /* SDO_GEOMETRY to PostGIS geometry */
+	CONV_BYTEA,      /* binary data, copied as they are */
+	CONV_BOOL,       /* "0" is FALSE, everything else is TRUE */
+	CONV_INTEGER,    /* OCINumber to an integer type */
+	CONV_NUMERIC,    /* OCINumber to numeric */
+	CONV_FLOAT4,     /* binary float or double to real */
+	CONV_FLOAT8,     /* binary float or double to double precision */
+	CONV_DATE,       /* binary DATE or TIMESTAMP to date */
+	CONV_TIMESTAMP,  /* binary DATE or TIMESTAMP to timestamp */
+	CONV_TIMESTAMPTZ,  /* binary DATE or TIMESTAMP to timestamp with time zone */
+	CONV_INTERVAL,   /* binary INTERVAL to interval */
+	CONV_STRING,     /* string types, need encoding check and optionally stripping zeros */
+	CONV_INPUT       /* call the type input function */
+} convKind;
+
+/*
+ * Per-column information that convertTuple needs to convert Oracle values.
+ * This is computed once per scan or modification by initConverters,
+ * so that no catalog lookups have to be done for each result row.
+ */
+struct oraConverter
+{
+	convKind kind;
+	bool is_lob;          /* value is a LOB locator */
+	bool is_long;         /* value is LONG or LONG RAW with a length prefix */
+	bool is_number;       /* NUMBER or FLOAT, needs "infinity tilde" handling */
+	bool is_interval_ds;  /* INTERVAL DAY TO SECOND, needs sign handling */
+	bool strip_zeros;     /* strip zero bytes from string values */
+	FmgrInfo typinput;    /* type input function */
+	Oid typioparam;       /* type I/O parameter for the input function */
+	int32 typmod;         /* type modifier passed to the input function */
+};
+
 /*
  * FDW-specific information for RelOptInfo.fdw_private and ForeignScanState.fdw_state.
  * The same structure is used to hold information for query planning and execution.
@@ -280,12 +492,32 @@ struct OracleFdwState {
 	Cost total_cost;               /* cost estimate, only needed for planning */
 	unsigned int prefetch;         /* number of rows to prefetch */
 	unsigned int lob_prefetch;     /* number of LOB bytes to prefetch */
+	unsigned int batch_size;       /* number of rows inserted with one statement */
+	char *load_schema;             /* Oracle schema for a direct path load */
+	char *load_table;              /* Oracle table for a direct path load, else NULL */
+	bool direct_path;              /* is a direct path load in progress? */
+	unsigned int queued_rows;      /* rows of a batched UPDATE or DELETE not yet sent */
+	CmdType queued_operation;      /* operation of the queued rows */
+	unsigned int fetch_memory;     /* memory for fetched rows in kB, 0 if "prefetch" is used */
+	unsigned int fetch_size;       /* number of rows to fetch in the next batch */
+	bool pipeline_fetch;           /* fetch the next rows while the current ones are processed */
+	bool async_capable;            /* can be scanned asynchronously, only needed for planning */
+	bool use_remote_estimate;      /* ask the Oracle optimizer for estimates, only needed for planning */
+	bool async_execution;          /* the scan is executed asynchronously */
+	bool executed;                 /* has the query been executed since the last rescan? */
+	int wait_fd;                   /* always readable, for waiting in an asynchronous Append */
+	int parallel_workers;          /* workers for a parallel scan, only needed for planning */
+	int parallel_slices;           /* number of slices of a parallel scan, else 0 */
+	struct OracleParallelScan *pscan;  /* shared state of a parallel scan */
+	bool pscan_local;              /* is pscan in local memory rather than shared? */
+	int slice;                     /* slice of the table currently scanned */
 	unsigned long rowcount;        /* rows already read from Oracle */
 	int columnindex;               /* currently processed column for error context */
 	MemoryContext temp_cxt;        /* short-lived memory for data modification */
 	char *order_clause;            /* for ORDER BY pushdown */
 	List *usable_pathkeys;         /* for ORDER BY pushdown */
 	char *where_clause;            /* deparsed where clause */
+	struct oraConverter *converters;  /* per-column conversion information */
 
 	/*
 	 * Restriction clauses, divided into safe and unsafe to pushdown subsets.
@@ -308,6 +540,22 @@ struct OracleFdwState {
 	RelOptInfo *innerrel;
 	JoinType    jointype;
 	List       *joinclauses;
+	bool        pushdown_safe;  /* can the relation be used in a pushed down aggregation? */
+
+	/* Aggregation information, "outerrel" is the relation that is grouped */
+	List       *grouped_tlist;  /* grouping expressions and aggregates */
+	char       *group_clause;   /* deparsed GROUP BY and HAVING clauses */
+
+	/* LIMIT pushdown */
+	int         server_major;   /* Oracle server major version, only needed for planning */
+	char       *limit_clause;   /* deparsed LIMIT and OFFSET */
+	unsigned int limit_rows;    /* maximal number of rows with LIMIT, else 0 */
+
+	/* direct modification */
+	bool        set_processed;  /* count the modified rows for the command status? */
+
+	/* INSERT ... ON CONFLICT DO NOTHING */
+	bool        do_nothing;     /* is the INSERT executed as MERGE? */
 };
 
 /*
@@ -330,6 +578,31 @@ PG_FUNCTION_INFO_V1(oracle_execute);
  */
 extern PGDLLEXPORT void _PG_init(void);
 
+#ifdef PARALLEL_API
+/*
+ * Shared state of a parallel foreign scan, kept in dynamic shared memory.
+ * The table is split into "parallel_slices" slices by a hash of the ROWID,
+ * and each participant scans the next slice that nobody has taken yet.
+ */
+struct OracleParallelScan
+{
+	char scn[41];                /* all slices are read as of this SCN */
+	pg_atomic_uint32 next_slice; /* next slice to scan */
+};
+#endif  /* PARALLEL_API */
+
+#ifdef JOIN_API
+/*
+ * State for ecMemberMatchesForeign while looking for
+ * equivalence class members that are columns of a foreign table.
+ */
+struct ecMemberArg
+{
+	Expr *current;       /* the column currently considered */
+	List *already_used;  /* columns that have been considered before */
+};
+#endif  /* JOIN_API */
+
 /*
  * FDW callback routines
  */
@@ -338,6 +611,13 @@ static void oracleGetForeignPaths(PlannerInfo *root, RelOptInfo *baserel, Oid fo
 #ifdef JOIN_API
 static void oracleGetForeignJoinPaths(PlannerInfo *root, RelOptInfo *joinrel, RelOptInfo *outerrel, RelOptInfo *innerrel, JoinType jointype, JoinPathExtraData *extra);
 #endif  /* JOIN_API */
+#ifdef UPPER_API
+static void oracleGetForeignUpperPaths(PlannerInfo *root, UpperRelationKind stage, RelOptInfo *input_rel, RelOptInfo *output_rel
+#if PG_VERSION_NUM >= 110000
+, void *extra
+#endif  /* PG_VERSION_NUM */
+);
+#endif  /* UPPER_API */
 static ForeignScan *oracleGetForeignPlan(PlannerInfo *root, RelOptInfo *foreignrel, Oid foreigntableid, ForeignPath *best_path, List *tlist, List *scan_clauses
 #if PG_VERSION_NUM >= 90500
 , Plan *outer_plan
@@ -349,6 +629,9 @@ static void oracleBeginForeignScan(ForeignScanState *node, int eflags);
 static TupleTableSlot *oracleIterateForeignScan(ForeignScanState *node);
 static void oracleEndForeignScan(ForeignScanState *node);
 static void oracleReScanForeignScan(ForeignScanState *node);
+#ifdef JOIN_API
+static bool oracleRecheckForeignScan(ForeignScanState *node, TupleTableSlot *slot);
+#endif  /* JOIN_API */
 #if PG_VERSION_NUM < 140000
 static void oracleAddForeignUpdateTargets(Query *parsetree, RangeTblEntry *target_rte, Relation target_relation);
 #else
@@ -361,14 +644,41 @@ static void oracleBeginForeignInsert(ModifyTableState *mtstate, ResultRelInfo *r
 static void oracleEndForeignInsert(EState *estate, ResultRelInfo *rinfo);
 #endif  /*PG_VERSION_NUM */
 static TupleTableSlot *oracleExecForeignInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *slot, TupleTableSlot *planSlot);
+#if PG_VERSION_NUM >= 140000
+static int oracleGetForeignModifyBatchSize(ResultRelInfo *rinfo);
+static TupleTableSlot **oracleExecForeignBatchInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot **slots, TupleTableSlot **planSlots, int *numSlots);
+#endif  /* PG_VERSION_NUM >= 140000 */
 static TupleTableSlot *oracleExecForeignUpdate(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *slot, TupleTableSlot *planSlot);
 static TupleTableSlot *oracleExecForeignDelete(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *slot, TupleTableSlot *planSlot);
 static void oracleEndForeignModify(EState *estate, ResultRelInfo *rinfo);
 static void oracleExplainForeignModify(ModifyTableState *mtstate, ResultRelInfo *rinfo, List *fdw_private, int subplan_index, struct ExplainState *es);
+#ifdef DIRECT_MODIFY_API
+static bool oraclePlanDirectModify(PlannerInfo *root, ModifyTable *plan, Index resultRelation, int subplan_index);
+static void oracleBeginDirectModify(ForeignScanState *node, int eflags);
+static TupleTableSlot *oracleIterateDirectModify(ForeignScanState *node);
+static void oracleEndDirectModify(ForeignScanState *node);
+static void oracleExplainDirectModify(ForeignScanState *node, struct ExplainState *es);
+#endif  /* DIRECT_MODIFY_API */
+#if PG_VERSION_NUM >= 140000
+static void oracleExecForeignTruncate(List *rels, DropBehavior behavior, bool restart_seqs);
+#endif  /* PG_VERSION_NUM >= 140000 */
 static int oracleIsForeignRelUpdatable(Relation rel);
 #ifdef IMPORT_API
 static List *oracleImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid);
 #endif  /* IMPORT_API */
+#ifdef PARALLEL_API
+static bool oracleIsForeignScanParallelSafe(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte);
+static Size oracleEstimateDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt);
+static void oracleInitializeDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt, void *coordinate);
+static void oracleReInitializeDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt, void *coordinate);
+static void oracleInitializeWorkerForeignScan(ForeignScanState *node, shm_toc *toc, void *coordinate);
+#endif  /* PARALLEL_API */
+#ifdef ASYNC_API
+static bool oracleIsForeignPathAsyncCapable(ForeignPath *path);
+static void oracleForeignAsyncRequest(AsyncRequest *areq);
+static void oracleForeignAsyncConfigureWait(AsyncRequest *areq);
+static void oracleForeignAsyncNotify(AsyncRequest *areq);
+#endif  /* ASYNC_API */
 
 /*
  * Helper functions
@@ -376,6 +686,7 @@ static List *oracleImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid server
 static struct OracleFdwState *getFdwState(Oid foreigntableid, double *sample_percent, Oid userid);
 static void oracleGetOptions(Oid foreigntableid, Oid userid, List **options);
 static char *createQuery(struct OracleFdwState *fdwState, RelOptInfo *foreignrel, bool for_update, List *query_pathkeys);
+static void getRemoteEstimate(struct OracleFdwState *fdwState, RelOptInfo *foreignrel, double *rows, int *width, Cost *cost);
 static void deparseFromExprForRel(struct OracleFdwState *fdwState, StringInfo buf, RelOptInfo *joinrel, List **params_list);
 #ifdef JOIN_API
 static void appendConditions(List *exprs, StringInfo buf, RelOptInfo *joinrel, List **params_list);
@@ -383,9 +694,49 @@ static bool foreign_join_ok(PlannerInfo *root, RelOptInfo *joinrel, JoinType joi
 static const char *get_jointype_name(JoinType jointype);
 static List *build_tlist_to_deparse(RelOptInfo *foreignrel);
 static struct oraTable *build_join_oratable(struct OracleFdwState *fdwState, List *fdw_scan_tlist);
+static struct oraColumn *build_join_column(struct OracleFdwState *fdwState, Index varno, AttrNumber attnum, int pgattnum);
+static struct oraTable *getBaseOraTable(RelOptInfo *rel, Index varno);
 #endif  /* JOIN_API */
+#ifdef UPPER_API
+static bool foreign_grouping_ok(PlannerInfo *root, RelOptInfo *grouped_rel, RelOptInfo *input_rel, PathTarget *grouping_target, List *havingQual);
+static char *deparseGroupingValue(RelOptInfo *input_rel, Expr *expr, List **params);
+static struct oraColumn *build_grouping_column(RelOptInfo *input_rel, Expr *expr, char *deparsed, int pgattnum);
+#if PG_VERSION_NUM >= 120000
+static void add_foreign_ordered_state(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ordered_rel);
+static void add_foreign_final_paths(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *final_rel, FinalPathExtraData *extra);
+static bool getLimitValue(Node *node, int64 *value);
+#endif  /* PG_VERSION_NUM */
+#endif  /* UPPER_API */
 static void getColumnData(Oid foreigntableid, struct oraTable *oraTable);
+static void setFetchType(struct oraColumn *column);
+static unsigned int getFetchRows(struct OracleFdwState *fdw_state);
+static bool canPipelineFetch(struct OracleFdwState *fdw_state);
+#ifdef JOIN_API
+static void addParameterizedPaths(PlannerInfo *root, RelOptInfo *baserel, struct OracleFdwState *fdwState);
+static bool ecMemberMatchesForeign(PlannerInfo *root, RelOptInfo *rel, EquivalenceClass *ec, EquivalenceMember *em, void *arg);
+static void addParamPathInfo(PlannerInfo *root, RelOptInfo *baserel, struct OracleFdwState *fdwState, RestrictInfo *rinfo, List **ppi_list);
+#endif  /* JOIN_API */
+static void createScanParams(ForeignScanState *node, struct OracleFdwState *fdw_state);
+static void executeForeignScan(ForeignScanState *node);
+#ifdef DIRECT_MODIFY_API
+static ForeignScan *findModifySubplan(ModifyTable *plan, Index resultRelation, int subplan_index);
+#endif  /* DIRECT_MODIFY_API */
+#ifdef PARALLEL_API
+static bool getNextSlice(struct OracleFdwState *fdw_state);
+#endif  /* PARALLEL_API */
+#ifdef ASYNC_API
+static void produceTupleAsync(AsyncRequest *areq, bool wait);
+static int createWaitFd(EState *estate, struct OracleFdwState *fdw_state);
+static void closeWaitFd(void *arg);
+#endif  /* ASYNC_API */
 static int acquireSampleRowsFunc (Relation relation, int elevel, HeapTuple *rows, int targrows, double *totalrows, double *totaldeadrows);
+static double getRemoteRowCount(Relation relation, oracleSession *session);
+static bool importStatistics(Relation relation, struct OracleFdwState *fdw_state, int elevel, double *totalrows);
+static bool isInheritanceChild(Oid relid);
+static bool importColumnStatistics(Relation relation, oracleSession *session, char *schema, char *table, struct oraColumn *col, double num_rows);
+static bool convertStatisticsValue(FmgrInfo *flinfo, Oid typioparam, struct oraColumn *col, char *value, Datum *result);
+static int compareMCV(const void *a, const void *b);
+static void storeColumnStatistics(Relation relation, AttrNumber attnum, float4 nullfrac, int32 width, float4 ndistinct, int nvalues, Datum *values, float4 *freqs);
 static void appendAsType(StringInfoData *dest, const char *s, Oid type);
 static char *deparseExpr(oracleSession *session, RelOptInfo *foreignrel, Expr *expr, const struct oraTable *oraTable, List **params, bool check_only);
 static char *datumToString(Datum datum, Oid type);
@@ -408,14 +759,24 @@ static struct OracleFdwState *copyPlanData(struct OracleFdwState *orig);
 static void subtransactionCallback(SubXactEvent event, SubTransactionId mySubid, SubTransactionId parentSubid, void *arg);
 static void addParam(struct paramDesc **paramList, char *name, Oid pgtype, oraType oratype, int colnum);
 static void setModifyParameters(struct paramDesc *paramList, TupleTableSlot *newslot, TupleTableSlot *oldslot, struct oraTable *oraTable, oracleSession *session);
+static bool canBatchModify(ResultRelInfo *rinfo);
+static void queueModifyRow(struct OracleFdwState *fdw_state, CmdType operation, TupleTableSlot *slot, TupleTableSlot *planSlot);
+static void flushModifyBatch(struct OracleFdwState *fdw_state);
 static void transactionCallback(XactEvent event, void *arg);
 static void exitHook(int code, Datum arg);
 static void oracleDie(SIGNAL_ARGS);
 static char *setSelectParameters(struct paramDesc *paramList, ExprContext *econtext);
-static void convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values, bool *nulls);
+static char *deparseArrayParam(Datum datum, bool is_null);
+static void initConverters(struct OracleFdwState *fdw_state);
+static void convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *tuple_values, bool *tuple_nulls);
+static void buildWholeRows(struct OracleFdwState *fdw_state, Datum *values, bool *nulls, Datum *tuple_values, bool *tuple_nulls);
+static Datum numberToNumeric(const unsigned char *number);
+static bool getDateTime(oracleSession *session, oraFetchType fetchtype, char *value, struct pg_tm *tm, fsec_t *fsec, int *tz);
 static void errorContextCallback(void *arg);
 static bool hasTrigger(Relation rel, CmdType cmdtype);
+static void appendOracleName(StringInfo buf, const char *name);
 static void buildInsertQuery(StringInfo sql, struct OracleFdwState *fdwState);
+static void buildMergeQuery(StringInfo sql, struct OracleFdwState *fdwState);
 static void buildUpdateQuery(StringInfo sql, struct OracleFdwState *fdwState, List *targetAttrs);
 static void appendReturningClause(StringInfo sql, struct OracleFdwState *fdwState);
 #ifdef IMPORT_API
@@ -458,12 +819,18 @@ oracle_fdw_handler(PG_FUNCTION_ARGS)
 #ifdef JOIN_API
 	fdwroutine->GetForeignJoinPaths = oracleGetForeignJoinPaths;
 #endif  /* JOIN_API */
+#ifdef UPPER_API
+	fdwroutine->GetForeignUpperPaths = oracleGetForeignUpperPaths;
+#endif  /* UPPER_API */
 	fdwroutine->GetForeignPlan = oracleGetForeignPlan;
 	fdwroutine->AnalyzeForeignTable = oracleAnalyzeForeignTable;
 	fdwroutine->ExplainForeignScan = oracleExplainForeignScan;
 	fdwroutine->BeginForeignScan = oracleBeginForeignScan;
 	fdwroutine->IterateForeignScan = oracleIterateForeignScan;
 	fdwroutine->ReScanForeignScan = oracleReScanForeignScan;
+#ifdef JOIN_API
+	fdwroutine->RecheckForeignScan = oracleRecheckForeignScan;
+#endif  /* JOIN_API */
 	fdwroutine->EndForeignScan = oracleEndForeignScan;
 	fdwroutine->AddForeignUpdateTargets = oracleAddForeignUpdateTargets;
 	fdwroutine->PlanForeignModify = oraclePlanForeignModify;
@@ -473,14 +840,41 @@ oracle_fdw_handler(PG_FUNCTION_ARGS)
 	fdwroutine->EndForeignInsert = oracleEndForeignInsert;
 #endif  /*PG_VERSION_NUM */
 	fdwroutine->ExecForeignInsert = oracleExecForeignInsert;
+#if PG_VERSION_NUM >= 140000
+	fdwroutine->GetForeignModifyBatchSize = oracleGetForeignModifyBatchSize;
+	fdwroutine->ExecForeignBatchInsert = oracleExecForeignBatchInsert;
+#endif  /* PG_VERSION_NUM >= 140000 */
 	fdwroutine->ExecForeignUpdate = oracleExecForeignUpdate;
 	fdwroutine->ExecForeignDelete = oracleExecForeignDelete;
 	fdwroutine->EndForeignModify = oracleEndForeignModify;
 	fdwroutine->ExplainForeignModify = oracleExplainForeignModify;
+#ifdef DIRECT_MODIFY_API
+	fdwroutine->PlanDirectModify = oraclePlanDirectModify;
+	fdwroutine->BeginDirectModify = oracleBeginDirectModify;
+	fdwroutine->IterateDirectModify = oracleIterateDirectModify;
+	fdwroutine->EndDirectModify = oracleEndDirectModify;
+	fdwroutine->ExplainDirectModify = oracleExplainDirectModify;
+#endif  /* DIRECT_MODIFY_API */
+#if PG_VERSION_NUM >= 140000
+	fdwroutine->ExecForeignTruncate = oracleExecForeignTruncate;
+#endif  /* PG_VERSION_NUM >= 140000 */
 	fdwroutine->IsForeignRelUpdatable = oracleIsForeignRelUpdatable;
 #ifdef IMPORT_API
 	fdwroutine->ImportForeignSchema = oracleImportForeignSchema;
 #endif  /* IMPORT_API */
+#ifdef PARALLEL_API
+	fdwroutine->IsForeignScanParallelSafe = oracleIsForeignScanParallelSafe;
+	fdwroutine->EstimateDSMForeignScan = oracleEstimateDSMForeignScan;
+	fdwroutine->InitializeDSMForeignScan = oracleInitializeDSMForeignScan;
+	fdwroutine->ReInitializeDSMForeignScan = oracleReInitializeDSMForeignScan;
+	fdwroutine->InitializeWorkerForeignScan = oracleInitializeWorkerForeignScan;
+#endif  /* PARALLEL_API */
+#ifdef ASYNC_API
+	fdwroutine->IsForeignPathAsyncCapable = oracleIsForeignPathAsyncCapable;
+	fdwroutine->ForeignAsyncRequest = oracleForeignAsyncRequest;
+	fdwroutine->ForeignAsyncConfigureWait = oracleForeignAsyncConfigureWait;
+	fdwroutine->ForeignAsyncNotify = oracleForeignAsyncNotify;
+#endif  /* ASYNC_API */
 
 	PG_RETURN_POINTER(fdwroutine);
 }
@@ -545,14 +939,31 @@ oracle_fdw_validator(PG_FUNCTION_ARGS)
 		if (strcmp(def->defname, OPT_ISOLATION_LEVEL) == 0)
 			(void)getIsolationLevel(strVal(def->arg));
 
-		/* check valid values for "readonly", "key", "strip_zeros" and "nchar" */
+		/* check valid values for boolean options */
 		if (strcmp(def->defname, OPT_READONLY) == 0
 				|| strcmp(def->defname, OPT_KEY) == 0
 				|| strcmp(def->defname, OPT_STRIP_ZEROS) == 0
 				|| strcmp(def->defname, OPT_NCHAR) == 0
-				|| strcmp(def->defname, OPT_SET_TIMEZONE) == 0)
+				|| strcmp(def->defname, OPT_SET_TIMEZONE) == 0
+				|| strcmp(def->defname, OPT_PIPELINE_FETCH) == 0
+				|| strcmp(def->defname, OPT_ASYNC_CAPABLE) == 0
+				|| strcmp(def->defname, OPT_USE_REMOTE_ESTIMATE) == 0
+				|| strcmp(def->defname, OPT_TRUNCATABLE) == 0
+				|| strcmp(def->defname, OPT_IMPORT_STATISTICS) == 0)
 			(void)getBoolVal(def);
 
+		/* check valid values for "truncate_storage" */
+		if (strcmp(def->defname, OPT_TRUNCATE_STORAGE) == 0)
+		{
+			char *val = strVal(def->arg);
+
+			if (strcmp(val, "drop") != 0 && strcmp(val, "reuse") != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_ATTRIBUTE_VALUE),
+						errmsg("invalid value for option \"%s\"", def->defname),
+						errhint("Valid values in this context are: drop/reuse")));
+		}
+
 		/* check valid values for "dblink" */
 		if (strcmp(def->defname, OPT_DBLINK) == 0)
 		{
@@ -623,6 +1034,50 @@ oracle_fdw_validator(PG_FUNCTION_ARGS)
 						errhint("Valid values in this context are integers between 1 and %d.", MAXIMUM_PREFETCH)));
 		}
 
+		/* check valid values for "parallel_workers" */
+		if (strcmp(def->defname, OPT_PARALLEL_WORKERS) == 0)
+		{
+			char *val = strVal(def->arg);
+			char *endptr;
+			long workers;
+
+			errno = 0;
+			workers = strtol(val, &endptr, 0);
+			if (val[0] == '\0' || *endptr != '\0' || errno != 0 || workers < 0 || workers > MAXIMUM_PARALLEL_WORKERS)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_ATTRIBUTE_VALUE),
+						errmsg("invalid value for option \"%s\"", def->defname),
+						errhint("Valid values in this context are integers between 0 and %d.", MAXIMUM_PARALLEL_WORKERS)));
+		}
+
+		/* check valid values for "load_mode" */
+		if (strcmp(def->defname, OPT_LOAD_MODE) == 0)
+		{
+			char *val = strVal(def->arg);
+
+			if (strcmp(val, "conventional") != 0 && strcmp(val, "direct_path") != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_ATTRIBUTE_VALUE),
+						errmsg("invalid value for option \"%s\"", def->defname),
+						errhint("Valid values in this context are: conventional/direct_path")));
+		}
+
+		/* check valid values for "batch_size" */
+		if (strcmp(def->defname, OPT_BATCH_SIZE) == 0)
+		{
+			char *val = strVal(def->arg);
+			char *endptr;
+			long batch_size;
+
+			errno = 0;
+			batch_size = strtol(val, &endptr, 0);
+			if (val[0] == '\0' || *endptr != '\0' || errno != 0 || batch_size < 1 || batch_size > MAXIMUM_BATCH_SIZE)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_ATTRIBUTE_VALUE),
+						errmsg("invalid value for option \"%s\"", def->defname),
+						errhint("Valid values in this context are integers between 1 and %d.", MAXIMUM_BATCH_SIZE)));
+		}
+
 		/* check valid values for "lob_prefetch" */
 		if (strcmp(def->defname, OPT_LOB_PREFETCH) == 0)
 		{
@@ -638,6 +1093,19 @@ oracle_fdw_validator(PG_FUNCTION_ARGS)
 						errmsg("invalid value for option \"%s\"", def->defname),
 						errhint("Valid values in this context are integers between 0 and 536870912.")));
 		}
+
+		/* check valid values for "fetch_memory" */
+		if (strcmp(def->defname, OPT_FETCH_MEMORY) == 0)
+		{
+			int fetch_memory;
+
+			if (!parse_int(strVal(def->arg), &fetch_memory, GUC_UNIT_KB, NULL)
+					|| fetch_memory < 0 || fetch_memory > MAXIMUM_FETCH_MEMORY)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_ATTRIBUTE_VALUE),
+						errmsg("invalid value for option \"%s\"", def->defname),
+						errhint("Valid values in this context are memory sizes between 0 and 1GB.")));
+		}
 	}
 
 	/* check that all required options have been given */
@@ -788,6 +1256,25 @@ _PG_init(void)
 					   GetConfigOptionByName("server_version", NULL)),
 				errhint("You'll have to update PostgreSQL to a later minor release.")));
 
+	DefineCustomIntVariable("oracle_fdw.fetch_memory",
+							"Default memory budget for the rows fetched from Oracle in one batch.",
+							"0 means that the \"prefetch\" option determines the number of rows.",
+							&default_fetch_memory,
+							0,
+							0,
+							MAXIMUM_FETCH_MEMORY,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+#if PG_VERSION_NUM >= 150000
+	MarkGUCPrefixReserved("oracle_fdw");
+#else
+	EmitWarningsOnPlaceholders("oracle_fdw");
+#endif  /* PG_VERSION_NUM */
+
 	/* register an exit hook */
 	on_proc_exit(&exitHook, PointerGetDatum(NULL));
 }
@@ -802,7 +1289,7 @@ void
 oracleGetForeignRelSize(PlannerInfo *root, RelOptInfo *baserel, Oid foreigntableid)
 {
 	struct OracleFdwState *fdwState;
-	int i;
+	int i, minor, update, patch, port_patch;
 	double ntuples = -1;
 	RangeTblEntry *rte = planner_rt_fetch(baserel->relid, root);
 	Oid check_user;
@@ -848,12 +1335,50 @@ oracleGetForeignRelSize(PlannerInfo *root, RelOptInfo *baserel, Oid foreigntable
 								&(fdwState->remote_conds)
 							);
 
+	/* an aggregation can only be pushed down if all conditions are */
+	fdwState->pushdown_safe = (fdwState->local_conds == NIL);
+
 	/*
 	 * Determine whether we can potentially push query pathkeys to the remote
 	 * side, avoiding a local sort.
 	 */
 	(void) pushdownOrderBy(root, baserel, fdwState);
 
+	/* the syntax for LIMIT pushdown depends on the Oracle version */
+	oracleServerVersion(fdwState->session, &(fdwState->server_major), &minor, &update, &patch, &port_patch);
+
+	/* ask the Oracle optimizer for estimates if "use_remote_estimate" is set */
+	if (fdwState->use_remote_estimate)
+	{
+		double rows;
+		int width;
+		Cost cost;
+
+		getRemoteEstimate(fdwState, baserel, &rows, &width, &cost);
+
+		/* release Oracle session (will be cached) */
+		pfree(fdwState->session);
+		fdwState->session = NULL;
+
+		/* conditions that are not pushed down are checked locally */
+		baserel->rows = clamp_row_est(rows * clauselist_selectivity(root, fdwState->local_conds, baserel->relid, JOIN_INNER, NULL));
+		if (width > 0)
+#if PG_VERSION_NUM < 90600
+			baserel->width = width;
+#else
+			baserel->reltarget->width = width;
+#endif  /* PG_VERSION_NUM */
+
+		/* Oracle has to do the work before the first row arrives, transfer costs 10 per row */
+		fdwState->startup_cost = cost;
+		fdwState->total_cost = cost + baserel->rows * 10.0;
+
+		/* store the state so that the other planning functions can use it */
+		baserel->fdw_private = (void *)fdwState;
+
+		return;
+	}
+
 	/* release Oracle session (will be cached) */
 	pfree(fdwState->session);
 	fdwState->session = NULL;
@@ -920,13 +1445,57 @@ oracleGetForeignPaths(PlannerInfo *root, RelOptInfo *baserel, Oid foreigntableid
 					NIL
 			)
 	);
+
+#ifdef JOIN_API
+	/* add paths that push join conditions with local tables to Oracle */
+	addParameterizedPaths(root, baserel, fdwState);
+#endif  /* JOIN_API */
+
+#ifdef PARALLEL_API
+	/*
+	 * Add a partial path for a parallel scan if "parallel_workers" is set.
+	 * Each participant reads only some of the rows, but Oracle still has
+	 * to scan the whole table for each slice, so only the transfer and
+	 * processing costs are divided.
+	 */
+	if (baserel->consider_parallel && fdwState->parallel_workers > 0
+			&& baserel->lateral_relids == NULL)
+	{
+		ForeignPath *path;
+		double divisor = (double)(fdwState->parallel_workers + 1);
+
+		path = create_foreignscan_path(
+					root,
+					baserel,
+					NULL,  /* default pathtarget */
+					baserel->rows / divisor,
+#if PG_VERSION_NUM >= 180000
+					0,  /* no disabled plan nodes */
+#endif  /* PG_VERSION_NUM */
+					fdwState->startup_cost,
+					fdwState->startup_cost + (fdwState->total_cost - fdwState->startup_cost) / divisor,
+					NIL,   /* the slices are not sorted */
+					NULL,  /* no required outer relids */
+					NULL,  /* no extra plan */
+#if PG_VERSION_NUM >= 170000
+					NIL,   /* no fdw_restrictinfo */
+#endif  /* PG_VERSION_NUM */
+					NIL
+				);
+		path->path.parallel_aware = true;
+		path->path.parallel_workers = fdwState->parallel_workers;
+
+		add_partial_path(baserel, (Path *)path);
+	}
+#endif  /* PARALLEL_API */
 }
 
 #ifdef JOIN_API
 /*
  * oracleGetForeignJoinPaths
  * 		Add possible ForeignPath to joinrel if the join is safe to push down.
- * 		For now, we can only push down 2-way joins for SELECT.
+ * 		For now, we can only push down joins for SELECT.
+ * 		Either side can be a base relation or a join that is pushed down.
  */
 static void
 oracleGetForeignJoinPaths(PlannerInfo *root,
@@ -938,38 +1507,49 @@ oracleGetForeignJoinPaths(PlannerInfo *root,
 {
 	struct OracleFdwState *fdwState;
 	ForeignPath *joinpath;
+	Path       *epq_path = NULL;	/* local join path for EvalPlanQual */
 	double      joinclauses_selectivity;
+	double      tuples_o, tuples_i;	/* row counts of the joining sides */
 	double      rows;				/* estimated number of returned rows */
 	Cost        startup_cost;
 	Cost        total_cost;
 
 	/*
-	 * Currently we don't push-down joins in query for UPDATE/DELETE.
-	 * This would require a path for EvalPlanQual.
-	 * This restriction might be relaxed in a later release.
+	 * The table modified by UPDATE or DELETE is not joined on the Oracle side,
+	 * since its rows are locked and identified in the scan for that table.
 	 */
-	if (root->parse->commandType != CMD_SELECT)
+#if PG_VERSION_NUM < 140000
+	if (root->parse->resultRelation > 0
+		&& bms_is_member(root->parse->resultRelation, joinrel->relids))
+#else
+	if (bms_overlap(root->all_result_relids, joinrel->relids))
+#endif  /* PG_VERSION_NUM */
 	{
-		elog(DEBUG2, "oracle_fdw: don't push down join because it is no SELECT");
+		elog(DEBUG2, "oracle_fdw: don't push down join with the target of UPDATE or DELETE");
 		return;
 	}
 
-	if (root->rowMarks)
-	{
-		elog(DEBUG2, "oracle_fdw: don't push down join with FOR UPDATE");
+	/* skip if this join combination has been considered already */
+	if (joinrel->fdw_private)
 		return;
-	}
 
 	/*
-	 * N-way join is not supported, due to the column definition infrastracture.
-	 * If we can track relid mapping of join relations, we can support N-way join.
+	 * For UPDATE, DELETE and FOR UPDATE/SHARE, EvalPlanQual may have to
+	 * recheck a joined row after a concurrent update.  That is done with
+	 * a local join of the rows from the whole-row references (see
+	 * oracleRecheckForeignScan), so we need a local join path for that.
 	 */
-	if (! IS_SIMPLE_REL(outerrel) || ! IS_SIMPLE_REL(innerrel))
-		return;
-
-	/* skip if this join combination has been considered already */
-	if (joinrel->fdw_private)
-		return;
+	if (root->parse->commandType == CMD_DELETE ||
+		root->parse->commandType == CMD_UPDATE ||
+		root->rowMarks)
+	{
+		epq_path = GetExistingLocalJoinPath(joinrel);
+		if (!epq_path)
+		{
+			elog(DEBUG2, "oracle_fdw: don't push down join because there is no local join path for EvalPlanQual");
+			return;
+		}
+	}
 
 	/*
 	 * Create unfinished OracleFdwState which is used to indicate
@@ -985,16 +1565,37 @@ oracleGetForeignJoinPaths(PlannerInfo *root,
 	if (!foreign_join_ok(root, joinrel, jointype, outerrel, innerrel, extra))
 		return;
 
+	/* an aggregation can only be pushed down if all conditions are */
+	fdwState->pushdown_safe = (fdwState->local_conds == NIL);
+
+	/* for a joining side that is a join, use the estimate made for it below */
+	tuples_o = IS_SIMPLE_REL(outerrel) ? outerrel->tuples : outerrel->rows;
+	tuples_i = IS_SIMPLE_REL(innerrel) ? innerrel->tuples : innerrel->rows;
+
 	/* estimate the number of result rows for the join */
+	if (fdwState->use_remote_estimate)
+	{
+		/* ask the Oracle optimizer, conditions that are not pushed down are checked locally */
+		int width;
+
+		getRemoteEstimate(fdwState, joinrel, &rows, &width, &startup_cost);
+		rows = clamp_row_est(rows * clauselist_selectivity(root, fdwState->local_conds, 0, JOIN_INNER, extra->sjinfo));
+	}
+	else if (jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+	{
+		/* our simple estimate below is wrong here, use PostgreSQL's */
+		rows = joinrel->rows;
+	}
 #if PG_VERSION_NUM < 140000
-	if (outerrel->pages > 0 && innerrel->pages > 0)
+	else if ((!IS_SIMPLE_REL(outerrel) || outerrel->pages > 0)
+			 && (!IS_SIMPLE_REL(innerrel) || innerrel->pages > 0))
 #else
-	if (outerrel->tuples >= 0 && innerrel->tuples >= 0)
+	else if (tuples_o >= 0 && tuples_i >= 0)
 #endif  /* PG_VERSION_NUM */
 	{
 		/* both relations have been ANALYZEd, so there should be useful statistics */
 		joinclauses_selectivity = clauselist_selectivity(root, fdwState->joinclauses, 0, JOIN_INNER, extra->sjinfo);
-		rows = clamp_row_est(innerrel->tuples * outerrel->tuples * joinclauses_selectivity);
+		rows = clamp_row_est(tuples_i * tuples_o * joinclauses_selectivity);
 	}
 	else
 	{
@@ -1002,8 +1603,9 @@ oracleGetForeignJoinPaths(PlannerInfo *root,
 		rows = 1000.0;
 	}
 
-	/* use a random "high" value for startup cost */
-	startup_cost = 10000.0;
+	/* use a random "high" value for startup cost unless Oracle estimated it */
+	if (!fdwState->use_remote_estimate)
+		startup_cost = 10000.0;
 
 	/* estimate total cost as startup cost + (returned rows) * 10.0 */
 	total_cost = startup_cost + rows * 10.0;
@@ -1030,7 +1632,7 @@ oracleGetForeignJoinPaths(PlannerInfo *root,
 									   total_cost,
 									   NIL, 	/* no pathkeys */
 									   joinrel->lateral_relids,
-									   NULL,	/* no epq_path */
+									   epq_path,
 #if PG_VERSION_NUM >= 170000
 									   NIL,		/* no fdw_restrictinfo */
 #endif  /* PG_VERSION_NUM */
@@ -1041,49 +1643,205 @@ oracleGetForeignJoinPaths(PlannerInfo *root,
 }
 #endif  /* JOIN_API */
 
+#ifdef UPPER_API
 /*
- * oracleGetForeignPlan
- * 		Construct a ForeignScan node containing the serialized OracleFdwState,
- * 		the RestrictInfo clauses not handled entirely by Oracle and the list
- * 		of parameters we need for execution.
- * 		For join relations, the oraTable is constructed from the target list.
+ * oracleGetForeignUpperPaths
+ * 		Add a path that pushes down GROUP BY and aggregates to Oracle
+ * 		if the relation to be grouped is pushed down and all grouping
+ * 		expressions and aggregates can be translated.
+ * 		From PostgreSQL v12 on, also push down LIMIT and OFFSET.
  */
-ForeignScan
-*oracleGetForeignPlan(PlannerInfo *root, RelOptInfo *foreignrel, Oid foreigntableid, ForeignPath *best_path, List *tlist, List *scan_clauses
-#if PG_VERSION_NUM >= 90500
-, Plan *outer_plan
+void
+oracleGetForeignUpperPaths(PlannerInfo *root,
+							UpperRelationKind stage,
+							RelOptInfo *input_rel,
+							RelOptInfo *output_rel
+#if PG_VERSION_NUM >= 110000
+							, void *extra
 #endif  /* PG_VERSION_NUM */
-)
+							)
 {
-	struct OracleFdwState *fdwState = (struct OracleFdwState *)foreignrel->fdw_private;
-	List *fdw_private = NIL;
-	int i;
-	bool need_keys = false, for_update = false, has_trigger;
-	Relation rel;
-	Index scan_relid;  /* will be 0 for join relations */
-	List *local_exprs = fdwState->local_conds;
-#if PG_VERSION_NUM >= 90500
-	List *fdw_scan_tlist = NIL;
-#endif  /* PG_VERSION_NUM */
+	struct OracleFdwState *fdwState;
+	struct OracleFdwState *fdwState_i = (struct OracleFdwState *)input_rel->fdw_private;
+	ForeignPath *grouppath;
+	PathTarget *grouping_target;
+	List       *havingQual;
+	double      rows;				/* estimated number of returned rows */
+	Cost        startup_cost;
+	Cost        total_cost;
 
-#ifdef JOIN_API
-	/* treat base relations and join relations differently */
-	if (IS_SIMPLE_REL(foreignrel))
+#if PG_VERSION_NUM >= 120000
+	/* remember if ORDER BY is pushed down, that is needed for LIMIT */
+	if (stage == UPPERREL_ORDERED)
 	{
-#endif  /* JOIN_API */
-		/* for base relations, set scan_relid as the relid of the relation */
-		scan_relid = foreignrel->relid;
+		if (fdwState_i != NULL && !output_rel->fdw_private)
+			add_foreign_ordered_state(root, input_rel, output_rel);
+		return;
+	}
 
-		/* check if the foreign scan is for an UPDATE or DELETE */
-#if PG_VERSION_NUM < 140000
-		if (foreignrel->relid == root->parse->resultRelation &&
-			(root->parse->commandType == CMD_UPDATE ||
-			root->parse->commandType == CMD_DELETE))
-#else
-		if (bms_is_member(foreignrel->relid, root->all_result_relids) &&
-			(root->parse->commandType == CMD_UPDATE ||
-			root->parse->commandType == CMD_DELETE))
-#endif  /* PG_VERSION_NUM */
+	/* LIMIT and OFFSET are applied in the final stage */
+	if (stage == UPPERREL_FINAL)
+	{
+		if (fdwState_i != NULL)
+			add_foreign_final_paths(root, input_rel, output_rel, (FinalPathExtraData *) extra);
+		return;
+	}
+#endif  /* PG_VERSION_NUM */
+
+	/* otherwise we only push down aggregation */
+	if (stage != UPPERREL_GROUP_AGG)
+		return;
+
+	/* skip if the input cannot be pushed down or this has been considered already */
+	if (fdwState_i == NULL || !fdwState_i->pushdown_safe || output_rel->fdw_private)
+		return;
+
+	/* grouping sets are not supported */
+	if (root->parse->groupingSets)
+	{
+		elog(DEBUG2, "oracle_fdw: don't push down aggregation with grouping sets");
+		return;
+	}
+
+#if PG_VERSION_NUM < 110000
+	grouping_target = root->upper_targets[UPPERREL_GROUP_AGG];
+	havingQual = (List *) root->parse->havingQual;
+#else
+	/* partial aggregation would require Oracle to return transition values */
+	if (((GroupPathExtraData *) extra)->patype == PARTITIONWISE_AGGREGATE_PARTIAL)
+		return;
+
+	grouping_target = output_rel->reltarget;
+	havingQual = (List *) ((GroupPathExtraData *) extra)->havingQual;
+#endif  /* PG_VERSION_NUM */
+
+	/*
+	 * Create unfinished OracleFdwState which is used to indicate
+	 * that the aggregation has already been considered.
+	 */
+	fdwState = (struct OracleFdwState *) palloc0(sizeof(struct OracleFdwState));
+
+	output_rel->fdw_private = fdwState;
+
+	/* this performs further checks */
+	if (!foreign_grouping_ok(root, output_rel, input_rel, grouping_target, havingQual))
+		return;
+
+	fdwState->pushdown_safe = true;
+
+	/* estimate the number of groups */
+	if (root->parse->groupClause == NIL)
+		rows = 1.0;
+	else
+		rows = estimate_num_groups(root,
+								   get_sortgrouplist_exprs(root->parse->groupClause, fdwState->grouped_tlist),
+								   input_rel->rows,
+								   NULL
+#if PG_VERSION_NUM >= 140000
+								   , NULL
+#endif  /* PG_VERSION_NUM */
+								   );
+
+	if (fdwState->use_remote_estimate)
+	{
+		/* ask the Oracle optimizer */
+		int width;
+
+		getRemoteEstimate(fdwState, output_rel, &rows, &width, &startup_cost);
+		rows = clamp_row_est(rows);
+		total_cost = startup_cost + rows * 10.0;
+	}
+	else
+	{
+		/*
+		 * Oracle has to read the same rows as for the input relation,
+		 * but only the groups have to be transferred.  That makes
+		 * the pushed down aggregation cheaper than a local one.
+		 */
+		startup_cost = fdwState_i->startup_cost;
+		total_cost = startup_cost + input_rel->rows * cpu_operator_cost + rows * 10.0;
+	}
+
+	/* store cost estimation results */
+	fdwState->startup_cost = startup_cost;
+	fdwState->total_cost = total_cost;
+
+	/* create a new upper path */
+#if PG_VERSION_NUM < 120000
+	grouppath = create_foreignscan_path(
+#else
+	grouppath = create_foreign_upper_path(
+#endif  /* PG_VERSION_NUM */
+									   root,
+									   output_rel,
+									   grouping_target,
+									   rows,
+#if PG_VERSION_NUM >= 180000
+									   0,	/* no disabled plan nodes */
+#endif  /* PG_VERSION_NUM */
+									   startup_cost,
+									   total_cost,
+									   NIL, 	/* no pathkeys */
+#if PG_VERSION_NUM < 120000
+									   NULL,	/* no required_outer */
+#endif  /* PG_VERSION_NUM */
+									   NULL,	/* no epq_path */
+#if PG_VERSION_NUM >= 170000
+									   NIL,		/* no fdw_restrictinfo */
+#endif  /* PG_VERSION_NUM */
+									   NIL);	/* no fdw_private */
+
+	/* add generated path to the grouped relation */
+	add_path(output_rel, (Path *) grouppath);
+}
+#endif  /* UPPER_API */
+
+/*
+ * oracleGetForeignPlan
+ * 		Construct a ForeignScan node containing the serialized OracleFdwState,
+ * 		the RestrictInfo clauses not handled entirely by Oracle and the list
+ * 		of parameters we need for execution.
+ * 		For join relations, the oraTable is constructed from the target list.
+ * 		For aggregations, it was constructed when the path was created.
+ */
+ForeignScan
+*oracleGetForeignPlan(PlannerInfo *root, RelOptInfo *foreignrel, Oid foreigntableid, ForeignPath *best_path, List *tlist, List *scan_clauses
+#if PG_VERSION_NUM >= 90500
+, Plan *outer_plan
+#endif  /* PG_VERSION_NUM */
+)
+{
+	struct OracleFdwState *fdwState = (struct OracleFdwState *)foreignrel->fdw_private;
+	List *fdw_private = NIL;
+	int i;
+	bool need_keys = false, for_update = false, has_trigger, parameterized = false;
+	Relation rel;
+	Index scan_relid;  /* will be 0 for join relations */
+	List *local_exprs = fdwState->local_conds;
+	List *params = fdwState->params, *plan_params;
+	char *where_clause = fdwState->where_clause;
+#if PG_VERSION_NUM >= 90500
+	List *fdw_scan_tlist = NIL;
+#endif  /* PG_VERSION_NUM */
+
+#ifdef JOIN_API
+	/* treat base relations and join relations differently */
+	if (IS_SIMPLE_REL(foreignrel))
+	{
+#endif  /* JOIN_API */
+		/* for base relations, set scan_relid as the relid of the relation */
+		scan_relid = foreignrel->relid;
+
+		/* check if the foreign scan is for an UPDATE or DELETE */
+#if PG_VERSION_NUM < 140000
+		if (foreignrel->relid == root->parse->resultRelation &&
+			(root->parse->commandType == CMD_UPDATE ||
+			root->parse->commandType == CMD_DELETE))
+#else
+		if (bms_is_member(foreignrel->relid, root->all_result_relids) &&
+			(root->parse->commandType == CMD_UPDATE ||
+			root->parse->commandType == CMD_DELETE))
+#endif  /* PG_VERSION_NUM */
 		{
 			/* we need the table's primary key columns */
 			need_keys = true;
@@ -1123,8 +1881,66 @@ ForeignScan
 				if (fdwState->oraTable->cols[i]->pgname)
 					fdwState->oraTable->cols[i]->used = 1;
 		}
+
 #ifdef JOIN_API
+		/*
+		 * For a parameterized path, add the join conditions to the WHERE clause.
+		 * The values from the outer relation become parameters of the Oracle query.
+		 * Conditions that cannot be pushed down are checked locally.
+		 * Other plans for the relation must not see these conditions, so the
+		 * plan gets its own WHERE clause and parameter list, and the relation's
+		 * are restored below.
+		 */
+		if (best_path->path.param_info != NULL)
+		{
+			StringInfoData plan_where;
+			ListCell *cell;
+
+			initStringInfo(&plan_where);
+			appendStringInfoString(&plan_where, where_clause);
+			fdwState->params = list_copy(params);
+			local_exprs = list_copy(local_exprs);
+
+			foreach(cell, best_path->path.param_info->ppi_clauses)
+			{
+				RestrictInfo *rinfo = (RestrictInfo *)lfirst(cell);
+				char *where;
+
+				where = deparseExpr(
+							fdwState->session, foreignrel,
+							rinfo->clause,
+							fdwState->oraTable,
+							&(fdwState->params),
+							false
+						);
+				if (where != NULL)
+				{
+					appendStringInfo(&plan_where, " %s %s",
+									 (plan_where.len > 0 ? "AND" : "WHERE"), where);
+					pfree(where);
+				}
+				else
+					local_exprs = lappend(local_exprs, rinfo->clause);
+			}
+
+			fdwState->where_clause = plan_where.data;
+			parameterized = true;
+		}
+	}
+#ifdef UPPER_API
+	else if (IS_UPPER_REL(foreignrel))
+	{
+		/* we have a pushed down aggregation, so set scan_relid to 0 */
+		scan_relid = 0;
+
+		/*
+		 * The grouping expressions and aggregates are fetched from Oracle,
+		 * the oraTable for them has been built in foreign_grouping_ok.
+		 * There is no outer plan, since we did not provide an epq_path.
+		 */
+		fdw_scan_tlist = fdwState->grouped_tlist;
 	}
+#endif  /* UPPER_API */
 	else
 	{
 		/* we have a join relation, so set scan_relid to 0 */
@@ -1142,6 +1958,12 @@ ForeignScan
 		/* Build the list of columns to be fetched from the foreign server. */
 		fdw_scan_tlist = build_tlist_to_deparse(foreignrel);
 
+		/* with FOR [KEY] SHARE/UPDATE on any of the joined tables, lock the rows */
+		i = -1;
+		while ((i = bms_next_member(foreignrel->relids, i)) >= 0)
+			if (get_parse_rowmark(root->parse, (Index) i))
+				for_update = true;
+
 		/*
 		 * Ensure that the outer plan produces a tuple whose descriptor
 		 * matches our scan tuple slot. This is safe because all scans and
@@ -1179,6 +2001,26 @@ ForeignScan
 	}
 #endif  /* JOIN_API */
 
+#ifdef PARALLEL_API
+	/* a parallel scan is split into one slice per participating process */
+	if (best_path->path.parallel_aware)
+		fdwState->parallel_slices = best_path->path.parallel_workers + 1;
+	else
+		fdwState->parallel_slices = 0;
+#endif  /* PARALLEL_API */
+
+	/* a path for the final relation carries a pushed down LIMIT */
+	if (best_path->fdw_private != NIL)
+	{
+		fdwState->limit_clause = strVal(linitial(best_path->fdw_private));
+		fdwState->limit_rows = (unsigned int) intVal(lsecond(best_path->fdw_private));
+	}
+	else
+	{
+		fdwState->limit_clause = NULL;
+		fdwState->limit_rows = 0;
+	}
+
 	/* create remote query */
 	fdwState->query = createQuery(fdwState, foreignrel, for_update, best_path->path.pathkeys);
 	elog(DEBUG1, "oracle_fdw: remote query is: %s", fdwState->query);
@@ -1196,6 +2038,15 @@ ForeignScan
 
 	fdw_private = serializePlanData(fdwState);
 
+	plan_params = fdwState->params;
+
+	/* a parameterized plan worked on copies, restore the relation's */
+	if (parameterized)
+	{
+		fdwState->params = params;
+		fdwState->where_clause = where_clause;
+	}
+
 	/*
 	 * Create the ForeignScan node for the given relation.
 	 *
@@ -1203,10 +2054,10 @@ ForeignScan
 	 * field of the finished plan node; we can't keep them in private state
 	 * because then they wouldn't be subject to later planner processing.
 	 */
-	return make_foreignscan(tlist, local_exprs, scan_relid, fdwState->params, fdw_private
+	return make_foreignscan(tlist, local_exprs, scan_relid, plan_params, fdw_private
 #if PG_VERSION_NUM >= 90500
 								, fdw_scan_tlist,
-								NIL,  /* no parameterized paths */
+								NIL,  /* no fdw_recheck_quals */
 								outer_plan
 #endif  /* PG_VERSION_NUM */
 							);
@@ -1239,6 +2090,14 @@ oracleExplainForeignScan(ForeignScanState *node, ExplainState *es)
 	/* show query */
 	ExplainPropertyText("Oracle query", fdw_state->query, es);
 
+	/* show the fetch size if it was computed from "fetch_memory" */
+	if (fdw_state->fetch_memory > 0)
+#if PG_VERSION_NUM >= 110000
+		ExplainPropertyInteger("Oracle fetch size", "rows", (int64)fdw_state->prefetch, es);
+#else
+		ExplainPropertyLong("Oracle fetch size", (long)fdw_state->prefetch, es);
+#endif  /* PG_VERSION_NUM */
+
 	if (es->verbose)
 	{
 		/* get the EXPLAIN PLAN */
@@ -1264,8 +2123,6 @@ oracleBeginForeignScan(ForeignScanState *node, int eflags)
 {
 	ForeignScan *fsplan = (ForeignScan *)node->ss.ps.plan;
 	List *fdw_private = fsplan->fdw_private;
-	List *exec_exprs;
-	ListCell *cell;
 	int index;
 	struct paramDesc *paramDesc;
 	struct OracleFdwState *fdw_state;
@@ -1274,60 +2131,28 @@ oracleBeginForeignScan(ForeignScanState *node, int eflags)
 	fdw_state = deserializePlanData(fdw_private);
 	node->fdw_state = (void *)fdw_state;
 
-	/* create an ExprState tree for the parameter expressions */
-#if PG_VERSION_NUM < 100000
-	exec_exprs = (List *)ExecInitExpr((Expr *)fsplan->fdw_exprs, (PlanState *)node);
-#else
-	exec_exprs = (List *)ExecInitExprList(fsplan->fdw_exprs, (PlanState *)node);
-#endif  /* PG_VERSION_NUM */
-
 	/* create the list of parameters */
-	index = 0;
-	foreach(cell, exec_exprs)
-	{
-		ExprState *expr = (ExprState *)lfirst(cell);
-		char parname[10];
+	createScanParams(node, fdw_state);
 
-		/* count, but skip deleted entries */
-		++index;
-		if (expr == NULL)
-			continue;
-
-		/* create a new entry in the parameter list */
-		paramDesc = (struct paramDesc *)palloc(sizeof(struct paramDesc));
-		snprintf(parname, 10, ":p%.5d", index);
-		paramDesc->name = pstrdup(parname);
-		paramDesc->type = exprType((Node *)(expr->expr));
+	/* add fake parameters for the SCN and the slice of a parallel scan */
+	if (fdw_state->parallel_slices > 0)
+	{
+		const char *names[] = { ":scn", ":slice" };
 
-		if (paramDesc->type == TEXTOID || paramDesc->type == VARCHAROID
-				|| paramDesc->type == BPCHAROID || paramDesc->type == CHAROID
-				|| paramDesc->type == DATEOID || paramDesc->type == TIMESTAMPOID
-				|| paramDesc->type == TIMESTAMPTZOID || paramDesc->type == UUIDOID)
-			paramDesc->bindType = BIND_STRING;
-		else
+		for (index = 0; index < 2; ++index)
+		{
+			paramDesc = (struct paramDesc *)palloc(sizeof(struct paramDesc));
+			paramDesc->name = pstrdup(names[index]);
+			paramDesc->type = INT8OID;
 			paramDesc->bindType = BIND_NUMBER;
-
-		paramDesc->value = NULL;
-		paramDesc->node = expr;
-		paramDesc->bindh = NULL;
-		paramDesc->colnum = -1;
-		paramDesc->next = fdw_state->paramList;
-		fdw_state->paramList = paramDesc;
-	}
-
-	/* add a fake parameter ":now" if that string appears in the query */
-	if (strstr(fdw_state->query, ":now") != NULL)
-	{
-		paramDesc = (struct paramDesc *)palloc(sizeof(struct paramDesc));
-		paramDesc->name = pstrdup(":now");
-		paramDesc->type = TIMESTAMPTZOID;
-		paramDesc->bindType = BIND_STRING;
-		paramDesc->value = NULL;
-		paramDesc->node = NULL;
-		paramDesc->bindh = NULL;
-		paramDesc->colnum = -1;
-		paramDesc->next = fdw_state->paramList;
-		fdw_state->paramList = paramDesc;
+			paramDesc->value = NULL;
+			paramDesc->node = NULL;
+			paramDesc->bindh = NULL;
+			paramDesc->values = NULL;
+			paramDesc->colnum = -1;
+			paramDesc->next = fdw_state->paramList;
+			fdw_state->paramList = paramDesc;
+		}
 	}
 
 	if (node->ss.ss_currentRelation)
@@ -1350,46 +2175,87 @@ oracleBeginForeignScan(ForeignScanState *node, int eflags)
 			GetCurrentTransactionNestLevel()
 		);
 
+	/* look up the type input functions for the result columns */
+	initConverters(fdw_state);
+
+	/*
+	 * With "fetch_memory", start with a small batch and let it grow.
+	 * A pipelined fetch hides the latency anyway, so it always uses full batches.
+	 */
+	if (fdw_state->fetch_memory > 0 && fdw_state->prefetch > DEFAULT_PREFETCH
+			&& !fdw_state->pipeline_fetch)
+		fdw_state->fetch_size = DEFAULT_PREFETCH;
+	else
+		fdw_state->fetch_size = fdw_state->prefetch;
+
+#ifdef ASYNC_API
+	/* asynchronous execution is only possible with a pipelined fetch */
+	if (node->ss.ps.async_capable && fdw_state->pipeline_fetch)
+	{
+		fdw_state->async_execution = true;
+		fdw_state->wait_fd = createWaitFd(node->ss.ps.state, fdw_state);
+	}
+#endif  /* ASYNC_API */
+
 	/* initialize row count to zero */
 	fdw_state->rowcount = 0;
 }
 
 /*
  * oracleIterateForeignScan
- * 		On first invocation (if there is no Oracle statement yet),
- * 		get the actual parameter values and run the remote query against
+ * 		On first invocation (or the first after a rescan), get the
+ * 		actual parameter values and run the remote query against
  * 		the Oracle database, retrieving the first result row.
  * 		Subsequent invocations will fetch more result rows until there
  * 		are no more.
  * 		The result is stored as a virtual tuple in the ScanState's
  * 		TupleSlot and returned.
+ * 		The statement is not closed at the end of the result set, so that
+ * 		a rescan can execute it again without preparing it.
  */
 TupleTableSlot *
 oracleIterateForeignScan(ForeignScanState *node)
 {
 	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
-	ExprContext *econtext = node->ss.ps.ps_ExprContext;
 	unsigned int index;
 	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
 
-	if (!oracleIsStatementOpen(fdw_state->session))
+	if (!fdw_state->executed)
 	{
-		/* fill the parameter list with the actual values */
-		char *paramInfo = setSelectParameters(fdw_state->paramList, econtext);
-
-		/* execute the Oracle statement and fetch the first row */
-		elog(DEBUG1, "oracle_fdw: execute query in foreign table scan %s", paramInfo);
+#ifdef PARALLEL_API
+		/* for a parallel scan, there may be no slice left for us */
+		if (fdw_state->parallel_slices > 0 && !getNextSlice(fdw_state))
+			return ExecClearTuple(slot);
+#endif  /* PARALLEL_API */
 
-		oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable,
-			fdw_state->prefetch, fdw_state->lob_prefetch);
-		(void)oracleExecuteQuery(fdw_state->session, fdw_state->oraTable,
-			fdw_state->paramList, fdw_state->prefetch);
+		executeForeignScan(node);
 	}
 
 	elog(DEBUG3, "oracle_fdw: get next row in foreign table scan");
 
 	/* fetch the next result row */
-	index = oracleFetchNext(fdw_state->session, fdw_state->prefetch);
+	index = oracleFetchNext(fdw_state->session, fdw_state->fetch_size);
+
+#ifdef PARALLEL_API
+	/* at the end of a slice, continue with the next one */
+	while (index == 0 && fdw_state->parallel_slices > 0 && getNextSlice(fdw_state))
+	{
+		executeForeignScan(node);
+		index = oracleFetchNext(fdw_state->session, fdw_state->fetch_size);
+	}
+#endif  /* PARALLEL_API */
+
+	/*
+	 * If that was the last row of a full batch, fetch more rows next time,
+	 * up to the number of rows that fit into the buffers.
+	 */
+	if (index == fdw_state->fetch_size && fdw_state->fetch_size < fdw_state->prefetch)
+	{
+		fdw_state->fetch_size = (fdw_state->fetch_size > fdw_state->prefetch / 2)
+								? fdw_state->prefetch
+								: 2 * fdw_state->fetch_size;
+		elog(DEBUG2, "oracle_fdw: increase fetch size to %u rows", fdw_state->fetch_size);
+	}
 
 	/* initialize virtual tuple */
 	ExecClearTuple(slot);
@@ -1405,53 +2271,238 @@ oracleIterateForeignScan(ForeignScanState *node)
 		/* store the virtual tuple */
 		ExecStoreVirtualTuple(slot);
 	}
-	else
-	{
-		/* close the statement */
-		oracleCloseStatement(fdw_state->session);
-	}
 
 	return slot;
 }
 
+#ifdef PARALLEL_API
 /*
- * oracleEndForeignScan
- * 		Close the currently active Oracle statement.
+ * oracleIsForeignScanParallelSafe
+ * 		A foreign table can be scanned in a parallel worker if the
+ * 		"parallel_workers" option is set, there is no database link
+ * 		and the table is not defined by a query.
+ * 		This is called before oracleGetForeignRelSize, so we have to read
+ * 		the options from the catalog.
  */
-void
-oracleEndForeignScan(ForeignScanState *node)
+bool
+oracleIsForeignScanParallelSafe(PlannerInfo *root, RelOptInfo *rel, RangeTblEntry *rte)
 {
-	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+	ForeignTable *table = GetForeignTable(rte->relid);
+	ListCell *cell;
+	long workers = 0;
 
-	elog(DEBUG1, "oracle_fdw: end foreign table scan");
+	foreach(cell, table->options)
+	{
+		DefElem *def = (DefElem *)lfirst(cell);
 
-	/* release the Oracle session */
-	oracleCloseStatement(fdw_state->session);
-	pfree(fdw_state->session);
-	fdw_state->session = NULL;
+		if (strcmp(def->defname, OPT_PARALLEL_WORKERS) == 0)
+			workers = strtol(strVal(def->arg), NULL, 0);
+		if (strcmp(def->defname, OPT_DBLINK) == 0)
+			return false;
+		if (strcmp(def->defname, OPT_TABLE) == 0 && strVal(def->arg)[0] == '(')
+			return false;
+	}
+
+	return (workers > 0);
 }
 
 /*
- * oracleReScanForeignScan
- * 		Close the Oracle statement if there is any.
- * 		That causes the next oracleIterateForeignScan call to restart the scan.
+ * oracleEstimateDSMForeignScan
+ * 		We need shared memory for the SCN and the next slice.
+ */
+Size
+oracleEstimateDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt)
+{
+	return sizeof(struct OracleParallelScan);
+}
+
+/*
+ * oracleInitializeDSMForeignScan
+ * 		Get the current SCN, so that all workers see the same data.
  */
 void
-oracleReScanForeignScan(ForeignScanState *node)
+oracleInitializeDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt, void *coordinate)
 {
 	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+	struct OracleParallelScan *pscan = (struct OracleParallelScan *)coordinate;
 
-	elog(DEBUG1, "oracle_fdw: restart foreign table scan");
+	oracleGetSCN(fdw_state->session, pscan->scn);
+	pg_atomic_init_u32(&pscan->next_slice, 0);
 
-	/* close open Oracle statement if there is one */
-	oracleCloseStatement(fdw_state->session);
+	elog(DEBUG1, "oracle_fdw: parallel foreign table scan as of SCN %s", pscan->scn);
 
-	/* reset row count to zero */
-	fdw_state->rowcount = 0;
+	fdw_state->pscan = pscan;
 }
 
 /*
- * oracleAddForeignUpdateTargets
+ * oracleReInitializeDSMForeignScan
+ * 		Start over with the first slice.
+ * 		We keep the SCN, so that a rescan returns the same rows.
+ */
+void
+oracleReInitializeDSMForeignScan(ForeignScanState *node, ParallelContext *pcxt, void *coordinate)
+{
+	struct OracleParallelScan *pscan = (struct OracleParallelScan *)coordinate;
+
+	pg_atomic_write_u32(&pscan->next_slice, 0);
+}
+
+/*
+ * oracleInitializeWorkerForeignScan
+ * 		Attach to the shared state of the parallel scan.
+ */
+void
+oracleInitializeWorkerForeignScan(ForeignScanState *node, shm_toc *toc, void *coordinate)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	fdw_state->pscan = (struct OracleParallelScan *)coordinate;
+}
+#endif  /* PARALLEL_API */
+
+#ifdef ASYNC_API
+/*
+ * oracleIsForeignPathAsyncCapable
+ * 		A scan can be executed asynchronously if "async_capable" is set.
+ */
+bool
+oracleIsForeignPathAsyncCapable(ForeignPath *path)
+{
+	struct OracleFdwState *fdwState = (struct OracleFdwState *)path->path.parent->fdw_private;
+
+	/* a parallel scan changes slices in a way that cannot be done asynchronously */
+	return fdwState->async_capable && !path->path.parallel_aware;
+}
+
+/*
+ * oracleForeignAsyncRequest
+ * 		Start the Oracle query if necessary and return the next row
+ * 		if it is available without waiting.
+ */
+void
+oracleForeignAsyncRequest(AsyncRequest *areq)
+{
+	ForeignScanState *node = (ForeignScanState *)areq->requestee;
+
+	/* with asynchronous execution, this doesn't wait for Oracle */
+	if (!((struct OracleFdwState *)node->fdw_state)->executed)
+		executeForeignScan(node);
+
+	produceTupleAsync(areq, false);
+}
+
+/*
+ * oracleForeignAsyncConfigureWait
+ * 		OCI does not expose the socket of the Oracle connection, so we
+ * 		cannot wait for it.  Instead, add a file descriptor that is always
+ * 		readable, so that oracleForeignAsyncNotify gets called and can
+ * 		wait for the query in OCI.
+ */
+void
+oracleForeignAsyncConfigureWait(AsyncRequest *areq)
+{
+	ForeignScanState *node = (ForeignScanState *)areq->requestee;
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+	AppendState *requestor = (AppendState *)areq->requestor;
+
+	Assert(areq->callback_pending);
+	Assert(fdw_state->wait_fd >= 0);
+
+	AddWaitEventToSet(requestor->as_eventset, WL_SOCKET_READABLE,
+					  fdw_state->wait_fd, NULL, areq);
+}
+
+/*
+ * oracleForeignAsyncNotify
+ * 		Return the next row if it is available.  If the Append has no
+ * 		synchronous subplans left, it would only come back here, so
+ * 		we block in OCI until the Oracle query delivers the row.
+ */
+void
+oracleForeignAsyncNotify(AsyncRequest *areq)
+{
+	produceTupleAsync(areq, ((AppendState *)areq->requestor)->as_syncdone);
+}
+#endif  /* ASYNC_API */
+
+/*
+ * oracleEndForeignScan
+ * 		Close the currently active Oracle statement.
+ */
+void
+oracleEndForeignScan(ForeignScanState *node)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	elog(DEBUG1, "oracle_fdw: end foreign table scan");
+
+	/* release the Oracle session */
+	oracleCloseStatement(fdw_state->session);
+	pfree(fdw_state->session);
+	fdw_state->session = NULL;
+}
+
+#ifdef JOIN_API
+/*
+ * oracleRecheckForeignScan
+ * 		For a pushed down join, EvalPlanQual gets the row to recheck
+ * 		from the local join plan, which joins the rows from the whole-row
+ * 		references.  Nothing has to be done for base relations.
+ */
+bool
+oracleRecheckForeignScan(ForeignScanState *node, TupleTableSlot *slot)
+{
+	PlanState *outerPlan = outerPlanState(node);
+	TupleTableSlot *result;
+
+	if (((Scan *) node->ss.ps.plan)->scanrelid > 0)
+		return true;
+
+	Assert(outerPlan != NULL);
+
+	/* execute the local join plan */
+	result = ExecProcNode(outerPlan);
+	if (TupIsNull(result))
+		return false;
+
+	ExecCopySlot(slot, result);
+
+	return true;
+}
+#endif  /* JOIN_API */
+
+/*
+ * oracleReScanForeignScan
+ * 		Interrupt the Oracle query if it is still running, but keep
+ * 		the prepared statement.  The next oracleIterateForeignScan call
+ * 		binds the new parameter values and executes it again.
+ */
+void
+oracleReScanForeignScan(ForeignScanState *node)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	elog(DEBUG1, "oracle_fdw: restart foreign table scan");
+
+	/* stop fetching from the Oracle statement if there is one */
+	oracleResetStatement(fdw_state->session);
+	fdw_state->executed = false;
+
+	/* reset row count to zero */
+	fdw_state->rowcount = 0;
+
+	/*
+	 * Without parallel workers, start over with the first slice.
+	 * Otherwise, oracleReInitializeDSMForeignScan takes care of that.
+	 */
+#ifdef PARALLEL_API
+	if (fdw_state->pscan_local)
+		pg_atomic_write_u32(&fdw_state->pscan->next_slice, 0);
+#endif  /* PARALLEL_API */
+}
+
+/*
+ * oracleAddForeignUpdateTargets
  * 		Add the primary key columns as resjunk entries.
  */
 void
@@ -1601,11 +2652,15 @@ oraclePlanForeignModify(PlannerInfo *root, ModifyTable *plan, Index resultRelati
 	}
 
 #if PG_VERSION_NUM >= 90500
-	/* we don't support INSERT ... ON CONFLICT */
-	if (plan->onConflictAction != ONCONFLICT_NONE)
+	/*
+	 * We only support INSERT ... ON CONFLICT DO NOTHING.
+	 * PostgreSQL cannot infer an arbiter index on a foreign table, so
+	 * DO UPDATE should never get here.
+	 */
+	if (plan->onConflictAction == ONCONFLICT_UPDATE)
 		ereport(ERROR,
 				(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
-				errmsg("INSERT with ON CONFLICT clause is not supported")));
+				errmsg("INSERT with ON CONFLICT DO UPDATE is not supported")));
 #endif  /* PG_VERSION_NUM */
 
 	/* check if the foreign table is scanned and we already planned that scan */
@@ -1762,7 +2817,16 @@ oraclePlanForeignModify(PlannerInfo *root, ModifyTable *plan, Index resultRelati
 	switch (operation)
 	{
 		case CMD_INSERT:
-			buildInsertQuery(&sql, fdwState);
+#if PG_VERSION_NUM >= 90500
+			/* ON CONFLICT DO NOTHING becomes a MERGE on the key columns */
+			if (plan->onConflictAction == ONCONFLICT_NOTHING)
+			{
+				buildMergeQuery(&sql, fdwState);
+				fdwState->do_nothing = true;
+			}
+			else
+#endif  /* PG_VERSION_NUM */
+				buildInsertQuery(&sql, fdwState);
 
 			break;
 		case CMD_UPDATE:
@@ -1854,7 +2918,10 @@ oracleBeginForeignModify(ModifyTableState *mtstate, ResultRelInfo *rinfo, List *
 			GetCurrentTransactionNestLevel()
 		);
 
-	oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, 1, fdw_state->lob_prefetch);
+	oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, 1, fdw_state->lob_prefetch, PIPELINE_OFF);
+
+	/* look up the type input functions for the RETURNING clause */
+	initConverters(fdw_state);
 
 	/* get the type output functions for the parameters */
 	output_funcs = (regproc *)palloc0(fdw_state->oraTable->ncols * sizeof(regproc *));
@@ -1909,14 +2976,15 @@ void oracleBeginForeignInsert(ModifyTableState *mtstate, ResultRelInfo *rinfo)
 	HeapTuple tuple;
 	int i;
 	Oid check_user;
+	bool return_values;
 
 	elog(DEBUG3, "oracle_fdw: execute foreign table COPY on %d", RelationGetRelid(rel));
 
-	/* we don't support INSERT ... ON CONFLICT */
-	if (plan && plan->onConflictAction != ONCONFLICT_NONE)
+	/* we only support INSERT ... ON CONFLICT DO NOTHING */
+	if (plan && plan->onConflictAction == ONCONFLICT_UPDATE)
 		ereport(ERROR,
 				(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
-				 errmsg("INSERT with ON CONFLICT clause is not supported")));
+				 errmsg("INSERT with ON CONFLICT DO UPDATE is not supported")));
 
 	/*
 	 * If the foreign table we are about to insert routed rows into is also an
@@ -1992,8 +3060,9 @@ void oracleBeginForeignInsert(ModifyTableState *mtstate, ResultRelInfo *rinfo)
 	 * We could figure out what columns to return in the second case,
 	 * but let's keep it simple for now.
 	 */
-	if (hasTrigger(rel, CMD_INSERT)
-		|| (estate->es_plannedstmt != NULL && estate->es_plannedstmt->hasReturning))
+	return_values = hasTrigger(rel, CMD_INSERT)
+		|| (estate->es_plannedstmt != NULL && estate->es_plannedstmt->hasReturning);
+	if (return_values)
 	{
 		/* mark all attributes for returning */
 		for (i=0; i<fdw_state->oraTable->ncols; ++i)
@@ -2014,12 +3083,56 @@ void oracleBeginForeignInsert(ModifyTableState *mtstate, ResultRelInfo *rinfo)
 			}
 	}
 
-	/* construct an INSERT query */
+	/* construct an INSERT query, or a MERGE for ON CONFLICT DO NOTHING */
 	initStringInfo(&buf);
-	buildInsertQuery(&buf, fdw_state);
+	fdw_state->do_nothing = (plan && plan->onConflictAction == ONCONFLICT_NOTHING);
+	if (fdw_state->do_nothing)
+		buildMergeQuery(&buf, fdw_state);
+	else
+		buildInsertQuery(&buf, fdw_state);
 	appendReturningClause(&buf, fdw_state);
 	fdw_state->query = pstrdup(buf.data);
 
+	/*
+	 * Use a direct path load if "load_mode" asks for it and no values have
+	 * to be returned.  Since the load is committed in Oracle when it is
+	 * finished, don't use it if the transaction has already modified Oracle
+	 * data.  The values are passed as strings, so only columns whose Oracle
+	 * data type can be converted from a string are supported.
+	 */
+	fdw_state->direct_path = (fdw_state->load_table != NULL && !return_values
+							  && !fdw_state->do_nothing && !dml_in_transaction);
+	for (param=fdw_state->paramList; fdw_state->direct_path && param!=NULL; param=param->next)
+	{
+		switch (fdw_state->oraTable->cols[param->colnum]->oratype)
+		{
+			case ORA_TYPE_VARCHAR2:
+			case ORA_TYPE_CHAR:
+			case ORA_TYPE_NVARCHAR2:
+			case ORA_TYPE_NCHAR:
+			case ORA_TYPE_NUMBER:
+			case ORA_TYPE_FLOAT:
+			case ORA_TYPE_BINARYFLOAT:
+			case ORA_TYPE_BINARYDOUBLE:
+			case ORA_TYPE_RAW:
+				break;
+			case ORA_TYPE_DATE:
+				/* fractional seconds or a time zone would not be accepted */
+				if (param->type == TIMESTAMPOID || param->type == TIMESTAMPTZOID)
+					fdw_state->direct_path = false;
+				break;
+			case ORA_TYPE_TIMESTAMP:
+				/* a time zone would not be accepted */
+				if (param->type == TIMESTAMPTZOID)
+					fdw_state->direct_path = false;
+				break;
+			case ORA_TYPE_TIMESTAMPTZ:
+				break;
+			default:
+				fdw_state->direct_path = false;
+		}
+	}
+
 	/* get the type output functions for the parameters */
 	output_funcs = (regproc *)palloc0(fdw_state->oraTable->ncols * sizeof(regproc *));
 	for (param=fdw_state->paramList; param!=NULL; param=param->next)
@@ -2035,7 +3148,17 @@ void oracleBeginForeignInsert(ModifyTableState *mtstate, ResultRelInfo *rinfo)
 		ReleaseSysCache(tuple);
 	}
 
-	oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, 1, fdw_state->lob_prefetch);
+	if (fdw_state->direct_path)
+	{
+		elog(DEBUG2, "oracle_fdw: use direct path load for foreign table \"%s\"", fdw_state->oraTable->pgname);
+
+		oracleDirectPathBegin(fdw_state->session, fdw_state->load_schema, fdw_state->load_table, fdw_state->oraTable, fdw_state->paramList);
+	}
+	else
+		oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, 1, fdw_state->lob_prefetch, PIPELINE_OFF);
+
+	/* look up the type input functions for the RETURNING clause */
+	initConverters(fdw_state);
 
 	/* create a memory context for short-lived memory */
 	fdw_state->temp_cxt = AllocSetContextCreate(estate->es_query_cxt,
@@ -2052,6 +3175,10 @@ oracleEndForeignInsert(EState *estate, ResultRelInfo *rinfo)
 
 	elog(DEBUG3, "oracle_fdw: end foreign table COPY on %d", RelationGetRelid(rinfo->ri_RelationDesc));
 
+	/* send the remaining rows, the column array points to values in temp_cxt */
+	if (fdw_state->direct_path)
+		(void)oracleDirectPathFinish(fdw_state->session);
+
 	MemoryContextDelete(fdw_state->temp_cxt);
 
 	/* release the Oracle session */
@@ -2077,6 +3204,24 @@ oracleExecForeignInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *sl
 
 	dml_in_transaction = true;
 
+	if (fdw_state->direct_path)
+	{
+		/* the values have to be kept until the rows are sent to Oracle */
+		oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
+
+		setModifyParameters(fdw_state->paramList, slot, planSlot, fdw_state->oraTable, fdw_state->session);
+		rows = oracleDirectPathLoad(fdw_state->session, fdw_state->paramList);
+
+		MemoryContextSwitchTo(oldcontext);
+
+		if (rows > 0)
+			MemoryContextReset(fdw_state->temp_cxt);
+
+		++fdw_state->rowcount;
+
+		return slot;
+	}
+
 	MemoryContextReset(fdw_state->temp_cxt);
 	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
 
@@ -2093,6 +3238,10 @@ oracleExecForeignInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *sl
 
 	MemoryContextSwitchTo(oldcontext);
 
+	/* with ON CONFLICT DO NOTHING, the MERGE did not insert a conflicting row */
+	if (rows == 0 && fdw_state->do_nothing)
+		return NULL;
+
 	/* empty the result slot */
 	ExecClearTuple(slot);
 
@@ -2110,6 +3259,134 @@ oracleExecForeignInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *sl
 	return slot;
 }
 
+#if PG_VERSION_NUM >= 140000
+/*
+ * oracleGetForeignModifyBatchSize
+ * 		Return the number of rows that can be inserted with a single call
+ * 		of oracleExecForeignBatchInsert.
+ * 		Batches are not used if values have to be returned for a RETURNING
+ * 		clause or triggers, since the output parameters hold only one row.
+ */
+int
+oracleGetForeignModifyBatchSize(ResultRelInfo *rinfo)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)rinfo->ri_FdwState;
+	TriggerDesc *trigdesc = rinfo->ri_TrigDesc;
+	struct paramDesc *param;
+
+	elog(DEBUG3, "oracle_fdw: get batch size for foreign table insert on %d", RelationGetRelid(rinfo->ri_RelationDesc));
+
+	/* a direct path load collects the rows itself */
+	if (fdw_state == NULL
+		|| fdw_state->direct_path
+		|| rinfo->ri_projectReturning != NULL
+		|| rinfo->ri_WithCheckOptions != NIL
+		|| (trigdesc != NULL
+			&& (trigdesc->trig_insert_before_row || trigdesc->trig_insert_after_row)))
+		return 1;
+
+	/*
+	 * Only parameters that can be bound as arrays are possible.
+	 * LOB, LONG and RAW values can be very long, and each array element
+	 * would need the size of the longest value.
+	 */
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		if (param->bindType == BIND_OUTPUT || param->bindType == BIND_GEOMETRY
+			|| param->bindType == BIND_LONG || param->bindType == BIND_LONGRAW)
+			return 1;
+
+	return (int)fdw_state->batch_size;
+}
+
+/*
+ * oracleExecForeignBatchInsert
+ * 		Set the parameter values from all slots and execute the INSERT
+ * 		statement once for the whole batch.
+ * 		Returns the slots unchanged, since there is no RETURNING clause.
+ */
+TupleTableSlot **
+oracleExecForeignBatchInsert(EState *estate, ResultRelInfo *rinfo, TupleTableSlot **slots, TupleTableSlot **planSlots, int *numSlots)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)rinfo->ri_FdwState;
+	struct paramDesc *param;
+	unsigned int rows, *row_counts = NULL;
+	MemoryContext oldcontext;
+	int i;
+
+	elog(DEBUG3, "oracle_fdw: execute foreign table batch insert of %d rows on %d", *numSlots, RelationGetRelid(rinfo->ri_RelationDesc));
+
+	dml_in_transaction = true;
+
+	MemoryContextReset(fdw_state->temp_cxt);
+	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
+
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		param->values = (char **)palloc(*numSlots * sizeof(char *));
+
+	/* extract the values from the slots and collect them in the parameters */
+	for (i=0; i<*numSlots; ++i)
+	{
+		setModifyParameters(fdw_state->paramList, slots[i], planSlots[i], fdw_state->oraTable, fdw_state->session);
+
+		for (param=fdw_state->paramList; param!=NULL; param=param->next)
+			param->values[i] = param->value;
+	}
+
+	/* with ON CONFLICT DO NOTHING, we need to know which rows were inserted */
+	if (fdw_state->do_nothing)
+		row_counts = (unsigned int *)palloc(*numSlots * sizeof(unsigned int));
+
+	/* execute the INSERT statement for all rows */
+	rows = oracleExecuteBatch(fdw_state->session, fdw_state->paramList, (unsigned int)*numSlots, row_counts);
+
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		param->values = NULL;
+
+	if (rows > (unsigned int)*numSlots)
+		ereport(ERROR,
+				(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+				errmsg("INSERT on Oracle table added %u rows instead of %d in iteration %lu", rows, *numSlots, fdw_state->rowcount)));
+
+	MemoryContextSwitchTo(oldcontext);
+
+	fdw_state->rowcount += rows;
+
+	/*
+	 * With ON CONFLICT DO NOTHING, only report the rows that were inserted.
+	 * They are moved to the beginning of the array.  The slots are swapped
+	 * rather than overwritten, because the executor owns and reuses them.
+	 */
+	if (fdw_state->do_nothing)
+	{
+		int inserted = 0;
+
+		for (i=0; i<*numSlots; ++i)
+		{
+			if (row_counts[i] == 0)
+				continue;
+
+			if (i != inserted)
+			{
+				TupleTableSlot *tmp;
+
+				tmp = slots[inserted];
+				slots[inserted] = slots[i];
+				slots[i] = tmp;
+
+				tmp = planSlots[inserted];
+				planSlots[inserted] = planSlots[i];
+				planSlots[i] = tmp;
+			}
+			++inserted;
+		}
+
+		*numSlots = inserted;
+	}
+
+	return slots;
+}
+#endif  /* PG_VERSION_NUM >= 140000 */
+
 /*
  * oracleExecForeignUpdate
  * 		Set the parameter values from the slots and execute the UPDATE statement.
@@ -2126,6 +3403,14 @@ oracleExecForeignUpdate(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *sl
 
 	dml_in_transaction = true;
 
+	/* collect the row for a batch if possible */
+	if (canBatchModify(rinfo))
+	{
+		queueModifyRow(fdw_state, CMD_UPDATE, slot, planSlot);
+
+		return slot;
+	}
+
 	MemoryContextReset(fdw_state->temp_cxt);
 	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
 
@@ -2176,6 +3461,14 @@ oracleExecForeignDelete(EState *estate, ResultRelInfo *rinfo, TupleTableSlot *sl
 
 	dml_in_transaction = true;
 
+	/* collect the row for a batch if possible */
+	if (canBatchModify(rinfo))
+	{
+		queueModifyRow(fdw_state, CMD_DELETE, slot, planSlot);
+
+		return slot;
+	}
+
 	MemoryContextReset(fdw_state->temp_cxt);
 	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
 
@@ -2220,6 +3513,9 @@ oracleEndForeignModify(EState *estate, ResultRelInfo *rinfo){
 
 	elog(DEBUG1, "oracle_fdw: end foreign table modify on %d", RelationGetRelid(rinfo->ri_RelationDesc));
 
+	/* send the remaining rows of a batched UPDATE or DELETE */
+	flushModifyBatch(fdw_state);
+
 	MemoryContextDelete(fdw_state->temp_cxt);
 
 	/* release the Oracle session */
@@ -2241,46 +3537,460 @@ oracleExplainForeignModify(ModifyTableState *mtstate, ResultRelInfo *rinfo, List
 
 	/* show query */
 	ExplainPropertyText("Oracle statement", fdw_state->query, es);
+
+	/* show the batch size */
+	if (mtstate->operation != CMD_INSERT && canBatchModify(rinfo))
+#if PG_VERSION_NUM >= 110000
+		ExplainPropertyInteger("Oracle batch size", "rows", (int64)fdw_state->batch_size, es);
+#else
+		ExplainPropertyLong("Oracle batch size", (long)fdw_state->batch_size, es);
+#endif  /* PG_VERSION_NUM */
+#if PG_VERSION_NUM >= 140000
+	else if (rinfo->ri_BatchSize > 1)
+		ExplainPropertyInteger("Oracle batch size", "rows", (int64)rinfo->ri_BatchSize, es);
+#endif  /* PG_VERSION_NUM >= 140000 */
 }
 
+#ifdef DIRECT_MODIFY_API
 /*
- * oracleIsForeignRelUpdatable
- * 		Returns 0 if "readonly" is set, a value indicating that all DML is allowed.
+ * oraclePlanDirectModify
+ * 		Check if an UPDATE or DELETE can be executed as a single Oracle
+ * 		statement rather than row by row.  That is possible if the subplan
+ * 		is a scan of the foreign table, all conditions and SET expressions
+ * 		can be pushed down and there is no RETURNING clause.
+ * 		If yes, turn the foreign scan into the modification and return true.
  */
-int
-oracleIsForeignRelUpdatable(Relation rel)
+bool
+oraclePlanDirectModify(PlannerInfo *root, ModifyTable *plan, Index resultRelation, int subplan_index)
 {
+	CmdType operation = plan->operation;
+	RangeTblEntry *rte = planner_rt_fetch(resultRelation, root);
+	RelOptInfo *baserel;
+	ForeignScan *fscan;
+	struct OracleFdwState *fdwState, *dmState;
+	List *params, *targetAttrs = NIL;
+#if PG_VERSION_NUM >= 140000
+	List *processed_tlist = NIL;
+#endif  /* PG_VERSION_NUM */
+#if PG_VERSION_NUM >= 120000
+	Relation rel;
+	bool has_generated;
+#endif  /* PG_VERSION_NUM */
 	ListCell *cell;
+	StringInfoData sql;
+	bool firstcol;
+	int i;
 
-	/* loop foreign table options */
-	foreach(cell, GetForeignTable(RelationGetRelid(rel))->options)
-	{
-		DefElem *def = (DefElem *) lfirst(cell);
-		if (strcmp(def->defname, OPT_READONLY) == 0 && getBoolVal(def))
-			return 0;
-	}
+	if (operation != CMD_UPDATE && operation != CMD_DELETE)
+		return false;
 
-	return (1 << CMD_UPDATE) | (1 << CMD_INSERT) | (1 << CMD_DELETE);
-}
+	/*
+	 * With RETURNING INTO, Oracle returns the values of all modified rows
+	 * in arrays, but our output parameters can only hold a single row
+	 * (see appendReturningClause).
+	 */
+	if (plan->returningLists != NIL)
+		return false;
 
-#ifdef IMPORT_API
-/*
- * oracleImportForeignSchema
- * 		Returns a List of CREATE FOREIGN TABLE statements.
- */
-List *
-oracleImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid)
-{
-	ForeignServer *server;
-	UserMapping *mapping;
-	ForeignDataWrapper *wrapper;
-	char *tabname, *colname, oldtabname[129] = { '\0' }, *foldedname;
-	char *nls_lang = NULL, *user = NULL, *password = NULL,
-		 *dbserver = NULL, *dblink = NULL, *max_long = NULL,
-		 *sample_percent = NULL, *prefetch = NULL, *lob_prefetch = NULL,
-		 *limit_to = NULL;
-	oraType type;
-	int charlen, typeprec, typescale, nullable, key, rc;
+	/* the subplan must be a scan of the foreign table ... */
+	fscan = findModifySubplan(plan, resultRelation, subplan_index);
+	if (fscan == NULL)
+		return false;
+
+	/* ... without conditions that have to be checked locally */
+	if (fscan->scan.plan.qual != NIL)
+		return false;
+
+#if PG_VERSION_NUM >= 120000
+	/*
+	 * Generated columns are computed locally.
+	 * Core code already has some lock on each rel being planned,
+	 * so we can use NoLock here.
+	 */
+	rel = table_open(rte->relid, NoLock);
+	has_generated = (RelationGetDescr(rel)->constr != NULL
+					 && RelationGetDescr(rel)->constr->has_generated_stored);
+	table_close(rel, NoLock);
+
+	if (has_generated)
+		return false;
+#endif  /* PG_VERSION_NUM */
+
+	baserel = find_base_rel(root, resultRelation);
+	fdwState = (struct OracleFdwState *)baserel->fdw_private;
+
+	/* the WHERE clause of the scan can use the parameters of the scan */
+	params = list_copy(fdwState->params);
+
+	/* the modification gets its own copy of the foreign table description */
+	dmState = copyPlanData(fdwState);
+	initStringInfo(&sql);
+
+	if (operation == CMD_UPDATE)
+	{
+		/* get the updated columns and the expressions for their new values */
+#if PG_VERSION_NUM >= 140000
+		get_translated_update_targetlist(root, resultRelation, &processed_tlist, &targetAttrs);
+#else
+		int col = -1;
+
+		while ((col = bms_next_member(rte->updatedCols, col)) >= 0)
+			targetAttrs = lappend_int(targetAttrs, col + FirstLowInvalidHeapAttributeNumber);
+#endif  /* PG_VERSION_NUM */
+
+		appendStringInfo(&sql, "UPDATE %s %s%d SET ",
+						 dmState->oraTable->name, REL_ALIAS_PREFIX, resultRelation);
+
+		firstcol = true;
+		foreach(cell, targetAttrs)
+		{
+			AttrNumber attnum = (AttrNumber)lfirst_int(cell);
+			TargetEntry *tle;
+			char *value;
+
+			if (attnum <= InvalidAttrNumber)  /* shouldn't happen */
+				elog(ERROR, "system-column update is not supported");
+
+#if PG_VERSION_NUM >= 140000
+			tle = (TargetEntry *)list_nth(processed_tlist, foreach_current_index(cell));
+#else
+			tle = get_tle_by_resno(fscan->scan.plan.targetlist, attnum);
+#endif  /* PG_VERSION_NUM */
+			if (tle == NULL)
+				elog(ERROR, "attribute number %d not found in subplan targetlist", attnum);
+
+			/* find the corresponding oraTable entry */
+			for (i=0; i<dmState->oraTable->ncols; ++i)
+				if (dmState->oraTable->cols[i]->pgattnum == attnum)
+					break;
+
+			/* ignore columns that don't occur in the foreign table */
+			if (i == dmState->oraTable->ncols || dmState->oraTable->cols[i]->pgtype == 0)
+				continue;
+
+			/* Oracle has no boolean values that could be assigned */
+			if (dmState->oraTable->cols[i]->pgtype == BOOLOID)
+				return false;
+
+			/* check that the data types can be converted */
+			checkDataType(
+				dmState->oraTable->cols[i]->oratype,
+				dmState->oraTable->cols[i]->scale,
+				dmState->oraTable->cols[i]->pgtype,
+				dmState->oraTable->pgname,
+				dmState->oraTable->cols[i]->pgname
+			);
+
+			/* the new value must be computed by Oracle */
+			value = deparseExpr(
+						fdwState->session, baserel,
+						tle->expr,
+						fdwState->oraTable,
+						&params,
+						false
+					);
+			if (value == NULL)
+				return false;
+
+			appendStringInfo(&sql, "%s%s = %s",
+							 (firstcol ? "" : ", "),
+							 dmState->oraTable->cols[i]->name,
+							 value);
+			firstcol = false;
+		}
+
+		/* let the regular UPDATE throw an error if no Oracle column is modified */
+		if (firstcol)
+			return false;
+	}
+	else
+		appendStringInfo(&sql, "DELETE FROM %s %s%d",
+						 dmState->oraTable->name, REL_ALIAS_PREFIX, resultRelation);
+
+	/* the conditions of the scan become the WHERE clause of the statement */
+	if (fdwState->where_clause)
+		appendStringInfo(&sql, "%s", fdwState->where_clause);
+
+	dmState->query = sql.data;
+	dmState->set_processed = plan->canSetTag;
+
+	elog(DEBUG1, "oracle_fdw: remote statement is: %s", dmState->query);
+
+	/* turn the foreign scan into the modification */
+	fscan->operation = operation;
+#if PG_VERSION_NUM >= 140000
+	fscan->resultRelation = resultRelation;
+#endif  /* PG_VERSION_NUM */
+	fscan->fdw_exprs = params;
+	fscan->fdw_private = serializePlanData(dmState);
+
+#ifdef ASYNC_API
+	/* there is nothing to fetch asynchronously */
+	fscan->scan.plan.async_capable = false;
+#endif  /* ASYNC_API */
+
+	return true;
+}
+
+/*
+ * oracleBeginDirectModify
+ * 		Recover the modification statement and its parameters from
+ * 		the plan's "fdw_private" field, connect to Oracle and
+ * 		prepare the statement.
+ */
+void
+oracleBeginDirectModify(ForeignScanState *node, int eflags)
+{
+	struct OracleFdwState *fdw_state;
+
+	/* deserialize private plan data */
+	fdw_state = deserializePlanData(((ForeignScan *)node->ss.ps.plan)->fdw_private);
+	node->fdw_state = (void *)fdw_state;
+
+	/* create the list of parameters */
+	createScanParams(node, fdw_state);
+
+	elog(DEBUG1, "oracle_fdw: begin direct modification on %d", RelationGetRelid(node->ss.ss_currentRelation));
+
+	/* connect to Oracle database */
+	fdw_state->session = oracleGetSession(
+			fdw_state->dbserver,
+			fdw_state->isolation_level,
+			fdw_state->user,
+			fdw_state->password,
+			fdw_state->nls_lang,
+			fdw_state->timezone,
+			(int)fdw_state->have_nchar,
+			fdw_state->oraTable->pgname,
+			GetCurrentTransactionNestLevel()
+		);
+
+	oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, 1, fdw_state->lob_prefetch, PIPELINE_OFF);
+
+	/* initialize row count to zero */
+	fdw_state->rowcount = 0;
+}
+
+/*
+ * oracleIterateDirectModify
+ * 		Execute the modification statement on the first call and add
+ * 		the number of modified rows to the command status.
+ * 		Since there is no RETURNING clause, no rows are returned.
+ */
+TupleTableSlot *
+oracleIterateDirectModify(ForeignScanState *node)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+	EState *estate = node->ss.ps.state;
+	char *paramInfo;
+
+	if (!fdw_state->executed)
+	{
+		dml_in_transaction = true;
+
+		/* fill the parameter list with the actual values */
+		paramInfo = setSelectParameters(fdw_state->paramList, node->ss.ps.ps_ExprContext);
+
+		elog(DEBUG1, "oracle_fdw: execute direct modification%s", paramInfo);
+
+		fdw_state->rowcount = oracleExecuteQuery(fdw_state->session, fdw_state->oraTable, fdw_state->paramList, 1);
+		fdw_state->executed = true;
+
+		elog(DEBUG2, "oracle_fdw: direct modification processed %lu rows", fdw_state->rowcount);
+
+		if (fdw_state->set_processed)
+			estate->es_processed += fdw_state->rowcount;
+
+		/* count the rows for EXPLAIN ANALYZE */
+		if (node->ss.ps.instrument)
+			node->ss.ps.instrument->tuplecount += fdw_state->rowcount;
+	}
+
+	return ExecClearTuple(node->ss.ss_ScanTupleSlot);
+}
+
+/*
+ * oracleEndDirectModify
+ * 		Close the Oracle statement.
+ */
+void
+oracleEndDirectModify(ForeignScanState *node)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	elog(DEBUG1, "oracle_fdw: end direct modification");
+
+	/* release the Oracle session */
+	oracleCloseStatement(fdw_state->session);
+	pfree(fdw_state->session);
+	fdw_state->session = NULL;
+}
+
+/*
+ * oracleExplainDirectModify
+ * 		Show the Oracle DML statement.
+ */
+void
+oracleExplainDirectModify(ForeignScanState *node, struct ExplainState *es)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	elog(DEBUG1, "oracle_fdw: explain direct modification");
+
+	/* show statement */
+	ExplainPropertyText("Oracle statement", fdw_state->query, es);
+}
+#endif  /* DIRECT_MODIFY_API */
+
+#if PG_VERSION_NUM >= 140000
+/*
+ * oracleExecForeignTruncate
+ * 		Truncate the Oracle tables of foreign tables on one foreign server.
+ * 		All tables are truncated in a single PL/SQL block, so that there
+ * 		is only one round trip.
+ * 		TRUNCATE is DDL in Oracle and commits the Oracle transaction, so it
+ * 		is refused if that would commit modifications or drop savepoints.
+ */
+void
+oracleExecForeignTruncate(List *rels, DropBehavior behavior, bool restart_seqs)
+{
+	ListCell *lc;
+	StringInfoData buf;
+	ForeignServer *server = NULL;
+	NameData srvname;
+	oracleSession *session;
+
+	elog(DEBUG1, "oracle_fdw: truncate %d foreign tables", list_length(rels));
+
+	if (dml_in_transaction)
+		ereport(ERROR,
+				(errcode(ERRCODE_ACTIVE_SQL_TRANSACTION),
+				errmsg("cannot truncate Oracle tables in a transaction that modified Oracle data"),
+				errhint("TRUNCATE commits the Oracle transaction.")));
+
+	if (GetCurrentTransactionNestLevel() > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_ACTIVE_SQL_TRANSACTION),
+				errmsg("cannot truncate Oracle tables in a subtransaction"),
+				errhint("TRUNCATE commits the Oracle transaction, which removes the savepoints.")));
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf, "BEGIN\n");
+
+	foreach(lc, rels)
+	{
+		Relation rel = (Relation) lfirst(lc);
+		Oid relid = RelationGetRelid(rel);
+		List *options;
+		ListCell *cell;
+		char *schema = NULL, *table = NULL, *dblink = NULL, *storage = NULL;
+		bool truncatable = false, readonly = false;
+
+		oracleGetOptions(relid, InvalidOid, &options);
+		foreach(cell, options)
+		{
+			DefElem *def = (DefElem *) lfirst(cell);
+			if (strcmp(def->defname, OPT_SCHEMA) == 0)
+				schema = strVal(def->arg);
+			if (strcmp(def->defname, OPT_TABLE) == 0)
+				table = strVal(def->arg);
+			if (strcmp(def->defname, OPT_DBLINK) == 0)
+				dblink = strVal(def->arg);
+			if (strcmp(def->defname, OPT_TRUNCATE_STORAGE) == 0)
+				storage = strVal(def->arg);
+			if (strcmp(def->defname, OPT_TRUNCATABLE) == 0)
+				truncatable = getBoolVal(def);
+			if (strcmp(def->defname, OPT_READONLY) == 0)
+				readonly = getBoolVal(def);
+		}
+
+		if (!truncatable || readonly)
+			ereport(ERROR,
+					(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					errmsg("foreign table \"%s\" does not allow truncates", RelationGetRelationName(rel)),
+					errhint("Set the option \"%s\" on the foreign table or its server.", OPT_TRUNCATABLE)));
+
+		if (table == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_FDW_OPTION_NAME_NOT_FOUND),
+					errmsg("required option \"%s\" in foreign table \"%s\" missing", OPT_TABLE, RelationGetRelationName(rel))));
+
+		if (dblink != NULL || table[0] == '(')
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					errmsg("cannot truncate foreign table \"%s\"", RelationGetRelationName(rel)),
+					errdetail("Only tables in the Oracle database can be truncated, not queries or tables across a database link.")));
+
+		/* all tables belong to the same foreign server */
+		if (server == NULL)
+			server = GetForeignServer(GetForeignTable(relid)->serverid);
+
+		appendStringInfoString(&buf, "   EXECUTE IMMEDIATE 'TRUNCATE TABLE ");
+		if (schema != NULL)
+		{
+			appendOracleName(&buf, schema);
+			appendStringInfoChar(&buf, '.');
+		}
+		appendOracleName(&buf, table);
+		appendStringInfo(&buf, " %s STORAGE%s';\n",
+						 (storage != NULL && strcmp(storage, "reuse") == 0) ? "REUSE" : "DROP",
+						 (behavior == DROP_CASCADE) ? " CASCADE" : "");
+	}
+
+	appendStringInfoString(&buf, "END;");
+
+	if (server == NULL)
+		return;
+
+	/* connect to the foreign server and run the statement */
+	namestrcpy(&srvname, server->servername);
+	session = oracleConnectServer(&srvname);
+
+	oracleExecuteCall(session, buf.data);
+
+	/* free the session (connection will be cached) */
+	pfree(session);
+}
+#endif  /* PG_VERSION_NUM >= 140000 */
+
+/*
+ * oracleIsForeignRelUpdatable
+ * 		Returns 0 if "readonly" is set, a value indicating that all DML is allowed.
+ */
+int
+oracleIsForeignRelUpdatable(Relation rel)
+{
+	ListCell *cell;
+
+	/* loop foreign table options */
+	foreach(cell, GetForeignTable(RelationGetRelid(rel))->options)
+	{
+		DefElem *def = (DefElem *) lfirst(cell);
+		if (strcmp(def->defname, OPT_READONLY) == 0 && getBoolVal(def))
+			return 0;
+	}
+
+	return (1 << CMD_UPDATE) | (1 << CMD_INSERT) | (1 << CMD_DELETE);
+}
+
+#ifdef IMPORT_API
+/*
+ * oracleImportForeignSchema
+ * 		Returns a List of CREATE FOREIGN TABLE statements.
+ */
+List *
+oracleImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid)
+{
+	ForeignServer *server;
+	UserMapping *mapping;
+	ForeignDataWrapper *wrapper;
+	char *tabname, *colname, oldtabname[129] = { '\0' }, *foldedname;
+	char *nls_lang = NULL, *user = NULL, *password = NULL,
+		 *dbserver = NULL, *dblink = NULL, *max_long = NULL,
+		 *sample_percent = NULL, *prefetch = NULL, *lob_prefetch = NULL,
+		 *limit_to = NULL;
+	oraType type;
+	int charlen, typeprec, typescale, nullable, key, rc;
 	List *options, *result = NIL;
 	ListCell *cell;
 	oracleSession *session;
@@ -2703,7 +4413,8 @@ oracleImportForeignSchema(ImportForeignSchemaStmt *stmt, Oid serverOid)
  * 		Construct an OracleFdwState from the options of the foreign table.
  * 		Establish an Oracle connection and get a description of the
  * 		remote table.
- * 		"sample_percent" is set from the foreign table options.
+ * 		"sample_percent" is set from the foreign table options,
+ * 		or to -1 if the option is not set.
  * 		"sample_percent" can be NULL, in that case it is not set.
  * 		"userid" determines the use to connect as; if invalid, the current
  * 		user is used.
@@ -2717,10 +4428,12 @@ struct OracleFdwState
 	ListCell *cell;
 	char *isolationlevel = NULL;
 	char *dblink = NULL, *schema = NULL, *table = NULL, *maxlong = NULL,
-		 *sample = NULL, *fetch = NULL, *lob_prefetch = NULL;
+		 *sample = NULL, *fetch = NULL, *lob_prefetch = NULL, *fetch_memory = NULL,
+		 *parallel_workers = NULL, *batch_size = NULL, *load_mode = NULL;
 	long max_long;
 	int has_geometry = 0;
-	bool nchar = false, set_timezone = false;
+	bool nchar = false, set_timezone = false, pipeline_fetch = false, async_capable = false,
+		 use_remote_estimate = false;
 
 	/*
 	 * Get all relevant options from the foreign table, the user mapping,
@@ -2754,10 +4467,24 @@ struct OracleFdwState
 			fetch = strVal(def->arg);
 		if (strcmp(def->defname, OPT_LOB_PREFETCH) == 0)
 			lob_prefetch = strVal(def->arg);
+		if (strcmp(def->defname, OPT_FETCH_MEMORY) == 0)
+			fetch_memory = strVal(def->arg);
 		if (strcmp(def->defname, OPT_NCHAR) == 0)
 			nchar = getBoolVal(def);
 		if (strcmp(def->defname, OPT_SET_TIMEZONE) == 0)
 			set_timezone = getBoolVal(def);
+		if (strcmp(def->defname, OPT_PIPELINE_FETCH) == 0)
+			pipeline_fetch = getBoolVal(def);
+		if (strcmp(def->defname, OPT_ASYNC_CAPABLE) == 0)
+			async_capable = getBoolVal(def);
+		if (strcmp(def->defname, OPT_USE_REMOTE_ESTIMATE) == 0)
+			use_remote_estimate = getBoolVal(def);
+		if (strcmp(def->defname, OPT_PARALLEL_WORKERS) == 0)
+			parallel_workers = strVal(def->arg);
+		if (strcmp(def->defname, OPT_BATCH_SIZE) == 0)
+			batch_size = strVal(def->arg);
+		if (strcmp(def->defname, OPT_LOAD_MODE) == 0)
+			load_mode = strVal(def->arg);
 	}
 
 	/* set isolation_level (or use default) */
@@ -2776,7 +4503,7 @@ struct OracleFdwState
 	if (sample_percent != NULL)
 	{
 		if (sample == NULL)
-			*sample_percent = 100.0;
+			*sample_percent = -1.0;
 		else
 			*sample_percent = strtod(sample, NULL);
 	}
@@ -2793,6 +4520,54 @@ struct OracleFdwState
 	else
 		fdwState->lob_prefetch = (unsigned int)strtoul(lob_prefetch, NULL, 0);
 
+	/* convert "batch_size" to number (or insert one row at a time) */
+	if (batch_size == NULL)
+		fdwState->batch_size = 1;
+	else
+		fdwState->batch_size = (unsigned int)strtoul(batch_size, NULL, 0);
+
+	/*
+	 * Convert "fetch_memory" to number (or use the parameter's value).
+	 * An explicit "prefetch" takes precedence.  The actual number of rows
+	 * is determined when the columns used in the query are known.
+	 */
+	if (fetch != NULL)
+		fdwState->fetch_memory = 0;
+	else if (fetch_memory == NULL)
+		fdwState->fetch_memory = (unsigned int)default_fetch_memory;
+	else
+	{
+		int val;
+
+		(void)parse_int(fetch_memory, &val, GUC_UNIT_KB, NULL);
+		fdwState->fetch_memory = (unsigned int)val;
+	}
+
+	/* should we fetch the next rows in the background? */
+	fdwState->pipeline_fetch = pipeline_fetch;
+
+	/* parallel scans need a ROWID and are not possible across a database link */
+	if (parallel_workers == NULL || dblink != NULL
+			|| (table != NULL && table[0] == '('))
+		fdwState->parallel_workers = 0;
+	else
+		fdwState->parallel_workers = (int)strtol(parallel_workers, NULL, 0);
+
+	/* direct path loads are not possible across a database link or into a query */
+	if (load_mode != NULL && strcmp(load_mode, "direct_path") == 0
+			&& dblink == NULL && table != NULL && table[0] != '(')
+	{
+		fdwState->load_schema = schema;
+		fdwState->load_table = table;
+	}
+
+	/* asynchronous execution needs the pipelined fetch */
+	fdwState->async_capable = async_capable;
+	if (async_capable)
+		fdwState->pipeline_fetch = true;
+
+	fdwState->use_remote_estimate = use_remote_estimate;
+
 	/* should we use the expensive, but correct NCHAR conversion? */
 	fdwState->have_nchar = nchar;
 
@@ -2826,9 +4601,15 @@ struct OracleFdwState
 	/* get remote table description */
 	fdwState->oraTable = oracleDescribe(fdwState->session, dblink, schema, table, pgtablename, max_long, &has_geometry);
 
-	/* don't try array prefetching with geometries */
+	/* don't try array prefetching or batch inserts with geometries */
 	if (has_geometry)
+	{
 		fdwState->prefetch = 1;
+		fdwState->batch_size = 1;
+		fdwState->load_table = NULL;
+		fdwState->fetch_memory = 0;
+		fdwState->pipeline_fetch = false;
+	}
 
 	/* add PostgreSQL data to table description */
 	getColumnData(foreigntableid, fdwState->oraTable);
@@ -2911,6 +4692,9 @@ getColumnData(Oid foreigntableid, struct oraTable *oraTable)
 			oraTable->cols[index-1]->pgtypmod = att_tuple->atttypmod;
 			oraTable->cols[index-1]->pgname = pstrdup(NameStr(att_tuple->attname));
 
+			/* retrieve numeric values in binary form where possible */
+			setFetchType(oraTable->cols[index-1]);
+
 			/* loop through column options */
 			options = GetForeignColumnOptions(foreigntableid, att_tuple->attnum);
 			foreach(option, options)
@@ -2933,857 +4717,2846 @@ getColumnData(Oid foreigntableid, struct oraTable *oraTable)
 }
 
 /*
- * createQuery
- * 		Construct a query string for Oracle that
- * 		a) contains only the necessary columns in the SELECT list
- * 		b) has all the WHERE and ORDER BY clauses that can safely be translated to Oracle.
- * 		Untranslatable clauses are omitted and left for PostgreSQL to check.
- * 		"query_pathkeys" contains the desired sort order of the scan results
- * 		which will be translated to ORDER BY clauses if possible.
- *		As a side effect for base relations, we also mark the used columns in oraTable.
+ * setFetchType
+ * 		Determine the format in which the values of a column are retrieved
+ * 		from Oracle, based on the Oracle and the PostgreSQL data type.
+ * 		Numbers that are converted to integer or floating point types and
+ * 		date/time values that are converted to date/time types are fetched
+ * 		in binary form to avoid converting them to strings and back.
+ * 		The buffer size "val_size" is adjusted accordingly.
  */
-char
-*createQuery(struct OracleFdwState *fdwState, RelOptInfo *foreignrel, bool for_update, List *query_pathkeys)
+void
+setFetchType(struct oraColumn *column)
 {
-	ListCell *cell;
-	bool in_quote = false;
-	int i, index;
-	char *wherecopy, *p, hash_str[17], parname[10], *separator = "";
-	long queryhash;
-	StringInfoData query, result;
-	List *columnlist,
-		*conditions = foreignrel->baserestrictinfo;
+	column->fetchtype = FETCH_DEFAULT;
 
-#if PG_VERSION_NUM < 90600
-	columnlist = foreignrel->reltargetlist;
-#else
-	columnlist = foreignrel->reltarget->exprs;
+	switch (column->pgtype)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			if (column->oratype == ORA_TYPE_NUMBER)
+				column->fetchtype = FETCH_NUMBER;
+			break;
+		case NUMERICOID:
+			if (column->oratype == ORA_TYPE_NUMBER
+					|| column->oratype == ORA_TYPE_FLOAT)
+				column->fetchtype = FETCH_NUMBER;
+			break;
+		case FLOAT4OID:
+			if (column->oratype == ORA_TYPE_BINARYFLOAT)
+			{
+				column->fetchtype = FETCH_BFLOAT;
+				break;
+			}
+			/* other types are fetched as float8 and converted to float4 later */
+#ifdef pg_fallthrough
+			pg_fallthrough;
 #endif
+			/* fall through */
+		case FLOAT8OID:
+			if (column->oratype == ORA_TYPE_NUMBER
+					|| column->oratype == ORA_TYPE_FLOAT
+					|| column->oratype == ORA_TYPE_BINARYFLOAT
+					|| column->oratype == ORA_TYPE_BINARYDOUBLE)
+				column->fetchtype = FETCH_BDOUBLE;
+			break;
+#if PG_VERSION_NUM >= 100000 || defined(HAVE_INT64_TIMESTAMP)
+		case DATEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			if (column->oratype == ORA_TYPE_DATE)
+				column->fetchtype = FETCH_DATE;
+			else if (column->oratype == ORA_TYPE_TIMESTAMP)
+				column->fetchtype = FETCH_TIMESTAMP;
+			/* TIMESTAMP WITH LOCAL TIME ZONE is selected AT TIME ZONE sessiontimezone */
+			else if (column->oratype == ORA_TYPE_TIMESTAMPTZ
+					|| column->oratype == ORA_TYPE_TIMESTAMPLTZ)
+				column->fetchtype = FETCH_TIMESTAMPTZ;
+			break;
+		case INTERVALOID:
+			if (column->oratype == ORA_TYPE_INTERVALY2M)
+				column->fetchtype = FETCH_INTERVALYM;
+			else if (column->oratype == ORA_TYPE_INTERVALD2S)
+				column->fetchtype = FETCH_INTERVALDS;
+			break;
+#endif  /* PG_VERSION_NUM */
+		default:
+			break;
+	}
 
-#ifdef JOIN_API
-	if (IS_SIMPLE_REL(foreignrel))
-#endif  /* JOIN_API */
+	switch (column->fetchtype)
 	{
-		/* find all the columns to include in the select list */
-
-		/* examine each SELECT list entry for Var nodes */
-		foreach(cell, columnlist)
-		{
-			getUsedColumns((Expr *)lfirst(cell), fdwState->oraTable, foreignrel->relid);
-		}
-
-		/* examine each condition for Var nodes */
-		foreach(cell, conditions)
-		{
-			getUsedColumns((Expr *)lfirst(cell), fdwState->oraTable, foreignrel->relid);
-		}
+		case FETCH_NUMBER:
+			column->val_size = ORA_NUMBER_SIZE;
+			break;
+		case FETCH_BFLOAT:
+			column->val_size = sizeof(float4);
+			break;
+		case FETCH_BDOUBLE:
+			column->val_size = sizeof(float8);
+			break;
+		case FETCH_DATE:
+			column->val_size = ORA_DATE_SIZE;
+			break;
+		case FETCH_TIMESTAMP:
+		case FETCH_TIMESTAMPTZ:
+		case FETCH_INTERVALYM:
+		case FETCH_INTERVALDS:
+			/* "val" holds pointers to descriptors allocated in oraclePrepareQuery */
+			column->val_size = sizeof(void *);
+			break;
+		default:
+			break;
 	}
+}
 
-	/* construct SELECT list */
-	initStringInfo(&query);
-	for (i=0; i<fdwState->oraTable->ncols; ++i)
-	{
-		if (fdwState->oraTable->cols[i]->used)
-		{
-			char *format;
-			StringInfoData alias;
+/*
+ * getFetchRows
+ * 		Compute how many result rows fit into "fetch_memory".
+ * 		The size of a row is the sum of the buffer sizes of the used columns,
+ * 		including length and indicator.  For LOBs, the prefetched bytes count.
+ */
+unsigned int
+getFetchRows(struct OracleFdwState *fdw_state)
+{
+	Size row_size = 0, rows;
+	int i;
 
-			initStringInfo(&alias);
-			/* table alias is created from range table index */
-			ADD_REL_QUALIFIER(&alias, fdwState->oraTable->cols[i]->varno);
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	{
+		struct oraColumn *col = fdw_state->oraTable->cols[i];
 
-			/* format for qualified column name */
-			if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_XMLTYPE)
-				/* convert XML to CLOB in the query */
-				format = "%s(%s%s).getclobval()";
-			else if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_TIMESTAMPLTZ)
-				/* convert TIMESTAMP WITH LOCAL TIME ZONE to TIMESTAMP WITH TIME ZONE */
-				format = "%s(%s%s AT TIME ZONE sessiontimezone)";
-			else if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
-				format = "%sTO_CLOB(%s%s)";
-			else
-				/* select the column as it is */
-				format = "%s%s%s";
+		if (!col->used)
+			continue;
 
-			appendStringInfo(&query,
-							 format,
-							 separator,
-							 alias.data,
-							 fdwState->oraTable->cols[i]->name);
+		row_size += col->val_size + sizeof(uint16) + sizeof(int16);
 
-			separator = ", ";
-		}
+		if (col->oratype == ORA_TYPE_BLOB
+				|| col->oratype == ORA_TYPE_BFILE
+				|| col->oratype == ORA_TYPE_CLOB
+				|| col->oratype == ORA_TYPE_NCLOB)
+			row_size += fdw_state->lob_prefetch;
 	}
 
-	/* dummy column if there is no result column we need from Oracle */
-	if (separator[0] == '\0')
-		appendStringInfo(&query, "'1'");
+	/* avoid division by zero if no columns are used */
+	if (row_size == 0)
+		row_size = 1;
 
-	/* append FROM clause */
-	appendStringInfo(&query, " FROM ");
-	deparseFromExprForRel(fdwState, &query, foreignrel,
-							&(fdwState->params));
+	rows = (Size)fdw_state->fetch_memory * 1024 / row_size;
 
-	/*
-	 * For base relations and OUTER joins, add a WHERE clause if there is one.
-	 *
-	 * For an INNER join, all conditions that are pushed down get added
-	 * to fdwState->joinclauses and have already been added above,
-	 * so there is no extra WHERE clause.
-	 */
-	if (fdwState->where_clause)
-		appendStringInfo(&query, "%s", fdwState->where_clause);
+	if (rows < 1)
+		rows = 1;
+	if (rows > MAXIMUM_FETCH_ROWS)
+		rows = MAXIMUM_FETCH_ROWS;
 
-	/* append ORDER BY clause if all its expressions can be pushed down */
-	if (fdwState->order_clause)
-		appendStringInfo(&query, " ORDER BY%s", fdwState->order_clause);
+	elog(DEBUG2, "oracle_fdw: fetch at most %u rows of %lu bytes", (unsigned int)rows, (unsigned long)row_size);
 
-	/* append FOR UPDATE if if the scan is for a modification */
-	if (for_update)
-		appendStringInfo(&query, " FOR UPDATE");
+	return (unsigned int)rows;
+}
 
-	/* get a copy of the where clause without single quoted string literals */
-	wherecopy = pstrdup(query.data);
-	for (p=wherecopy; *p!='\0'; ++p)
-	{
-		if (*p == '\'')
-			in_quote = ! in_quote;
-		if (in_quote)
-			*p = ' ';
-	}
+/*
+ * canPipelineFetch
+ * 		A pipelined fetch needs more than one row per batch, and it
+ * 		cannot be used for LOB and geometry columns, because these
+ * 		require round trips to the server while the rows are processed.
+ */
+bool
+canPipelineFetch(struct OracleFdwState *fdw_state)
+{
+	int i;
 
-	/* remove all parameters that do not actually occur in the query */
-	index = 0;
-	foreach(cell, fdwState->params)
-	{
-		++index;
-		snprintf(parname, 10, ":p%.5d", index);
-		if (strstr(wherecopy, parname) == NULL)
-		{
-			/* set the element to NULL to indicate it's gone */
-			lfirst(cell) = NULL;
-		}
-	}
+	if (fdw_state->prefetch < 2)
+		return false;
 
-	pfree(wherecopy);
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	{
+		struct oraColumn *col = fdw_state->oraTable->cols[i];
 
-	/*
-	 * Calculate a hash of the query string so far.
-	 * This is needed to find the query in Oracle's library cache for EXPLAIN.
-	 */
-	queryhash = hash_bytes_extended((unsigned char *)query.data, strlen(query.data), 0);
-	snprintf(hash_str, 17, "%08lx", queryhash);
+		if (!col->used)
+			continue;
 
-	/* add comment with hash to query */
-	initStringInfo(&result);
-	appendStringInfo(&result, "SELECT /*%s*/ %s", hash_str, query.data);
-	pfree(query.data);
+		if (col->oratype == ORA_TYPE_BLOB
+				|| col->oratype == ORA_TYPE_BFILE
+				|| col->oratype == ORA_TYPE_CLOB
+				|| col->oratype == ORA_TYPE_NCLOB
+				|| col->oratype == ORA_TYPE_XMLTYPE
+				|| col->oratype == ORA_TYPE_GEOMETRY)
+			return false;
+	}
 
-	return result.data;
+	return true;
 }
 
+#ifdef JOIN_API
 /*
- * deparseFromExprForRel
- * 		Construct FROM clause for given relation.
- * 		The function constructs ... JOIN ... ON ... for join relation. For a base
- * 		relation it just returns the table name.
- * 		All tables get an alias based on the range table index.
+ * addParameterizedPaths
+ * 		Add parameterized paths for join conditions with other relations
+ * 		that can be pushed down to Oracle.  With such a path, the planner
+ * 		can choose a nested loop join that runs the Oracle query once for
+ * 		each outer row, which can use an index on the Oracle table.
+ * 		This considers the conditions in "joininfo" as well as those
+ * 		that can be derived from equivalence classes.
  */
-static void
-deparseFromExprForRel(struct OracleFdwState *fdwState, StringInfo buf, RelOptInfo *foreignrel, List **params_list)
+void
+addParameterizedPaths(PlannerInfo *root, RelOptInfo *baserel, struct OracleFdwState *fdwState)
 {
-#ifdef JOIN_API
-	if (IS_SIMPLE_REL(foreignrel))
+	List *ppi_list = NIL;
+	ListCell *cell;
+
+	/* examine the join conditions that are not part of an equivalence class */
+	foreach(cell, baserel->joininfo)
 	{
-#endif  /* JOIN_API */
-		appendStringInfo(buf, "%s", fdwState->oraTable->name);
+		RestrictInfo *rinfo = (RestrictInfo *)lfirst(cell);
 
-		appendStringInfo(buf, " %s%d", REL_ALIAS_PREFIX, foreignrel->relid);
-#ifdef JOIN_API
+		addParamPathInfo(root, baserel, fdwState, rinfo, &ppi_list);
 	}
-	else
+
+	/* find equality conditions with columns of the foreign table */
+	if (baserel->has_eclass_joins)
 	{
-		/* join relation */
-		RelOptInfo *rel_o = fdwState->outerrel;
-		RelOptInfo *rel_i = fdwState->innerrel;
-		StringInfoData join_sql_o;
-		StringInfoData join_sql_i;
-		struct OracleFdwState *fdwState_o = (struct OracleFdwState *) rel_o->fdw_private;
-		struct OracleFdwState *fdwState_i = (struct OracleFdwState *) rel_i->fdw_private;
+		struct ecMemberArg arg;
 
-		/* Deparse outer relation */
-		initStringInfo(&join_sql_o);
-		deparseFromExprForRel(fdwState_o, &join_sql_o, rel_o, params_list);
+		arg.already_used = NIL;
+		for (;;)
+		{
+			List *clauses;
+
+			arg.current = NULL;
+			clauses = generate_implied_equalities_for_column(
+							root,
+							baserel,
+							ecMemberMatchesForeign,
+							(void *)&arg,
+							baserel->lateral_referencers
+						);
 
-		/* Deparse inner relation */
-		initStringInfo(&join_sql_i);
-		deparseFromExprForRel(fdwState_i, &join_sql_i, rel_i, params_list);
+			/* done if there are no more columns of the foreign table */
+			if (arg.current == NULL)
+				break;
+
+			foreach(cell, clauses)
+			{
+				RestrictInfo *rinfo = (RestrictInfo *)lfirst(cell);
+
+				addParamPathInfo(root, baserel, fdwState, rinfo, &ppi_list);
+			}
+
+			/* try again, ignoring the column found this time */
+			arg.already_used = lappend(arg.already_used, arg.current);
+		}
+	}
+
+	/* add a path for each combination of outer relations */
+	foreach(cell, ppi_list)
+	{
+		ParamPathInfo *param_info = (ParamPathInfo *)lfirst(cell);
+		double rows = param_info->ppi_rows;
 
 		/*
-		 * For a join relation FROM clause entry is deparsed as
-		 *
-		 * (outer relation) <join type> (inner relation) ON joinclauses
+		 * Each execution costs a round trip, but returns only the rows
+		 * that match the parameters.
 		 */
-		appendStringInfo(buf, "(%s %s JOIN %s ON ",
-						join_sql_o.data,
-						get_jointype_name(fdwState->jointype),
-						join_sql_i.data
+		add_path(baserel,
+			(Path *)create_foreignscan_path(
+						root,
+						baserel,
+						NULL,  /* default pathtarget */
+						rows,
+#if PG_VERSION_NUM >= 180000
+						0,  /* no disabled plan nodes */
+#endif  /* PG_VERSION_NUM */
+						fdwState->startup_cost,
+						fdwState->startup_cost + rows * 10.0,
+						NIL,   /* no pathkeys */
+						param_info->ppi_req_outer,
+						NULL,  /* no extra plan */
+#if PG_VERSION_NUM >= 170000
+						NIL,   /* no fdw_restrictinfo */
+#endif  /* PG_VERSION_NUM */
+						NIL
+				)
 		);
-
-		/* we can only get here if the join is pushed down, so there are join clauses */
-		Assert(fdwState->joinclauses);
-		appendConditions(fdwState->joinclauses, buf, foreignrel, params_list);
-
-		/* End the FROM clause entry. */
-		appendStringInfo(buf, ")");
 	}
-#endif  /* JOIN_API */
 }
 
-#ifdef JOIN_API
 /*
- * appendConditions
- * 		Deparse conditions from the provided list and append them to buf.
- * 		The conditions in the list are assumed to be ANDed.
- * 		This function is used to deparse JOIN ... ON clauses.
+ * ecMemberMatchesForeign
+ * 		Callback for generate_implied_equalities_for_column.
+ * 		Find the first column of the foreign table in an equivalence class
+ * 		that is not in the list of columns that have already been used.
  */
-static void
-appendConditions(List *exprs, StringInfo buf, RelOptInfo *joinrel, List **params_list)
+bool
+ecMemberMatchesForeign(PlannerInfo *root, RelOptInfo *rel, EquivalenceClass *ec, EquivalenceMember *em, void *arg)
 {
-	ListCell *lc;
-	bool is_first = true;
-	char *where;
+	struct ecMemberArg *state = (struct ecMemberArg *)arg;
+	Expr *expr = em->em_expr;
 
-	foreach(lc, exprs)
-	{
-		Expr  *expr = (Expr *) lfirst(lc);
+	/* if we have already found a column, only match that one */
+	if (state->current != NULL)
+		return equal(expr, state->current);
 
-		/* extract clause from RestrictInfo, if required */
-		if (IsA(expr, RestrictInfo))
-		{
-			RestrictInfo *ri = (RestrictInfo *) expr;
-			expr = ri->clause;
-		}
+	/* ignore binary-compatible relabeling */
+	while (expr && IsA(expr, RelabelType))
+		expr = ((RelabelType *)expr)->arg;
 
-		/* connect expressions with AND */
-		if (!is_first)
-			appendStringInfo(buf, " AND ");
+	/* only columns of the foreign table can be used */
+	if (!IsA(expr, Var) || ((Var *)expr)->varno != rel->relid || ((Var *)expr)->varlevelsup != 0)
+		return false;
 
-		/* deparse and append a join condition */
-		where = deparseExpr(NULL, joinrel, expr, NULL, params_list, false);
-		appendStringInfo(buf, "%s", where);
+	if (list_member(state->already_used, em->em_expr))
+		return false;
 
-		is_first = false;
-	}
+	state->current = em->em_expr;
+	return true;
 }
 
 /*
- * foreign_join_ok
- * 		Assess whether the join between inner and outer relations can be pushed down
- * 		to the foreign server.
+ * addParamPathInfo
+ * 		If the join condition can be pushed down to Oracle, add the
+ * 		ParamPathInfo for the outer relations it references to "ppi_list".
  */
-static bool
-foreign_join_ok(PlannerInfo *root, RelOptInfo *joinrel, JoinType jointype,
-								RelOptInfo *outerrel, RelOptInfo *innerrel,
-								JoinPathExtraData *extra)
+void
+addParamPathInfo(PlannerInfo *root, RelOptInfo *baserel, struct OracleFdwState *fdwState, RestrictInfo *rinfo, List **ppi_list)
 {
-	struct OracleFdwState *fdwState;
-	struct OracleFdwState *fdwState_o;
-	struct OracleFdwState *fdwState_i;
+	Relids required_outer;
+	List *params = NIL;
+	char *where;
 
-	ListCell   *lc;
-	List	   *joinclauses;   /* join quals */
-	List	   *otherclauses;  /* pushed-down (other) quals */
+	/* check if the condition can be evaluated at the foreign table */
+	if (!join_clause_is_movable_to(rinfo, baserel))
+		return;
 
-	/* we support pushing down INNER/OUTER joins */
-	if (jointype != JOIN_INNER && jointype != JOIN_LEFT &&
-		jointype != JOIN_RIGHT && jointype != JOIN_FULL)
-		return false;
+	/* check if the condition can be translated for Oracle */
+	where = deparseExpr(fdwState->session, baserel, rinfo->clause, fdwState->oraTable, &params, false);
+	if (where == NULL)
+		return;
+	pfree(where);
 
-	fdwState = (struct OracleFdwState *) joinrel->fdw_private;
-	fdwState_o = (struct OracleFdwState *) outerrel->fdw_private;
-	fdwState_i = (struct OracleFdwState *) innerrel->fdw_private;
+	/* the outer relations needed, without the foreign table itself */
+	required_outer = bms_union(rinfo->clause_relids, baserel->lateral_relids);
+	required_outer = bms_del_member(required_outer, baserel->relid);
+	if (bms_is_empty(required_outer))
+		return;
 
-	if (!fdwState_o || !fdwState_i)
-		return false;
+	/* get_baserel_parampathinfo won't make duplicates */
+	*ppi_list = list_append_unique_ptr(*ppi_list,
+									   get_baserel_parampathinfo(root, baserel, required_outer));
+}
+#endif  /* JOIN_API */
 
-	fdwState->outerrel = outerrel;
-	fdwState->innerrel = innerrel;
-	fdwState->jointype = jointype;
+/*
+ * createScanParams
+ * 		Create the parameter list for the expressions in "fdw_exprs"
+ * 		of a foreign scan and for ":now" if it appears in the query.
+ */
+void
+createScanParams(ForeignScanState *node, struct OracleFdwState *fdw_state)
+{
+	ForeignScan *fsplan = (ForeignScan *)node->ss.ps.plan;
+	List *exec_exprs;
+	ListCell *cell;
+	int index;
+	struct paramDesc *paramDesc;
 
-	/*
-	 * If joining relations have local conditions, those conditions are
-	 * required to be applied before joining the relations. Hence the join can
-	 * not be pushed down.
-	 */
-	if (fdwState_o->local_conds || fdwState_i->local_conds)
-		return false;
+	/* create an ExprState tree for the parameter expressions */
+#if PG_VERSION_NUM < 100000
+	exec_exprs = (List *)ExecInitExpr((Expr *)fsplan->fdw_exprs, (PlanState *)node);
+#else
+	exec_exprs = (List *)ExecInitExprList(fsplan->fdw_exprs, (PlanState *)node);
+#endif  /* PG_VERSION_NUM */
 
-	/* separate restrict list into join quals and pushed-down (other) quals from extra->restrictlist */
-	if (IS_OUTER_JOIN(jointype))
+	/* create the list of parameters */
+	index = 0;
+	foreach(cell, exec_exprs)
 	{
-		extract_actual_join_clauses(extra->restrictlist, joinrel->relids, &joinclauses, &otherclauses);
+		ExprState *expr = (ExprState *)lfirst(cell);
+		char parname[10];
 
-		/* CROSS JOIN (T1 LEFT/RIGHT/FULL JOIN T2 ON true) is not pushed down */
-		if (joinclauses == NIL)
-		{
-			return false;
-		}
+		/* count, but skip deleted entries */
+		++index;
+		if (expr == NULL)
+			continue;
 
-		/* join quals must be safe to push down */
-		foreach(lc, joinclauses)
-		{
-			Expr *expr = (Expr *) lfirst(lc);
+		/* create a new entry in the parameter list */
+		paramDesc = (struct paramDesc *)palloc(sizeof(struct paramDesc));
+		snprintf(parname, 10, ":p%.5d", index);
+		paramDesc->name = pstrdup(parname);
+		paramDesc->type = exprType((Node *)(expr->expr));
 
-			if (!deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false))
-				return false;
-		}
+		if (paramDesc->type == TEXTOID || paramDesc->type == VARCHAROID
+				|| paramDesc->type == BPCHAROID || paramDesc->type == CHAROID
+				|| paramDesc->type == DATEOID || paramDesc->type == TIMESTAMPOID
+				|| paramDesc->type == TIMESTAMPTZOID || paramDesc->type == UUIDOID)
+			paramDesc->bindType = BIND_STRING;
+		else if (isNumberArrayElem(get_element_type(paramDesc->type)))
+			paramDesc->bindType = BIND_NUMBER_ARRAY;
+		else if (isStringArrayElem(get_element_type(paramDesc->type)))
+			paramDesc->bindType = BIND_STRING_ARRAY;
+		else
+			paramDesc->bindType = BIND_NUMBER;
 
-		/* save the join clauses, for later use */
-		fdwState->joinclauses = joinclauses;
-	}
-	else
-	{
-		/*
-		 * Unlike an outer join, for inner join, the join result contains only
-		 * the rows which satisfy join clauses, similar to the other clause.
-		 * Hence all clauses can be treated the same.
-		 *
-		 * Note that all join conditions will become remote_conds and
-		 * eventually joinclauses again.
-		 */
-		otherclauses = extract_actual_clauses(extra->restrictlist, false);
-		joinclauses = NIL;
+		paramDesc->value = NULL;
+		paramDesc->node = expr;
+		paramDesc->bindh = NULL;
+		paramDesc->values = NULL;
+		paramDesc->colnum = -1;
+		paramDesc->next = fdw_state->paramList;
+		fdw_state->paramList = paramDesc;
 	}
 
-	/*
-	 * If there is a PlaceHolderVar that needs to be evaluated at a lower level
-	 * than the complete join relation, it may happen that a reference from
-	 * outside is wrongly evaluated to a non-NULL value.
-	 * This can happen if the reason for the value to be NULL is that it comes from
-	 * the nullable side of an outer join.
-	 * So we don't push down the join in this case - if PostgreSQL performs the join,
-	 * it will evaluate the placeholder correctly.
-	 */
-	foreach(lc, root->placeholder_list)
+	/* add a fake parameter ":now" if that string appears in the query */
+	if (strstr(fdw_state->query, ":now") != NULL)
 	{
-		PlaceHolderInfo *phinfo = lfirst(lc);
-		Relids      relids;
+		paramDesc = (struct paramDesc *)palloc(sizeof(struct paramDesc));
+		paramDesc->name = pstrdup(":now");
+		paramDesc->type = TIMESTAMPTZOID;
+		paramDesc->bindType = BIND_STRING;
+		paramDesc->value = NULL;
+		paramDesc->node = NULL;
+		paramDesc->bindh = NULL;
+		paramDesc->values = NULL;
+		paramDesc->colnum = -1;
+		paramDesc->next = fdw_state->paramList;
+		fdw_state->paramList = paramDesc;
+	}
+}
 
-#if PG_VERSION_NUM < 110000
-		relids = joinrel->relids;
-#else
-		/* PlaceHolderInfo refers to parent relids, not child relids. */
-		relids = IS_OTHER_REL(joinrel) ?
-				joinrel->top_parent_relids : joinrel->relids;
-#endif  /* PG_VERSION_NUM */
+/*
+ * executeForeignScan
+ * 		Get the actual parameter values and run the remote query.
+ * 		With asynchronous execution, this does not wait for the query.
+ * 		For a parallel scan, the slice must have been set with getNextSlice.
+ */
+void
+executeForeignScan(ForeignScanState *node)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+	oraPipeline pipeline = PIPELINE_OFF;
+	char *paramInfo;
+#ifdef PARALLEL_API
+	struct paramDesc *param;
 
-		if (bms_is_subset(phinfo->ph_eval_at, relids) &&
-			bms_nonempty_difference(relids, phinfo->ph_eval_at))
+	/* set the SCN and the slice of a parallel scan */
+	if (fdw_state->parallel_slices > 0)
+		for (param = fdw_state->paramList; param; param = param->next)
 		{
-			return false;
+			if (strcmp(param->name, ":scn") == 0)
+				param->value = fdw_state->pscan->scn;
+			else if (strcmp(param->name, ":slice") == 0)
+				param->value = psprintf("%d", fdw_state->slice);
 		}
-	}
+#endif  /* PARALLEL_API */
 
-	/*
-	 * For inner joins, "otherclauses" contains now the join conditions.
-	 * For outer joins, it means these Restrictinfos were pushed down from other relation.
-	 *
-	 * Check which ones can be pushed down to remote server.
-	 */
-	foreach(lc, otherclauses)
-	{
-		Expr *expr = (Expr *) lfirst(lc);
+	/* fill the parameter list with the actual values */
+	paramInfo = setSelectParameters(fdw_state->paramList, node->ss.ps.ps_ExprContext);
 
-		if (deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false))
-			fdwState->remote_conds = lappend(fdwState->remote_conds, expr);
-		else
-			fdwState->local_conds = lappend(fdwState->local_conds, expr);
-	}
+	/* execute the Oracle statement and fetch the first row */
+	elog(DEBUG1, "oracle_fdw: execute query in foreign table scan %s", paramInfo);
 
-	/*
-	 * Only push down joins for which all join conditions can be pushed down.
-	 *
-	 * For an INNER join it would be ok to only push own some of the join
-	 * conditions and evaluate the others locally, but we cannot be certain
-	 * that such a plan is a good or even a feasible one:
-	 * With one of the join conditions missing in the pushed down query,
-	 * it could be that the "intermediate" join result fetched from the Oracle
-	 * side has many more rows than the complete join result.
-	 *
-	 * We could rely on estimates to see how many rows are returned from such
-	 * a join where not all join conditions can be pushed down, but we choose
-	 * the safe road of not pushing down such joins at all.
-	 */
+	if (fdw_state->async_execution)
+		pipeline = PIPELINE_ASYNC;
+	else if (fdw_state->pipeline_fetch)
+		pipeline = PIPELINE_FETCH;
 
-	if (!IS_OUTER_JOIN(jointype))
-	{
-		/* for an inner join, we use all or nothing approach */
-		if (fdwState->local_conds != NIL)
-			return false;
+	/* the statement stays prepared across rescans */
+	if (!oracleIsStatementOpen(fdw_state->session))
+		oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable,
+			fdw_state->prefetch, fdw_state->lob_prefetch, pipeline);
+	(void)oracleExecuteQuery(fdw_state->session, fdw_state->oraTable,
+		fdw_state->paramList, fdw_state->fetch_size);
 
-		/* CROSS JOIN (T1 JOIN T2 ON true) is not pushed down */
-		if (fdwState->remote_conds == NIL)
-			return false;
-	}
+	fdw_state->executed = true;
+}
 
-	/*
-	 * Pull the other remote conditions from the joining relations into join
-	 * clauses or other remote clauses (remote_conds) of this relation
-	 * wherever possible. This avoids building subqueries at every join step,
-	 * which is not currently supported by the deparser logic.
-	 *
-	 * For an INNER join, clauses from both the relations are added to the
-	 * other remote clauses.
-	 *
-	 * For LEFT and RIGHT OUTER join, the clauses from the outer side are added
-	 * to remote_conds since those can be evaluated after the join is evaluated.
-	 * The clauses from inner side are added to the joinclauses, since they
-	 * need to evaluated while constructing the join.
-	 *
-	 * For a FULL OUTER JOIN, the other clauses from either relation can not
-	 * be added to the joinclauses or remote_conds, since each relation acts
-	 * as an outer relation for the other. Consider such full outer join as
-	 * unshippable because of the reasons mentioned above in this comment.
-	 *
-	 * The joining sides can not have local conditions, thus no need to test
-	 * shippability of the clauses being pulled up.
-	 */
-	switch (jointype)
+#ifdef DIRECT_MODIFY_API
+/*
+ * findModifySubplan
+ * 		Return the foreign scan of the result relation that provides the rows
+ * 		for a ModifyTable, or NULL if the subplan is something else.
+ * 		From v14 on, the subplans of several result relations are in an Append.
+ */
+ForeignScan *
+findModifySubplan(ModifyTable *plan, Index resultRelation, int subplan_index)
+{
+#if PG_VERSION_NUM < 140000
+	Plan *subplan = (Plan *)list_nth(plan->plans, subplan_index);
+#else
+	Plan *subplan = outerPlan(plan);
+
+	/* the Append may be below a Result node */
+	if (IsA(subplan, Result) && outerPlan(subplan) != NULL && IsA(outerPlan(subplan), Append))
+		subplan = outerPlan(subplan);
+
+	if (IsA(subplan, Append))
 	{
-		case JOIN_INNER:
-			fdwState->remote_conds = list_concat(fdwState->remote_conds,
-										  list_copy(fdwState_i->remote_conds));
-			fdwState->remote_conds = list_concat(fdwState->remote_conds,
-										  list_copy(fdwState_o->remote_conds));
-			break;
+		Append *append = (Append *)subplan;
 
-		case JOIN_LEFT:
-			fdwState->joinclauses = list_concat(fdwState->joinclauses,
-										  list_copy(fdwState_i->remote_conds));
-			fdwState->remote_conds = list_concat(fdwState->remote_conds,
-										  list_copy(fdwState_o->remote_conds));
-			break;
+		if (subplan_index >= list_length(append->appendplans))
+			return NULL;
 
-		case JOIN_RIGHT:
-			fdwState->joinclauses = list_concat(fdwState->joinclauses,
-										  list_copy(fdwState_o->remote_conds));
-			fdwState->remote_conds = list_concat(fdwState->remote_conds,
-										  list_copy(fdwState_i->remote_conds));
-			break;
+		subplan = (Plan *)list_nth(append->appendplans, subplan_index);
+	}
+#endif  /* PG_VERSION_NUM */
 
-		case JOIN_FULL:
-			if (fdwState_i->remote_conds || fdwState_o->remote_conds)
-				return false;
+	if (!IsA(subplan, ForeignScan) || ((ForeignScan *)subplan)->scan.scanrelid != resultRelation)
+		return NULL;
 
-			break;
+	return (ForeignScan *)subplan;
+}
+#endif  /* DIRECT_MODIFY_API */
 
-		default:
-			/* Should not happen, we have just checked this above */
-			elog(ERROR, "unsupported join type %d", jointype);
-	}
+#ifdef PARALLEL_API
+/*
+ * getNextSlice
+ * 		Take the next slice of a parallel scan that is not yet scanned.
+ * 		Returns false if there is none left.
+ * 		If the scan runs without parallel workers, there is no shared state,
+ * 		and we scan all slices ourselves.
+ */
+bool
+getNextSlice(struct OracleFdwState *fdw_state)
+{
+	uint32 slice;
 
-	if (IS_OUTER_JOIN(jointype))
+	if (fdw_state->pscan == NULL)
 	{
-		StringInfoData where; /* for outer join's WHERE clause */
-		char *keyword = "WHERE";
+		fdw_state->pscan = (struct OracleParallelScan *)palloc(sizeof(struct OracleParallelScan));
+		oracleGetSCN(fdw_state->session, fdw_state->pscan->scn);
+		pg_atomic_init_u32(&fdw_state->pscan->next_slice, 0);
+		fdw_state->pscan_local = true;
+	}
 
+	slice = pg_atomic_fetch_add_u32(&fdw_state->pscan->next_slice, 1);
+	if (slice >= (uint32)fdw_state->parallel_slices)
+		return false;
+
+	elog(DEBUG2, "oracle_fdw: scan slice %u of %d", slice, fdw_state->parallel_slices);
+
+	fdw_state->slice = (int)slice;
+	return true;
+}
+#endif  /* PARALLEL_API */
+
+#ifdef ASYNC_API
+/*
+ * produceTupleAsync
+ * 		Complete the asynchronous request with the next row if the Oracle
+ * 		query has delivered it, else leave the request pending.
+ * 		If "wait" is true, complete the request in any case, which blocks
+ * 		until the Oracle query is done.
+ * 		The row is produced by ExecProcNode so that quals and projection
+ * 		are applied just like in a synchronous scan.
+ */
+void
+produceTupleAsync(AsyncRequest *areq, bool wait)
+{
+	ForeignScanState *node = (ForeignScanState *)areq->requestee;
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)node->fdw_state;
+
+	if (!fdw_state->async_execution || wait
+			|| oracleFetchReady(fdw_state->session, fdw_state->fetch_size))
+	{
+		ExecAsyncRequestDone(areq, ExecProcNode((PlanState *)node));
+		return;
+	}
+
+	ExecAsyncRequestPending(areq);
+}
+
+/*
+ * createWaitFd
+ * 		Create a file descriptor that is always readable: the reading end
+ * 		of a pipe that contains a byte and whose writing end is closed.
+ * 		It is closed when the executor's memory context goes away.
+ */
+int
+createWaitFd(EState *estate, struct OracleFdwState *fdw_state)
+{
+	MemoryContextCallback *callback;
+	int fds[2];
+
+	if (!AcquireExternalFD())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+				errmsg("cannot execute Oracle query asynchronously"),
+				errdetail("There are too many open files on the local server."),
+				errhint("Raise the server's max_files_per_process and/or \"ulimit -n\" limits.")));
+
+	if (pipe(fds) != 0)
+	{
+		ReleaseExternalFD();
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				errmsg("could not create pipe for asynchronous execution: %m")));
+	}
+
+	if (write(fds[1], "", 1) != 1)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		ReleaseExternalFD();
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				errmsg("could not write to pipe for asynchronous execution: %m")));
+	}
+	close(fds[1]);
+
+	callback = (MemoryContextCallback *)MemoryContextAlloc(estate->es_query_cxt, sizeof(MemoryContextCallback));
+	callback->func = closeWaitFd;
+	callback->arg = (void *)fdw_state;
+	fdw_state->wait_fd = fds[0];
+	MemoryContextRegisterResetCallback(estate->es_query_cxt, callback);
+
+	return fds[0];
+}
+
+/*
+ * closeWaitFd
+ * 		Memory context callback to close the file descriptor
+ * 		created by createWaitFd.
+ */
+void
+closeWaitFd(void *arg)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)arg;
+
+	if (fdw_state->wait_fd >= 0)
+	{
+		close(fdw_state->wait_fd);
+		ReleaseExternalFD();
+		fdw_state->wait_fd = -1;
+	}
+}
+#endif  /* ASYNC_API */
+
+/*
+ * getRemoteEstimate
+ * 		Get the estimated number of rows, the row width and the cost
+ * 		of the query for "foreignrel" from the Oracle optimizer.
+ * 		The estimates are cached for the session, so that only the
+ * 		first planning of a query needs the round trips to Oracle.
+ * 		The cost is converted to PostgreSQL's units.
+ */
+void
+getRemoteEstimate(struct OracleFdwState *fdwState, RelOptInfo *foreignrel, double *rows, int *width, Cost *cost)
+{
+	struct remoteEstimate *entry;
+	struct oraTable *oraTable = fdwState->oraTable;
+	List *params = fdwState->params;
+	StringInfoData key;
+	uint64 hash;
+	char *query;
+
+	/*
+	 * The result columns of a join are only known in oracleGetForeignPlan,
+	 * but they don't matter much for the estimate.
+	 */
+	if (oraTable == NULL)
+	{
+		fdwState->oraTable = (struct oraTable *) palloc0(sizeof(struct oraTable));
+		fdwState->oraTable->name = pstrdup("");
+		fdwState->oraTable->pgname = pstrdup("");
+	}
+
+	/* createQuery modifies the parameter list, work on a copy */
+	fdwState->params = list_copy(params);
+
+	query = createQuery(fdwState, foreignrel, false, NIL);
+
+	fdwState->params = params;
+	fdwState->oraTable = oraTable;
+
+	/* the same query can have different estimates in different databases */
+	initStringInfo(&key);
+	appendStringInfo(&key, "%s\n%s\n%s", fdwState->dbserver, fdwState->user, query);
+	hash = (uint64)hash_bytes_extended((unsigned char *)key.data, key.len, 0);
+	pfree(key.data);
+
+	if (remote_estimates == NULL)
+	{
+		HASHCTL ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(uint64);
+		ctl.entrysize = sizeof(struct remoteEstimate);
+#if PG_VERSION_NUM >= 90500
+		remote_estimates = hash_create("oracle_fdw remote estimates", 64, &ctl, HASH_ELEM | HASH_BLOBS);
+#else
+		ctl.hash = tag_hash;
+		remote_estimates = hash_create("oracle_fdw remote estimates", 64, &ctl, HASH_ELEM | HASH_FUNCTION);
+#endif  /* PG_VERSION_NUM */
+	}
+
+	entry = (struct remoteEstimate *)hash_search(remote_estimates, &hash, HASH_FIND, NULL);
+	if (entry == NULL)
+	{
+		oracleSession *session = fdwState->session;
+		double est_rows, est_cost;
+		int est_width;
+
+		elog(DEBUG2, "oracle_fdw: get remote estimate for query: %s", query);
+
+		/* connect to Oracle unless we have a session */
+		if (session == NULL)
+			session = oracleGetSession(
+				fdwState->dbserver,
+				fdwState->isolation_level,
+				fdwState->user,
+				fdwState->password,
+				fdwState->nls_lang,
+				fdwState->timezone,
+				(int)fdwState->have_nchar,
+				(oraTable == NULL) ? "" : oraTable->pgname,
+				GetCurrentTransactionNestLevel()
+			);
+
+		oracleEstimate(session, query, &est_rows, &est_width, &est_cost);
+
+		/* release Oracle session (will be cached) */
+		if (session != fdwState->session)
+			pfree(session);
+
+		/* only add the entry now, so that errors leave no empty entry behind */
+		entry = (struct remoteEstimate *)hash_search(remote_estimates, &hash, HASH_ENTER, NULL);
+		entry->rows = est_rows;
+		entry->width = est_width;
+		entry->cost = est_cost;
+	}
+
+	pfree(query);
+
+	*rows = entry->rows;
+	*width = entry->width;
+	/* Oracle's cost is measured in single block reads */
+	*cost = entry->cost * random_page_cost;
+}
+
+/*
+ * createQuery
+ * 		Construct a query string for Oracle that
+ * 		a) contains only the necessary columns in the SELECT list
+ * 		b) has all the WHERE and ORDER BY clauses that can safely be translated to Oracle.
+ * 		Untranslatable clauses are omitted and left for PostgreSQL to check.
+ * 		"query_pathkeys" contains the desired sort order of the scan results
+ * 		which will be translated to ORDER BY clauses if possible.
+ *		As a side effect for base relations, we also mark the used columns in oraTable.
+ */
+char
+*createQuery(struct OracleFdwState *fdwState, RelOptInfo *foreignrel, bool for_update, List *query_pathkeys)
+{
+	ListCell *cell;
+	bool in_quote = false;
+	int i, index;
+	char *wherecopy, *p, hash_str[17], parname[10], *separator = "";
+	long queryhash;
+	StringInfoData query, result;
+	List *columnlist,
+		*conditions = foreignrel->baserestrictinfo;
+
+#if PG_VERSION_NUM < 90600
+	columnlist = foreignrel->reltargetlist;
+#else
+	columnlist = foreignrel->reltarget->exprs;
+#endif
+
+#ifdef JOIN_API
+	if (IS_SIMPLE_REL(foreignrel))
+#endif  /* JOIN_API */
+	{
+		/* find all the columns to include in the select list */
+
+		/* examine each SELECT list entry for Var nodes */
+		foreach(cell, columnlist)
+		{
+			getUsedColumns((Expr *)lfirst(cell), fdwState->oraTable, foreignrel->relid);
+		}
+
+		/* examine each condition for Var nodes */
+		foreach(cell, conditions)
+		{
+			getUsedColumns((Expr *)lfirst(cell), fdwState->oraTable, foreignrel->relid);
+		}
+	}
+
+	/* construct SELECT list */
+	initStringInfo(&query);
+	for (i=0; i<fdwState->oraTable->ncols; ++i)
+	{
+		if (fdwState->oraTable->cols[i]->used)
+		{
+			char *format;
+			StringInfoData alias;
+
+			initStringInfo(&alias);
+			/* table alias is created from range table index, expressions have none */
+			if (fdwState->oraTable->cols[i]->varno > 0)
+				ADD_REL_QUALIFIER(&alias, fdwState->oraTable->cols[i]->varno);
+
+			/* format for qualified column name */
+			if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_XMLTYPE)
+				/* convert XML to CLOB in the query */
+				format = "%s(%s%s).getclobval()";
+			else if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_TIMESTAMPLTZ)
+				/* convert TIMESTAMP WITH LOCAL TIME ZONE to TIMESTAMP WITH TIME ZONE */
+				format = "%s(%s%s AT TIME ZONE sessiontimezone)";
+			else if (fdwState->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
+				format = "%sTO_CLOB(%s%s)";
+			else
+				/* select the column as it is */
+				format = "%s%s%s";
+
+			appendStringInfo(&query,
+							 format,
+							 separator,
+							 alias.data,
+							 fdwState->oraTable->cols[i]->name);
+
+			separator = ", ";
+		}
+	}
+
+	/* dummy column if there is no result column we need from Oracle */
+	if (separator[0] == '\0')
+		appendStringInfo(&query, "'1'");
+
+	/* append FROM clause */
+	appendStringInfo(&query, " FROM ");
+	deparseFromExprForRel(fdwState, &query, foreignrel,
+							&(fdwState->params));
+
+	/*
+	 * For base relations and OUTER joins, add a WHERE clause if there is one.
+	 *
+	 * For an INNER join, all conditions that are pushed down get added
+	 * to fdwState->joinclauses and have already been added above,
+	 * so there is no extra WHERE clause.
+	 */
+	if (fdwState->where_clause)
+		appendStringInfo(&query, "%s", fdwState->where_clause);
+
+	/* a parallel scan reads only one slice of the table */
+	if (fdwState->parallel_slices > 0)
+		appendStringInfo(&query, " %s ORA_HASH(%s%d.ROWID, %d) = :slice",
+						 (fdwState->where_clause && fdwState->where_clause[0] != '\0') ? "AND" : "WHERE",
+						 REL_ALIAS_PREFIX, foreignrel->relid, fdwState->parallel_slices - 1);
+
+	/* before Oracle 12c, LIMIT is pushed down as a ROWNUM condition */
+	if (fdwState->limit_clause && fdwState->server_major < 12)
+		appendStringInfo(&query, " %s %s",
+						 (fdwState->where_clause && fdwState->where_clause[0] != '\0') ? "AND" : "WHERE",
+						 fdwState->limit_clause);
+
+	/* append GROUP BY and HAVING clauses for a pushed down aggregation */
+	if (fdwState->group_clause)
+		appendStringInfo(&query, "%s", fdwState->group_clause);
+
+	/* append ORDER BY clause if all its expressions can be pushed down */
+	if (fdwState->order_clause)
+		appendStringInfo(&query, " ORDER BY%s", fdwState->order_clause);
+
+	/* append OFFSET and FETCH NEXT for a pushed down LIMIT */
+	if (fdwState->limit_clause && fdwState->server_major >= 12)
+		appendStringInfo(&query, "%s", fdwState->limit_clause);
+
+	/* append FOR UPDATE if if the scan is for a modification */
+	if (for_update)
+		appendStringInfo(&query, " FOR UPDATE");
+
+	/* get a copy of the where clause without single quoted string literals */
+	wherecopy = pstrdup(query.data);
+	for (p=wherecopy; *p!='\0'; ++p)
+	{
+		if (*p == '\'')
+			in_quote = ! in_quote;
+		if (in_quote)
+			*p = ' ';
+	}
+
+	/* remove all parameters that do not actually occur in the query */
+	index = 0;
+	foreach(cell, fdwState->params)
+	{
+		++index;
+		snprintf(parname, 10, ":p%.5d", index);
+		if (strstr(wherecopy, parname) == NULL)
+		{
+			/* set the element to NULL to indicate it's gone */
+			lfirst(cell) = NULL;
+		}
+	}
+
+	pfree(wherecopy);
+
+	/*
+	 * Calculate a hash of the query string so far.
+	 * This is needed to find the query in Oracle's library cache for EXPLAIN.
+	 */
+	queryhash = hash_bytes_extended((unsigned char *)query.data, strlen(query.data), 0);
+	snprintf(hash_str, 17, "%08lx", queryhash);
+
+	/* add comment with hash to query */
+	initStringInfo(&result);
+	appendStringInfo(&result, "SELECT /*%s*/ %s", hash_str, query.data);
+	pfree(query.data);
+
+	return result.data;
+}
+
+/*
+ * deparseFromExprForRel
+ * 		Construct FROM clause for given relation.
+ * 		The function constructs ... JOIN ... ON ... for join relation. For a base
+ * 		relation it just returns the table name.  Semi- and anti-joins only
+ * 		have the outer relation here, the inner one is in the WHERE clause.
+ * 		All tables get an alias based on the range table index.
+ */
+static void
+deparseFromExprForRel(struct OracleFdwState *fdwState, StringInfo buf, RelOptInfo *foreignrel, List **params_list)
+{
+#ifdef JOIN_API
+	if (IS_SIMPLE_REL(foreignrel))
+	{
+#endif  /* JOIN_API */
+		appendStringInfo(buf, "%s", fdwState->oraTable->name);
+
+		/* all slices of a parallel scan see the same data */
+		if (fdwState->parallel_slices > 0)
+			appendStringInfo(buf, " AS OF SCN :scn");
+
+		appendStringInfo(buf, " %s%d", REL_ALIAS_PREFIX, foreignrel->relid);
+#ifdef JOIN_API
+	}
+#ifdef UPPER_API
+	else if (IS_UPPER_REL(foreignrel))
+	{
+		/* for an aggregation, deparse the relation that is grouped */
+		RelOptInfo *rel_o = fdwState->outerrel;
+
+		deparseFromExprForRel((struct OracleFdwState *) rel_o->fdw_private, buf, rel_o, params_list);
+	}
+#endif  /* UPPER_API */
+	else if (fdwState->jointype == JOIN_SEMI || fdwState->jointype == JOIN_ANTI)
+	{
+		/* the inner relation is in an EXISTS subquery in the WHERE clause */
+		RelOptInfo *rel_o = fdwState->outerrel;
+
+		deparseFromExprForRel((struct OracleFdwState *) rel_o->fdw_private, buf, rel_o, params_list);
+	}
+	else
+	{
+		/* join relation */
+		RelOptInfo *rel_o = fdwState->outerrel;
+		RelOptInfo *rel_i = fdwState->innerrel;
+		StringInfoData join_sql_o;
+		StringInfoData join_sql_i;
+		struct OracleFdwState *fdwState_o = (struct OracleFdwState *) rel_o->fdw_private;
+		struct OracleFdwState *fdwState_i = (struct OracleFdwState *) rel_i->fdw_private;
+
+		/* Deparse outer relation */
+		initStringInfo(&join_sql_o);
+		deparseFromExprForRel(fdwState_o, &join_sql_o, rel_o, params_list);
+
+		/* Deparse inner relation */
+		initStringInfo(&join_sql_i);
+		deparseFromExprForRel(fdwState_i, &join_sql_i, rel_i, params_list);
+
+		/*
+		 * For a join relation FROM clause entry is deparsed as
+		 *
+		 * (outer relation) <join type> (inner relation) ON joinclauses
+		 */
+		appendStringInfo(buf, "(%s %s JOIN %s ON ",
+						join_sql_o.data,
+						get_jointype_name(fdwState->jointype),
+						join_sql_i.data
+		);
+
+		/* we can only get here if the join is pushed down, so there are join clauses */
+		Assert(fdwState->joinclauses);
+		appendConditions(fdwState->joinclauses, buf, foreignrel, params_list);
+
+		/* End the FROM clause entry. */
+		appendStringInfo(buf, ")");
+	}
+#endif  /* JOIN_API */
+}
+
+#ifdef JOIN_API
+/*
+ * appendConditions
+ * 		Deparse conditions from the provided list and append them to buf.
+ * 		The conditions in the list are assumed to be ANDed.
+ * 		This function is used to deparse JOIN ... ON clauses.
+ */
+static void
+appendConditions(List *exprs, StringInfo buf, RelOptInfo *joinrel, List **params_list)
+{
+	ListCell *lc;
+	bool is_first = true;
+	char *where;
+
+	foreach(lc, exprs)
+	{
+		Expr  *expr = (Expr *) lfirst(lc);
+
+		/* extract clause from RestrictInfo, if required */
+		if (IsA(expr, RestrictInfo))
+		{
+			RestrictInfo *ri = (RestrictInfo *) expr;
+			expr = ri->clause;
+		}
+
+		/* connect expressions with AND */
+		if (!is_first)
+			appendStringInfo(buf, " AND ");
+
+		/* deparse and append a join condition */
+		where = deparseExpr(NULL, joinrel, expr, NULL, params_list, false);
+		appendStringInfo(buf, "%s", where);
+
+		is_first = false;
+	}
+}
+
+/*
+ * foreign_join_ok
+ * 		Assess whether the join between inner and outer relations can be pushed down
+ * 		to the foreign server.
+ */
+static bool
+foreign_join_ok(PlannerInfo *root, RelOptInfo *joinrel, JoinType jointype,
+								RelOptInfo *outerrel, RelOptInfo *innerrel,
+								JoinPathExtraData *extra)
+{
+	struct OracleFdwState *fdwState;
+	struct OracleFdwState *fdwState_o;
+	struct OracleFdwState *fdwState_i;
+
+	ListCell   *lc;
+	List	   *joinclauses;   /* join quals */
+	List	   *otherclauses;  /* pushed-down (other) quals */
+
+	/* we support pushing down INNER/OUTER joins and semi- and anti-joins */
+	if (jointype != JOIN_INNER && jointype != JOIN_LEFT &&
+		jointype != JOIN_RIGHT && jointype != JOIN_FULL &&
+		jointype != JOIN_SEMI && jointype != JOIN_ANTI)
+		return false;
+
+	fdwState = (struct OracleFdwState *) joinrel->fdw_private;
+	fdwState_o = (struct OracleFdwState *) outerrel->fdw_private;
+	fdwState_i = (struct OracleFdwState *) innerrel->fdw_private;
+
+	if (!fdwState_o || !fdwState_i)
+		return false;
+
+	/* a joining side that is a join must have been pushed down completely */
+	if ((!IS_SIMPLE_REL(outerrel) && !fdwState_o->pushdown_safe)
+		|| (!IS_SIMPLE_REL(innerrel) && !fdwState_i->pushdown_safe))
+		return false;
+
+	/* the EXISTS subquery of a semi- or anti-join is only in its WHERE clause */
+	if (fdwState_o->jointype == JOIN_SEMI || fdwState_o->jointype == JOIN_ANTI
+		|| fdwState_i->jointype == JOIN_SEMI || fdwState_i->jointype == JOIN_ANTI)
+		return false;
+
+	fdwState->outerrel = outerrel;
+	fdwState->innerrel = innerrel;
+	fdwState->jointype = jointype;
+
+	/*
+	 * If joining relations have local conditions, those conditions are
+	 * required to be applied before joining the relations. Hence the join can
+	 * not be pushed down.
+	 */
+	if (fdwState_o->local_conds || fdwState_i->local_conds)
+		return false;
+
+	/* separate restrict list into join quals and pushed-down (other) quals from extra->restrictlist */
+	if (IS_OUTER_JOIN(jointype))
+	{
+		extract_actual_join_clauses(extra->restrictlist, joinrel->relids, &joinclauses, &otherclauses);
+
+		/* CROSS JOIN (T1 LEFT/RIGHT/FULL JOIN T2 ON true) is not pushed down */
+		if (joinclauses == NIL)
+		{
+			return false;
+		}
+
+		/* join quals must be safe to push down */
+		foreach(lc, joinclauses)
+		{
+			Expr *expr = (Expr *) lfirst(lc);
+
+			if (!deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false))
+				return false;
+		}
+
+		/* save the join clauses, for later use */
+		fdwState->joinclauses = joinclauses;
+
+		/*
+		 * A LEFT JOIN with "IS NULL" conditions on the inner relation can
+		 * become an anti-join that keeps these conditions, but the inner
+		 * relation is not visible outside the NOT EXISTS subquery.
+		 */
+		if (jointype == JOIN_ANTI)
+		{
+			foreach(lc, pull_var_clause((Node *) otherclauses, PVC_RECURSE_PLACEHOLDERS))
+			{
+				Var *var = (Var *) lfirst(lc);
+
+				if (bms_is_member(var->varno, innerrel->relids))
+					return false;
+			}
+		}
+	}
+	else
+	{
+		/*
+		 * Unlike an outer join, for inner join, the join result contains only
+		 * the rows which satisfy join clauses, similar to the other clause.
+		 * Hence all clauses can be treated the same.
+		 *
+		 * Note that all join conditions will become remote_conds and
+		 * eventually joinclauses again.
+		 */
+		otherclauses = extract_actual_clauses(extra->restrictlist, false);
+		joinclauses = NIL;
+	}
+
+	/*
+	 * If there is a PlaceHolderVar that needs to be evaluated at a lower level
+	 * than the complete join relation, it may happen that a reference from
+	 * outside is wrongly evaluated to a non-NULL value.
+	 * This can happen if the reason for the value to be NULL is that it comes from
+	 * the nullable side of an outer join.
+	 * So we don't push down the join in this case - if PostgreSQL performs the join,
+	 * it will evaluate the placeholder correctly.
+	 */
+	foreach(lc, root->placeholder_list)
+	{
+		PlaceHolderInfo *phinfo = lfirst(lc);
+		Relids      relids;
+
+#if PG_VERSION_NUM < 110000
+		relids = joinrel->relids;
+#else
+		/* PlaceHolderInfo refers to parent relids, not child relids. */
+		relids = IS_OTHER_REL(joinrel) ?
+				joinrel->top_parent_relids : joinrel->relids;
+#endif  /* PG_VERSION_NUM */
+
+		if (bms_is_subset(phinfo->ph_eval_at, relids) &&
+			bms_nonempty_difference(relids, phinfo->ph_eval_at))
+		{
+			return false;
+		}
+	}
+
+	/*
+	 * For inner joins, "otherclauses" contains now the join conditions.
+	 * For outer joins, it means these Restrictinfos were pushed down from other relation.
+	 *
+	 * Check which ones can be pushed down to remote server.
+	 */
+	foreach(lc, otherclauses)
+	{
+		Expr *expr = (Expr *) lfirst(lc);
+
+		if (deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false))
+			fdwState->remote_conds = lappend(fdwState->remote_conds, expr);
+		else
+			fdwState->local_conds = lappend(fdwState->local_conds, expr);
+	}
+
+	/*
+	 * Only push down joins for which all join conditions can be pushed down.
+	 *
+	 * For an INNER join it would be ok to only push own some of the join
+	 * conditions and evaluate the others locally, but we cannot be certain
+	 * that such a plan is a good or even a feasible one:
+	 * With one of the join conditions missing in the pushed down query,
+	 * it could be that the "intermediate" join result fetched from the Oracle
+	 * side has many more rows than the complete join result.
+	 *
+	 * We could rely on estimates to see how many rows are returned from such
+	 * a join where not all join conditions can be pushed down, but we choose
+	 * the safe road of not pushing down such joins at all.
+	 */
+
+	if (!IS_OUTER_JOIN(jointype))
+	{
+		/* for an inner join or a semi-join, we use all or nothing approach */
+		if (fdwState->local_conds != NIL)
+			return false;
+
+		/* CROSS JOIN (T1 JOIN T2 ON true) is not pushed down */
+		if (fdwState->remote_conds == NIL)
+			return false;
+	}
+
+	/*
+	 * Pull the other remote conditions from the joining relations into join
+	 * clauses or other remote clauses (remote_conds) of this relation
+	 * wherever possible. This avoids building subqueries at every join step,
+	 * which is not currently supported by the deparser logic.
+	 *
+	 * For an INNER join, clauses from both the relations are added to the
+	 * other remote clauses.
+	 *
+	 * For LEFT and RIGHT OUTER join, the clauses from the outer side are added
+	 * to remote_conds since those can be evaluated after the join is evaluated.
+	 * The clauses from inner side are added to the joinclauses, since they
+	 * need to evaluated while constructing the join.
+	 *
+	 * For a FULL OUTER JOIN, the other clauses from either relation can not
+	 * be added to the joinclauses or remote_conds, since each relation acts
+	 * as an outer relation for the other. Consider such full outer join as
+	 * unshippable because of the reasons mentioned above in this comment.
+	 *
+	 * The joining sides can not have local conditions, thus no need to test
+	 * shippability of the clauses being pulled up.
+	 */
+	switch (jointype)
+	{
+		case JOIN_INNER:
+			fdwState->remote_conds = list_concat(fdwState->remote_conds,
+										  list_copy(fdwState_i->remote_conds));
+			fdwState->remote_conds = list_concat(fdwState->remote_conds,
+										  list_copy(fdwState_o->remote_conds));
+			break;
+
+		case JOIN_LEFT:
+			fdwState->joinclauses = list_concat(fdwState->joinclauses,
+										  list_copy(fdwState_i->remote_conds));
+			fdwState->remote_conds = list_concat(fdwState->remote_conds,
+										  list_copy(fdwState_o->remote_conds));
+			break;
+
+		case JOIN_RIGHT:
+			fdwState->joinclauses = list_concat(fdwState->joinclauses,
+										  list_copy(fdwState_o->remote_conds));
+			fdwState->remote_conds = list_concat(fdwState->remote_conds,
+										  list_copy(fdwState_i->remote_conds));
+			break;
+
+		case JOIN_FULL:
+			if (fdwState_i->remote_conds || fdwState_o->remote_conds)
+				return false;
+
+			break;
+
+		case JOIN_SEMI:
+			/* all conditions of a semi-join belong in the EXISTS subquery */
+			fdwState->joinclauses = fdwState->remote_conds;
+			fdwState->remote_conds = NIL;
+			/* FALLTHROUGH */
+
+		case JOIN_ANTI:
+			/*
+			 * The inner relation becomes a correlated subquery, so its
+			 * clauses go there, while those of the outer relation stay
+			 * in the WHERE clause of the query.
+			 */
+			fdwState->joinclauses = list_concat(fdwState->joinclauses,
+										  list_copy(fdwState_i->remote_conds));
+			fdwState->remote_conds = list_concat(fdwState->remote_conds,
+										  list_copy(fdwState_o->remote_conds));
+			break;
+
+		default:
+			/* Should not happen, we have just checked this above */
+			elog(ERROR, "unsupported join type %d", jointype);
+	}
+
+	if (jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+	{
+		StringInfoData where;
+		char *keyword = "WHERE";
+
+		/*
+		 * The FROM clause only has the outer relation, and the inner relation
+		 * is checked with [NOT] EXISTS in the WHERE clause, which is used
+		 * in createQuery.
+		 */
+		initStringInfo(&where);
+		foreach(lc, fdwState->remote_conds)
+		{
+			char *tmp = NULL;
+			Expr *expr = (Expr *) lfirst(lc);
+
+			tmp = deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false);
+			Assert(tmp);
+			appendStringInfo(&where, " %s %s", keyword, tmp);
+			keyword = "AND";
+		}
+
+		appendStringInfo(&where, " %s %sEXISTS (SELECT 1 FROM ",
+						 keyword, (jointype == JOIN_ANTI) ? "NOT " : "");
+		deparseFromExprForRel(fdwState_i, &where, innerrel, &(fdwState->params));
+		appendStringInfo(&where, " WHERE ");
+		appendConditions(fdwState->joinclauses, &where, joinrel, &(fdwState->params));
+		appendStringInfo(&where, ")");
+
+		fdwState->where_clause = where.data;
+	}
+	else if (IS_OUTER_JOIN(jointype))
+	{
+		StringInfoData where; /* for outer join's WHERE clause */
+		char *keyword = "WHERE";
+
+		/*
+		 * For outer join, deparse remote_conds and store it in fdwState->where_clause.
+		 * It will be used in createQuery.
+		 */
+		initStringInfo(&where);
+		if (fdwState->remote_conds != NIL)
+		{
+			foreach(lc, fdwState->remote_conds)
+			{
+				char *tmp = NULL;
+				Expr *expr = (Expr *) lfirst(lc);
+
+				tmp = deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false);
+				Assert(tmp);
+				appendStringInfo(&where, " %s %s", keyword, tmp);
+				keyword = "AND";
+			}
+			fdwState->where_clause = where.data;
+		}
+	}
+	else
+	{
+		/* for an inner join, remote_conds has all join conditions */
+		Assert(!fdwState->joinclauses);
+		fdwState->joinclauses = fdwState->remote_conds;
+		fdwState->remote_conds = NIL;
+	}
+
+	/* set fetch size to minimum of the joining sides */
+	if (fdwState_o->prefetch < fdwState_i->prefetch)
+		fdwState->prefetch = fdwState_o->prefetch;
+	else
+		fdwState->prefetch = fdwState_i->prefetch;
+
+	/* use a memory budget only if both sides have one, and take the smaller one */
+	if (fdwState_o->fetch_memory == 0 || fdwState_i->fetch_memory == 0)
+		fdwState->fetch_memory = 0;
+	else if (fdwState_o->fetch_memory < fdwState_i->fetch_memory)
+		fdwState->fetch_memory = fdwState_o->fetch_memory;
+	else
+		fdwState->fetch_memory = fdwState_i->fetch_memory;
+
+	/* pipeline the fetch and execute asynchronously only if both sides want it */
+	fdwState->pipeline_fetch = fdwState_o->pipeline_fetch && fdwState_i->pipeline_fetch;
+	fdwState->async_capable = fdwState_o->async_capable && fdwState_i->async_capable;
+	fdwState->use_remote_estimate = fdwState_o->use_remote_estimate && fdwState_i->use_remote_estimate;
+
+	/* set LOB prefetch size to maximum of the joining sides */
+	if (fdwState_o->lob_prefetch < fdwState_i->lob_prefetch)
+		fdwState->lob_prefetch = fdwState_i->lob_prefetch;
+	else
+		fdwState->lob_prefetch = fdwState_o->lob_prefetch;
+
+	/* copy outerrel's infomation to fdwstate */
+	fdwState->dbserver = fdwState_o->dbserver;
+	fdwState->isolation_level = fdwState_o->isolation_level;
+	fdwState->user     = fdwState_o->user;
+	fdwState->password = fdwState_o->password;
+	fdwState->nls_lang = fdwState_o->nls_lang;
+	fdwState->timezone = fdwState_o->timezone;
+	fdwState->have_nchar = fdwState_o->have_nchar;
+	fdwState->server_major = fdwState_o->server_major;
+
+	foreach(lc, pull_var_clause((Node *)joinrel->reltarget->exprs, PVC_RECURSE_PLACEHOLDERS))
+	{
+		Var *var = (Var *) lfirst(lc);
+
+		Assert(IsA(var, Var));
+
+		/*
+		 * System columns are not pushed down.  Whole-row references are
+		 * formed from all columns of the table (see build_join_oratable).
+		 */
+		if (var->varattno < 0)
+			return false;
+
+		/* whole-row references need the ROWID, which a query may not have */
+		if (var->varattno == 0)
+		{
+			struct oraTable *var_table = getBaseOraTable(outerrel, var->varno);
+
+			if (var_table == NULL)
+				var_table = getBaseOraTable(innerrel, var->varno);
+			if (var_table == NULL || var_table->name[0] == '(')
+				return false;
+		}
+
+		/* the inner relation of a semi- or anti-join is not in the FROM clause */
+		if ((jointype == JOIN_SEMI || jointype == JOIN_ANTI)
+			&& bms_is_member(var->varno, innerrel->relids))
+			return false;
+	}
+
+	return true;
+}
+
+/* Output join name for given join type */
+const char *
+get_jointype_name(JoinType jointype)
+{
+	switch (jointype)
+	{
+		case JOIN_INNER:
+			return "INNER";
+
+		case JOIN_LEFT:
+			return "LEFT";
+
+		case JOIN_RIGHT:
+			return "RIGHT";
+
+		case JOIN_FULL:
+			return "FULL";
+
+		default:
+			/* Shouldn't come here, but protect from buggy code. */
+			elog(ERROR, "unsupported join type %d", jointype);
+	}
+
+	/* Keep compiler happy */
+	return NULL;
+}
+
+/*
+ * Build the targetlist for given relation to be deparsed as SELECT clause.
+ *
+ * The output targetlist contains the columns that need to be fetched from the
+ * foreign server for the given relation.
+ */
+List *
+build_tlist_to_deparse(RelOptInfo *foreignrel)
+{
+	List *tlist = NIL;
+	struct OracleFdwState *fdwState = (struct OracleFdwState *)foreignrel->fdw_private;
+
+	/*
+	 * We require columns specified in foreignrel->reltarget->exprs and those
+	 * required for evaluating the local conditions.
+	 */
+	tlist = add_to_flat_tlist(tlist,
+							  pull_var_clause((Node *) foreignrel->reltarget->exprs,
+											  PVC_RECURSE_PLACEHOLDERS));
+	tlist = add_to_flat_tlist(tlist,
+							  pull_var_clause((Node *) fdwState->local_conds,
+											  PVC_RECURSE_PLACEHOLDERS));
+
+	return tlist;
+}
+
+/*
+ * Fill fdwState->oraTable with a table constructed from the
+ * inner and outer tables using the target list in "fdw_scan_tlist".
+ * A whole-row reference becomes an unused column with the row type,
+ * and all columns of its table and a marker for the ROWID are appended
+ * after the result columns, so that convertTuple can form the row value
+ * from them.
+ */
+struct oraTable *
+build_join_oratable(struct OracleFdwState *fdwState, List *fdw_scan_tlist)
+{
+	struct oraTable	*oraTable;
+	List			*targetvars;	/* pulled Vars from targetlist */
+	List			*wholerows = NIL;	/* whole-row references */
+	ListCell		*lc;
+
+	/* get only Vars because there is not only Vars but also PlaceHolderVars in below exprs */
+	targetvars = pull_var_clause((Node *)fdw_scan_tlist, PVC_RECURSE_PLACEHOLDERS);
+
+	oraTable = (struct oraTable *) palloc0(sizeof(struct oraTable));
+	oraTable->name = pstrdup("");
+	oraTable->pgname = pstrdup("");
+	oraTable->ncols = 0;
+	oraTable->npgcols = 0;
+	oraTable->cols = (struct oraColumn **) palloc0(sizeof(struct oraColumn*) *
+												(list_length(targetvars) + 1));
+
+	foreach(lc, targetvars)
+	{
+		Var *var = (Var *) lfirst(lc);
+		struct oraColumn *newcol;
+
+		Assert(IsA(var, Var));
+
+		if (var->varattno == 0)
+		{
+			/* whole-row reference, the columns are added below */
+			newcol = (struct oraColumn*) palloc0(sizeof(struct oraColumn));
+			newcol->pgtype = var->vartype;
+			newcol->pgtypmod = -1;
+			newcol->varno = var->varno;
+			newcol->used = 0;
+			newcol->pgattnum = oraTable->ncols + 1;
+
+			wholerows = lappend(wholerows, var);
+		}
+		else
+			newcol = build_join_column(fdwState, var->varno, var->varattno, oraTable->ncols + 1);
+
+		oraTable->cols[oraTable->ncols++] = newcol;
+	}
+
+	oraTable->npgcols = oraTable->ncols;
+
+	/* add the columns for the whole-row references, in the same order */
+	foreach(lc, wholerows)
+	{
+		Var *var = (Var *) lfirst(lc);
+		TupleDesc tupdesc = lookup_rowtype_tupdesc(var->vartype, -1);
+		struct oraColumn *marker;
+		int k;
+
+		oraTable->cols = (struct oraColumn **) repalloc(oraTable->cols,
+									sizeof(struct oraColumn*) * (oraTable->ncols + tupdesc->natts + 2));
+
+		for (k=0; k<tupdesc->natts; ++k)
+		{
+			if (TupleDescAttr(tupdesc, k)->attisdropped)
+				continue;
+
+			oraTable->cols[oraTable->ncols] = build_join_column(fdwState, var->varno, k + 1, oraTable->ncols + 1);
+			++oraTable->ncols;
+		}
+
+		ReleaseTupleDesc(tupdesc);
+
+		/*
+		 * Add a marker that is NULL only if the table contributed no row,
+		 * so that a row with only NULL values can be told from the missing
+		 * row of the nullable side of an outer join.
+		 */
+		marker = (struct oraColumn *) palloc0(sizeof(struct oraColumn));
+		marker->name = psprintf("NVL2(%s%d.ROWID, 1, NULL)", REL_ALIAS_PREFIX, var->varno);
+		marker->pgname = marker->name;
+		/* no table alias for expressions */
+		marker->varno = 0;
+		marker->oratype = ORA_TYPE_NUMBER;
+		marker->val_size = 140;
+		marker->pgattnum = oraTable->ncols + 1;
+		marker->pgtype = INT4OID;
+		marker->pgtypmod = -1;
+		marker->used = 1;
+		setFetchType(marker);
+
+		oraTable->cols[oraTable->ncols++] = marker;
+	}
+
+	return oraTable;
+}
+
+/*
+ * build_join_column
+ * 		Create the oraColumn for column "attnum" of relation "varno" in a join.
+ * 		The column is searched in the oraTable of the base relation,
+ * 		which can be anywhere in the join tree.
+ * 		"pgattnum" is the position in the SELECT list of the join query.
+ */
+static struct oraColumn *
+build_join_column(struct OracleFdwState *fdwState, Index varno, AttrNumber attnum, int pgattnum)
+{
+	struct oraTable *var_table;
+	struct oraColumn *col = NULL;
+	struct oraColumn *newcol;
+	int i;
+
+	/* find the base relation that the column belongs to */
+	var_table = getBaseOraTable(fdwState->outerrel, varno);
+	if (var_table == NULL)
+		var_table = getBaseOraTable(fdwState->innerrel, varno);
+
+	/* find appropriate entry in its oraTable */
+	for (i=0; var_table != NULL && i<var_table->ncols; ++i)
+	{
+		if (var_table->cols[i]->pgattnum == attnum)
+		{
+			col = var_table->cols[i];
+			break;
+		}
+	}
+
+	newcol = (struct oraColumn*) palloc0(sizeof(struct oraColumn));
+	if (col)
+	{
+		memcpy(newcol, col, sizeof(struct oraColumn));
+		newcol->used = 1;
+	}
+	else
+	{
+		/* non-existing column, print a warning */
+		ereport(WARNING,
+				(errcode(ERRCODE_WARNING),
+				errmsg("column number %d of foreign table \"%s\" does not exist in foreign Oracle table, will be replaced by NULL",
+					   attnum, (var_table == NULL) ? "?" : var_table->pgname)));
+		newcol->used = 0;
+	}
+
+	newcol->pgattnum = pgattnum;
+
+	return newcol;
+}
+
+/*
+ * getBaseOraTable
+ * 		Return the oraTable of the base relation with range table index "varno"
+ * 		if that relation is "rel" or part of the pushed down join "rel".
+ * 		Returns NULL if the relation is not found.
+ */
+static struct oraTable *
+getBaseOraTable(RelOptInfo *rel, Index varno)
+{
+	struct OracleFdwState *fdwState = (struct OracleFdwState *) rel->fdw_private;
+	struct oraTable *result;
+
+	if (IS_SIMPLE_REL(rel))
+		return (rel->relid == varno) ? fdwState->oraTable : NULL;
+
+	/* upper relations have no relids, so they are skipped here */
+	if (!bms_is_member(varno, rel->relids))
+		return NULL;
+
+	/* the join relations below have no oraTable, search their base relations */
+	result = getBaseOraTable(fdwState->outerrel, varno);
+	if (result == NULL)
+		result = getBaseOraTable(fdwState->innerrel, varno);
+
+	return result;
+}
+#endif  /* JOIN_API */
+
+#ifdef UPPER_API
+/*
+ * foreign_grouping_ok
+ * 		Assess whether the aggregation on "input_rel" can be pushed down
+ * 		to the foreign server.  If yes, build the target list that will be
+ * 		fetched from Oracle, the corresponding oraTable and the GROUP BY
+ * 		and HAVING clauses.
+ */
+static bool
+foreign_grouping_ok(PlannerInfo *root, RelOptInfo *grouped_rel, RelOptInfo *input_rel,
+					PathTarget *grouping_target, List *havingQual)
+{
+	struct OracleFdwState *fdwState = (struct OracleFdwState *) grouped_rel->fdw_private;
+	struct OracleFdwState *fdwState_i = (struct OracleFdwState *) input_rel->fdw_private;
+	List *tlist = NIL;
+	ListCell *lc;
+	StringInfoData group_clause;
+	char *keyword, *deparsed;
+	int i;
+
+	fdwState->outerrel = input_rel;
+
+	/* parameters in the WHERE clause of the input relation keep their numbers */
+	fdwState->params = list_copy(fdwState_i->params);
+	fdwState->where_clause = fdwState_i->where_clause;
+
+	initStringInfo(&group_clause);
+	keyword = " GROUP BY";
+
+	/*
+	 * All grouping expressions must be pushed down.  Other target list entries
+	 * are pushed down as a whole if possible, otherwise the aggregates they
+	 * contain are pushed down and the rest is evaluated locally.
+	 */
+	i = 0;
+	foreach(lc, grouping_target->exprs)
+	{
+		Expr *expr = (Expr *) lfirst(lc);
+		Index sgref = get_pathtarget_sortgroupref(grouping_target, i);
+
+		++i;
+
+		if (sgref && get_sortgroupref_clause_noerr(sgref, root->parse->groupClause))
+		{
+			List *expr_params = NIL;
+			TargetEntry *tle;
+
+			/*
+			 * Oracle recognizes grouping expressions in the SELECT list only if
+			 * they are identical, which is not the case if they contain bind
+			 * variables.  So grouping expressions must not contain parameters.
+			 */
+			deparsed = deparseGroupingValue(input_rel, expr, &expr_params);
+			if (deparsed == NULL || expr_params != NIL || strstr(deparsed, ":now") != NULL
+					|| build_grouping_column(input_rel, expr, deparsed, 0) == NULL)
+				return false;
+
+			appendStringInfo(&group_clause, "%s %s", keyword, deparsed);
+			keyword = ",";
+
+			/*
+			 * Don't use add_to_flat_tlist, because duplicate grouping expressions
+			 * with different sort group references must stay in the list.
+			 */
+			tle = makeTargetEntry(expr, list_length(tlist) + 1, NULL, false);
+			tle->ressortgroupref = sgref;
+			tlist = lappend(tlist, tle);
+		}
+		else
+		{
+			List *aggvars;
+			ListCell *cell;
+
+			deparsed = deparseGroupingValue(input_rel, expr, &(fdwState->params));
+			if (deparsed != NULL && build_grouping_column(input_rel, expr, deparsed, 0) != NULL)
+			{
+				tlist = add_to_flat_tlist(tlist, list_make1(expr));
+				continue;
+			}
+
+			/* the aggregates must be pushed down, Vars are only allowed as grouping expressions */
+			aggvars = pull_var_clause((Node *) expr, PVC_INCLUDE_AGGREGATES | PVC_RECURSE_PLACEHOLDERS);
+			foreach(cell, aggvars)
+			{
+				Expr *aggvar = (Expr *) lfirst(cell);
+
+				if (!IsA(aggvar, Aggref))
+					return false;
+
+				deparsed = deparseGroupingValue(input_rel, aggvar, &(fdwState->params));
+				if (deparsed == NULL || build_grouping_column(input_rel, aggvar, deparsed, 0) == NULL)
+					return false;
+			}
+
+			tlist = add_to_flat_tlist(tlist, aggvars);
+		}
+	}
+
+	/*
+	 * Conditions in HAVING that can be translated are pushed down,
+	 * the others are evaluated locally and need their aggregates fetched.
+	 */
+	keyword = " HAVING";
+	foreach(lc, havingQual)
+	{
+		Expr *expr = (Expr *) lfirst(lc);
+		List *aggvars;
+		ListCell *cell;
+
+		deparsed = deparseExpr(NULL, input_rel, expr, fdwState_i->oraTable, &(fdwState->params), false);
+		if (deparsed != NULL)
+		{
+			appendStringInfo(&group_clause, "%s %s", keyword, deparsed);
+			keyword = " AND";
+			continue;
+		}
+
+		fdwState->local_conds = lappend(fdwState->local_conds, expr);
+
+		aggvars = pull_var_clause((Node *) expr, PVC_INCLUDE_AGGREGATES | PVC_RECURSE_PLACEHOLDERS);
+		foreach(cell, aggvars)
+		{
+			Expr *aggvar = (Expr *) lfirst(cell);
+
+			/* a Var must be a grouping expression, which is already in the list */
+			if (!IsA(aggvar, Aggref))
+			{
+				if (!tlist_member((void *) aggvar, tlist))
+					return false;
+				continue;
+			}
+
+			deparsed = deparseGroupingValue(input_rel, aggvar, &(fdwState->params));
+			if (deparsed == NULL || build_grouping_column(input_rel, aggvar, deparsed, 0) == NULL)
+				return false;
+
+			tlist = add_to_flat_tlist(tlist, list_make1(aggvar));
+		}
+	}
+
+	/* construct the oraTable for the result of the aggregation */
+	fdwState->oraTable = (struct oraTable *) palloc0(sizeof(struct oraTable));
+	fdwState->oraTable->name = pstrdup("");
+	fdwState->oraTable->pgname = pstrdup("");
+	fdwState->oraTable->cols = (struct oraColumn **) palloc0(sizeof(struct oraColumn *) * list_length(tlist));
+
+	foreach(lc, tlist)
+	{
+		TargetEntry *tle = (TargetEntry *) lfirst(lc);
+
+		deparsed = deparseGroupingValue(input_rel, tle->expr, &(fdwState->params));
+		fdwState->oraTable->cols[fdwState->oraTable->ncols] =
+			build_grouping_column(input_rel, tle->expr, deparsed, tle->resno);
+		/* pgattnum is the index in the SELECT list of the query */
+		Assert(tle->resno == fdwState->oraTable->ncols + 1);
+		++fdwState->oraTable->ncols;
+	}
+
+	fdwState->oraTable->npgcols = fdwState->oraTable->ncols;
+	fdwState->grouped_tlist = tlist;
+	if (group_clause.len > 0)
+		fdwState->group_clause = group_clause.data;
+
+	/* copy the information from the input relation */
+	fdwState->dbserver = fdwState_i->dbserver;
+	fdwState->isolation_level = fdwState_i->isolation_level;
+	fdwState->user     = fdwState_i->user;
+	fdwState->password = fdwState_i->password;
+	fdwState->nls_lang = fdwState_i->nls_lang;
+	fdwState->timezone = fdwState_i->timezone;
+	fdwState->have_nchar = fdwState_i->have_nchar;
+	fdwState->server_major = fdwState_i->server_major;
+	fdwState->prefetch = fdwState_i->prefetch;
+	fdwState->lob_prefetch = fdwState_i->lob_prefetch;
+	fdwState->fetch_memory = fdwState_i->fetch_memory;
+	fdwState->pipeline_fetch = fdwState_i->pipeline_fetch;
+	fdwState->async_capable = fdwState_i->async_capable;
+	fdwState->use_remote_estimate = fdwState_i->use_remote_estimate;
+
+	return true;
+}
+
+/*
+ * deparseGroupingValue
+ * 		Deparse an expression for the SELECT list or the GROUP BY clause.
+ * 		Oracle has no boolean values, so conditions are turned into numbers.
+ */
+static char *
+deparseGroupingValue(RelOptInfo *input_rel, Expr *expr, List **params)
+{
+	struct OracleFdwState *fdwState_i = (struct OracleFdwState *) input_rel->fdw_private;
+	StringInfoData result;
+	char *deparsed;
+
+	deparsed = deparseExpr(NULL, input_rel, expr, fdwState_i->oraTable, params, false);
+	if (deparsed == NULL || exprType((Node *) expr) != BOOLOID)
+		return deparsed;
+
+	initStringInfo(&result);
+	appendStringInfo(&result, "CASE WHEN %s THEN 1 WHEN NOT %s THEN 0 END", deparsed, deparsed);
+
+	return result.data;
+}
+
+/*
+ * build_grouping_column
+ * 		Build the oraColumn for an expression fetched by a pushed down aggregation.
+ * 		Returns NULL if the result type of the expression is not supported.
+ * 		Columns of the foreign tables are copied from their oraColumn,
+ * 		other expressions are selected as they are, without table alias.
+ */
+static struct oraColumn *
+build_grouping_column(RelOptInfo *input_rel, Expr *expr, char *deparsed, int pgattnum)
+{
+	struct oraColumn *col;
+	Oid pgtype = exprType((Node *) expr);
+
+	if (IsA(expr, Var) && pgtype != BOOLOID)
+	{
+		Var *var = (Var *) expr;
+		/* for a join, find the table that the column belongs to */
+		struct oraTable *var_table = getBaseOraTable(input_rel, var->varno);
+		int i;
+
+		if (var_table == NULL)
+			return NULL;
+
+		for (i=0; i<var_table->ncols; ++i)
+			if (var_table->cols[i]->varno == var->varno && var_table->cols[i]->pgattnum == var->varattno)
+				break;
+
+		/* columns that don't exist in Oracle are not pushed down */
+		if (i == var_table->ncols)
+			return NULL;
+
+		col = (struct oraColumn *) palloc(sizeof(struct oraColumn));
+		memcpy(col, var_table->cols[i], sizeof(struct oraColumn));
+	}
+	else
+	{
+		col = (struct oraColumn *) palloc0(sizeof(struct oraColumn));
+		col->name = deparsed;
+		col->pgname = deparsed;
+		/* no table alias for expressions */
+		col->varno = 0;
+
+		switch (pgtype)
+		{
+			case BOOLOID:
+			case INT2OID:
+			case INT4OID:
+			case INT8OID:
+			case FLOAT4OID:
+			case FLOAT8OID:
+			case NUMERICOID:
+				col->oratype = ORA_TYPE_NUMBER;
+				/* this should be big enough for unrestricted NUMBERs */
+				col->val_size = 140;
+				break;
+			case DATEOID:
+				col->oratype = ORA_TYPE_DATE;
+				col->val_size = 23;
+				break;
+			case TIMESTAMPOID:
+				col->oratype = ORA_TYPE_TIMESTAMP;
+				col->val_size = 34;
+				break;
+			case TIMESTAMPTZOID:
+				col->oratype = ORA_TYPE_TIMESTAMPTZ;
+				col->val_size = 40;
+				break;
+			default:
+				/* strings and other types have no known length */
+				return NULL;
+		}
+	}
+
+	col->pgattnum = pgattnum;
+	col->pgtype = pgtype;
+	col->pgtypmod = exprTypmod((Node *) expr);
+	col->used = 1;
+	col->pkey = 0;
+
+	/* retrieve numeric values in binary form where possible */
+	setFetchType(col);
+
+	return col;
+}
+
+#if PG_VERSION_NUM >= 120000
+/*
+ * add_foreign_ordered_state
+ * 		Remember in the relation for ORDER BY whether Oracle already sorts
+ * 		the input relation as required.  No path is added, but the final
+ * 		stage needs that information to decide if LIMIT can be pushed down.
+ */
+static void
+add_foreign_ordered_state(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *ordered_rel)
+{
+	struct OracleFdwState *fdwState_i = (struct OracleFdwState *) input_rel->fdw_private;
+	struct OracleFdwState *fdwState;
+
+	fdwState = (struct OracleFdwState *) palloc0(sizeof(struct OracleFdwState));
+	fdwState->outerrel = input_rel;
+
+	/* ORDER BY is only pushed down for base relations (see pushdownOrderBy) */
+	fdwState->pushdown_safe = IS_SIMPLE_REL(input_rel)
+								&& fdwState_i->pushdown_safe
+								&& pathkeys_contained_in(root->sort_pathkeys, fdwState_i->usable_pathkeys);
+
+	ordered_rel->fdw_private = fdwState;
+}
+
+/*
+ * add_foreign_final_paths
+ * 		Add a path that pushes down LIMIT and OFFSET to Oracle if everything
+ * 		else in the query is pushed down.  Oracle 12c and later get
+ * 		"OFFSET ... ROWS FETCH NEXT ... ROWS ONLY", older versions only
+ * 		a ROWNUM condition, which is not possible with ORDER BY, OFFSET
+ * 		or aggregation.
+ * 		The path belongs to the scanned (or grouped) relation, so that
+ * 		oracleGetForeignPlan can plan it like any other path for that relation.
+ */
+static void
+add_foreign_final_paths(PlannerInfo *root, RelOptInfo *input_rel, RelOptInfo *final_rel, FinalPathExtraData *extra)
+{
+	Query *parse = root->parse;
+	struct OracleFdwState *fdwState_i = (struct OracleFdwState *) input_rel->fdw_private;
+	ForeignPath *final_path;
+	List *pathkeys = NIL;
+	int64 offset = 0, count = -1;
+	StringInfoData limit_clause;
+	unsigned int limit_rows = 0;
+	double rows;
+	Cost startup_cost;
+	Cost total_cost;
+
+	/* nothing to do if there is no LIMIT or OFFSET */
+	if (!extra->limit_needed)
+		return;
+
+	/* don't push down LIMIT with FOR SHARE/UPDATE or set-returning functions */
+	if (parse->commandType != CMD_SELECT || parse->rowMarks || parse->hasTargetSRFs)
+		return;
+
+#if PG_VERSION_NUM >= 130000
+	/* FETCH FIRST ... WITH TIES is not supported */
+	if (parse->limitOption == LIMIT_OPTION_WITH_TIES)
+		return;
+#endif  /* PG_VERSION_NUM */
+
+	/* with ORDER BY, the input is the relation for that, and Oracle must sort */
+	if (parse->sortClause != NIL)
+	{
+		if (!fdwState_i->pushdown_safe)
+			return;
+
+		pathkeys = root->sort_pathkeys;
+		input_rel = fdwState_i->outerrel;
+		fdwState_i = (struct OracleFdwState *) input_rel->fdw_private;
+	}
+
+	/* all conditions must be evaluated by Oracle, else the LIMIT would be wrong */
+	if (!fdwState_i->pushdown_safe || fdwState_i->local_conds != NIL)
+		return;
+
+	/* LIMIT and OFFSET must be constants */
+	if (!getLimitValue(parse->limitOffset, &offset) || !getLimitValue(parse->limitCount, &count))
+		return;
+
+	initStringInfo(&limit_clause);
+	if (fdwState_i->server_major >= 12)
+	{
+		if (offset > 0)
+			appendStringInfo(&limit_clause, " OFFSET " INT64_FORMAT " ROWS", offset);
+		if (count >= 0)
+			appendStringInfo(&limit_clause, " FETCH NEXT " INT64_FORMAT " ROWS ONLY", count);
+	}
+	else
+	{
+		/* ROWNUM is assigned before sorting and grouping */
+		if (fdwState_i->order_clause != NULL || IS_UPPER_REL(input_rel) || offset > 0 || count < 0)
+		{
+			elog(DEBUG2, "oracle_fdw: don't push down LIMIT to Oracle server version %d", fdwState_i->server_major);
+			return;
+		}
+
+		appendStringInfo(&limit_clause, "ROWNUM <= " INT64_FORMAT, count);
+	}
+
+	/* there is no need to fetch more rows than the LIMIT */
+	if (count >= 0)
+		limit_rows = (count < 1) ? 1 : ((count > INT_MAX) ? INT_MAX : (unsigned int) count);
+
+	/* estimate the number of returned rows */
+	rows = IS_UPPER_REL(input_rel) ? input_rel->cheapest_total_path->rows : input_rel->rows;
+	rows -= (double) offset;
+	if (count >= 0 && rows > (double) count)
+		rows = (double) count;
+	rows = clamp_row_est(rows);
+
+	/*
+	 * Oracle can stop early and use a top-N sort for ORDER BY,
+	 * and only the rows in the result have to be transferred.
+	 * Make the startup cost lower than for the complete query,
+	 * so that this path wins over a local Limit on the foreign scan.
+	 */
+	startup_cost = fdwState_i->startup_cost * 0.9;
+	total_cost = startup_cost + rows * 10.0;
+
+	/* create a path for the input relation with the LIMIT added */
+	final_path = create_foreign_upper_path(
+									   root,
+									   input_rel,
+									   root->upper_targets[UPPERREL_FINAL],
+									   rows,
+#if PG_VERSION_NUM >= 180000
+									   0,	/* no disabled plan nodes */
+#endif  /* PG_VERSION_NUM */
+									   startup_cost,
+									   total_cost,
+									   pathkeys,
+									   NULL,	/* no epq_path */
+#if PG_VERSION_NUM >= 170000
+									   NIL,		/* no fdw_restrictinfo */
+#endif  /* PG_VERSION_NUM */
+									   list_make2(makeString(limit_clause.data),
+												  makeInteger((int) limit_rows)));
+
+	/* add the path to the final relation */
+	add_path(final_rel, (Path *) final_path);
+}
+
+/*
+ * getLimitValue
+ * 		Store the value of a LIMIT or OFFSET expression in "value".
+ * 		A missing expression or NULL (LIMIT ALL) leaves "value" unchanged.
+ * 		Returns false if the expression is not a constant that can be pushed down.
+ */
+static bool
+getLimitValue(Node *node, int64 *value)
+{
+	Const *constant;
+
+	if (node == NULL)
+		return true;
+
+	if (!IsA(node, Const))
+		return false;
+
+	constant = (Const *) node;
+	if (constant->constisnull)
+		return true;
+
+	/* negative values cause an error in PostgreSQL, but not in Oracle */
+	if (DatumGetInt64(constant->constvalue) < 0)
+		return false;
+
+	*value = DatumGetInt64(constant->constvalue);
+
+	return true;
+}
+#endif  /* PG_VERSION_NUM */
+#endif  /* UPPER_API */
+
+/*
+ * acquireSampleRowsFunc
+ * 		Perform a sequential scan on the Oracle table and return a sampe of rows.
+ * 		All LOB values are truncated to WIDTH_THRESHOLD+1 because anything
+ * 		exceeding this is not used by compute_scalar_stats().
+ */
+int
+acquireSampleRowsFunc(Relation relation, int elevel, HeapTuple *rows, int targrows, double *totalrows, double *totaldeadrows)
+{
+	int collected_rows = 0, i;
+	struct OracleFdwState *fdw_state;
+	bool first_column = true;
+	StringInfoData query;
+	TupleDesc tupDesc = RelationGetDescr(relation);
+	Datum *values = (Datum *)palloc(tupDesc->natts * sizeof(Datum));
+	bool *nulls = (bool *)palloc(tupDesc->natts * sizeof(bool));
+	double rstate, rowstoskip = -1, sample_percent, expected_rows = -1.0;
+	MemoryContext old_cxt, tmp_cxt;
+	unsigned int index;
+	int table_end;
+	bool rescan;
+
+	elog(DEBUG1, "oracle_fdw: analyze foreign table %d", RelationGetRelid(relation));
+
+	*totalrows = 0;
+
+	/* create a memory context for short-lived data in convertTuple() */
+	tmp_cxt = AllocSetContextCreate(CurrentMemoryContext,
+								"oracle_fdw temporary data",
+								ALLOCSET_SMALL_SIZES);
+
+	/* Prepare for sampling rows */
+	rstate = anl_init_selection_state(targrows);
+
+	/*
+	 * Get connection options, connect and get the remote table description.
+	 * Always use the user mapping for the current user.
+	 */
+	fdw_state = getFdwState(RelationGetRelid(relation), &sample_percent, InvalidOid);
+	fdw_state->paramList = NULL;
+	fdw_state->rowcount = 0;
+	/* we don't have to prefetch more than that much from a LOB */
+	fdw_state->lob_prefetch = WIDTH_THRESHOLD;
+
+	/* use the Oracle optimizer statistics instead of sampling if requested */
+	if (importStatistics(relation, fdw_state, elevel, totalrows))
+	{
+		MemoryContextDelete(tmp_cxt);
+		*totaldeadrows = 0;
+
+		/* without sample rows, ANALYZE keeps the imported statistics */
+		return 0;
+	}
+
+	/* construct query */
+	initStringInfo(&query);
+	appendStringInfo(&query, "SELECT ");
+
+	/* loop columns */
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	{
+		/* don't get LONG, LONG RAW and untranslatable values */
+		if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONG
+				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONGRAW
+				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_GEOMETRY
+				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_OTHER)
+		{
+			fdw_state->oraTable->cols[i]->used = 0;
+		}
+		else
+		{
+			/* all columns are used */
+			fdw_state->oraTable->cols[i]->used = 1;
+
+			if (first_column)
+				first_column = false;
+			else
+				appendStringInfo(&query, ", ");
+
+			/* append column name/expression */
+			if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
+				appendStringInfo(&query, "TO_CLOB(%s)", fdw_state->oraTable->cols[i]->name);
+			else
+				appendStringInfo(&query, "%s", fdw_state->oraTable->cols[i]->name);
+		}
+	}
+
+	/* if there are no columns, use NULL */
+	if (first_column)
+		appendStringInfo(&query, "NULL");
+
+	/* append Oracle table name */
+	appendStringInfo(&query, " FROM %s", fdw_state->oraTable->name);
+
+	/* determine the number of rows to fetch at once */
+	if (fdw_state->fetch_memory > 0)
+		fdw_state->prefetch = getFetchRows(fdw_state);
+
+	/* allocate memory for return values */
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	{
+		if (!fdw_state->oraTable->cols[i]->used)
+			continue;
+
+		fdw_state->oraTable->cols[i]->val = (char *)palloc(fdw_state->oraTable->cols[i]->val_size * fdw_state->prefetch);
+		fdw_state->oraTable->cols[i]->val_len = (uint16 *)palloc(sizeof(uint16) * fdw_state->prefetch);
+		fdw_state->oraTable->cols[i]->val_len4 = 0;
+		fdw_state->oraTable->cols[i]->val_null = (int16 *)palloc(sizeof(int16) * fdw_state->prefetch);
+	}
+
+	/* remember where the SAMPLE clause starts, in case we have to remove it */
+	table_end = query.len;
+
+	/* append SAMPLE clause if appropriate */
+	if (sample_percent < 0.0)
+	{
 		/*
-		 * For outer join, deparse remote_conds and store it in fdwState->where_clause.
-		 * It will be used in createQuery.
+		 * Without "sample_percent", choose the sample size from the row count in
+		 * the Oracle statistics.  A row sample still reads the whole table in Oracle,
+		 * so switch to a block sample if it would contain less than one percent.
 		 */
-		initStringInfo(&where);
-		if (fdwState->remote_conds != NIL)
+		double num_rows = getRemoteRowCount(relation, fdw_state->session);
+
+		sample_percent = 100.0;
+		if (num_rows > 0.0)
+			sample_percent = ROUND_SAMPLE_PERCENT(100.0 * AUTO_SAMPLE_FACTOR * targrows / num_rows);
+
+		if (sample_percent < 1.0)
 		{
-			foreach(lc, fdwState->remote_conds)
+			if (sample_percent < 0.000001)
+				sample_percent = 0.000001;
+			appendStringInfo(&query, " SAMPLE BLOCK (%f)", sample_percent);
+		}
+		else if (sample_percent < 100.0)
+			appendStringInfo(&query, " SAMPLE (%f)", sample_percent);
+		else
+			sample_percent = 100.0;
+
+		if (sample_percent < 100.0)
+			expected_rows = num_rows * sample_percent / 100.0;
+	}
+	else if (sample_percent < 100.0)
+	{
+		/* estimate the row count with the same percentage that Oracle uses */
+		sample_percent = ROUND_SAMPLE_PERCENT(sample_percent);
+		appendStringInfo(&query, " SAMPLE BLOCK (%f)", sample_percent);
+	}
+
+	fdw_state->query = query.data;
+	elog(DEBUG1, "oracle_fdw: remote query is %s", fdw_state->query);
+
+	/* get PostgreSQL column data types, check that they match Oracle's */
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+		if (fdw_state->oraTable->cols[i]->pgname != NULL
+				&& fdw_state->oraTable->cols[i]->used)
+			checkDataType(
+				fdw_state->oraTable->cols[i]->oratype,
+				fdw_state->oraTable->cols[i]->scale,
+				fdw_state->oraTable->cols[i]->pgtype,
+				fdw_state->oraTable->pgname,
+				fdw_state->oraTable->cols[i]->pgname
+			);
+
+	/* look up the type input functions for the result columns */
+	initConverters(fdw_state);
+
+	do
+	{
+		/* execute the query */
+		oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, fdw_state->prefetch, fdw_state->lob_prefetch, PIPELINE_OFF);
+		(void)oracleExecuteQuery(fdw_state->session, fdw_state->oraTable, fdw_state->paramList, fdw_state->prefetch);
+
+		/* loop through query results */
+		while((index = oracleFetchNext(fdw_state->session, fdw_state->prefetch)) > 0)
+		{
+			/* allow user to interrupt ANALYZE */
+#if PG_VERSION_NUM >= 180000
+			vacuum_delay_point(true);
+#else
+			vacuum_delay_point();
+#endif  /* PG_VERSION_NUM */
+
+			++fdw_state->rowcount;
+
+			if (collected_rows < targrows)
 			{
-				char *tmp = NULL;
-				Expr *expr = (Expr *) lfirst(lc);
+				/* the first "targrows" rows are added as samples */
 
-				tmp = deparseExpr(fdwState->session, joinrel, expr, fdwState->oraTable, &(fdwState->params), false);
-				Assert(tmp);
-				appendStringInfo(&where, " %s %s", keyword, tmp);
-				keyword = "AND";
+				/* use a temporary memory context during convertTuple */
+				old_cxt = MemoryContextSwitchTo(tmp_cxt);
+				convertTuple(fdw_state, index, values, nulls);
+				MemoryContextSwitchTo(old_cxt);
+
+				rows[collected_rows++] = heap_form_tuple(tupDesc, values, nulls);
+				MemoryContextReset(tmp_cxt);
 			}
-			fdwState->where_clause = where.data;
+			else
+			{
+				/*
+				 * Skip a number of rows before replacing a random sample row.
+				 * A more detailed description of the algorithm can be found in analyze.c
+				 */
+				if (rowstoskip < 0)
+					rowstoskip = anl_get_next_S(*totalrows, targrows, &rstate);
+
+				if (rowstoskip <= 0)
+				{
+					int k = (int)(targrows * anl_random_fract());
+
+					heap_freetuple(rows[k]);
+
+					/* use a temporary memory context during convertTuple */
+					old_cxt = MemoryContextSwitchTo(tmp_cxt);
+					convertTuple(fdw_state, index, values, nulls);
+					MemoryContextSwitchTo(old_cxt);
+
+					rows[k] = heap_form_tuple(tupDesc, values, nulls);
+					MemoryContextReset(tmp_cxt);
+				}
+			}
+		}
+
+		oracleCloseStatement(fdw_state->session);
+
+		/*
+		 * If the Oracle statistics are outdated, a sample chosen from them can
+		 * contain far fewer rows than expected.  Then scan the whole table.
+		 */
+		rescan = (expected_rows > 0.0 && collected_rows < targrows);
+		if (rescan)
+		{
+			ereport(elevel,
+					(errmsg("\"%s\": sample contains %lu rows instead of about %.0f, scanning the whole table",
+							RelationGetRelationName(relation), fdw_state->rowcount, expected_rows)));
+
+			for (i=0; i<collected_rows; ++i)
+				heap_freetuple(rows[i]);
+			collected_rows = 0;
+			fdw_state->rowcount = 0;
+			rowstoskip = -1;
+			rstate = anl_init_selection_state(targrows);
+
+			/* remove the SAMPLE clause */
+			query.data[table_end] = '\0';
+			query.len = table_end;
+			sample_percent = 100.0;
+			expected_rows = -1.0;
+			elog(DEBUG1, "oracle_fdw: remote query is %s", fdw_state->query);
 		}
+	} while (rescan);
+
+	MemoryContextDelete(tmp_cxt);
+
+	*totalrows = (double)fdw_state->rowcount / sample_percent * 100.0;
+	*totaldeadrows = 0;
+
+	/* report report */
+	ereport(elevel, (errmsg("\"%s\": table contains %lu rows; %d rows in sample",
+			RelationGetRelationName(relation), fdw_state->rowcount, collected_rows)));
+
+	return collected_rows;
+}
+
+/*
+ * getRemoteRowCount
+ * 		Get the number of rows of the Oracle table from the optimizer statistics.
+ * 		Returns -1 if it is unknown or the foreign table is not a local Oracle table.
+ */
+double
+getRemoteRowCount(Relation relation, oracleSession *session)
+{
+	List *options;
+	ListCell *cell;
+	char *schema = NULL, *table = NULL, *dblink = NULL;
+	double num_rows;
+
+	oracleGetOptions(RelationGetRelid(relation), InvalidOid, &options);
+	foreach(cell, options)
+	{
+		DefElem *def = (DefElem *) lfirst(cell);
+		if (strcmp(def->defname, OPT_SCHEMA) == 0)
+			schema = strVal(def->arg);
+		if (strcmp(def->defname, OPT_TABLE) == 0)
+			table = strVal(def->arg);
+		if (strcmp(def->defname, OPT_DBLINK) == 0)
+			dblink = strVal(def->arg);
+	}
+
+	/* SAMPLE does not work for queries, and there are no statistics across a database link */
+	if (dblink != NULL || table[0] == '(')
+		return -1.0;
+
+	if (!oracleGetTableStatistics(session, schema, table, &num_rows))
+		return -1.0;
+
+	return num_rows;
+}
+
+/*
+ * importStatistics
+ * 		If "import_statistics" is set for the foreign table or its server,
+ * 		copy the Oracle optimizer statistics for the table to pg_statistic.
+ * 		Returns false if that is not possible, then rows have to be sampled.
+ */
+bool
+importStatistics(Relation relation, struct OracleFdwState *fdw_state, int elevel, double *totalrows)
+{
+	List *options;
+	ListCell *cell;
+	char *schema = NULL, *table = NULL, *dblink = NULL;
+	bool import = false;
+	double num_rows;
+	int i, ncols = 0;
+
+	oracleGetOptions(RelationGetRelid(relation), InvalidOid, &options);
+	foreach(cell, options)
+	{
+		DefElem *def = (DefElem *) lfirst(cell);
+		if (strcmp(def->defname, OPT_SCHEMA) == 0)
+			schema = strVal(def->arg);
+		if (strcmp(def->defname, OPT_TABLE) == 0)
+			table = strVal(def->arg);
+		if (strcmp(def->defname, OPT_DBLINK) == 0)
+			dblink = strVal(def->arg);
+		if (strcmp(def->defname, OPT_IMPORT_STATISTICS) == 0)
+			import = getBoolVal(def);
 	}
-	else
+
+	if (!import)
+		return false;
+
+	/*
+	 * ANALYZE on the parent of a partition or inheritance child also calls us,
+	 * and without sample rows the child would be missing from the parent's statistics.
+	 * Since we cannot tell these calls apart, children always sample rows.
+	 */
+	if (isInheritanceChild(RelationGetRelid(relation)))
 	{
-		/* for an inner join, remote_conds has all join conditions */
-		Assert(!fdwState->joinclauses);
-		fdwState->joinclauses = fdwState->remote_conds;
-		fdwState->remote_conds = NIL;
+		ereport(elevel,
+				(errmsg("\"%s\": cannot import statistics for a partition or inheritance child, sampling rows",
+						RelationGetRelationName(relation))));
+		return false;
 	}
 
-	/* set fetch size to minimum of the joining sides */
-	if (fdwState_o->prefetch < fdwState_i->prefetch)
-		fdwState->prefetch = fdwState_o->prefetch;
-	else
-		fdwState->prefetch = fdwState_i->prefetch;
-
-	/* set LOB prefetch size to maximum of the joining sides */
-	if (fdwState_o->lob_prefetch < fdwState_i->lob_prefetch)
-		fdwState->lob_prefetch = fdwState_i->lob_prefetch;
-	else
-		fdwState->lob_prefetch = fdwState_o->lob_prefetch;
+	/* the data dictionary only has statistics for local tables */
+	if (dblink != NULL || table[0] == '(')
+	{
+		ereport(elevel,
+				(errmsg("\"%s\": cannot import statistics for a query or a table across a database link, sampling rows",
+						RelationGetRelationName(relation))));
+		return false;
+	}
 
-	/* copy outerrel's infomation to fdwstate */
-	fdwState->dbserver = fdwState_o->dbserver;
-	fdwState->isolation_level = fdwState_o->isolation_level;
-	fdwState->user     = fdwState_o->user;
-	fdwState->password = fdwState_o->password;
-	fdwState->nls_lang = fdwState_o->nls_lang;
-	fdwState->timezone = fdwState_o->timezone;
-	fdwState->have_nchar = fdwState_o->have_nchar;
+	if (!oracleGetTableStatistics(fdw_state->session, schema, table, &num_rows))
+	{
+		ereport(elevel,
+				(errmsg("\"%s\": Oracle table has no optimizer statistics, sampling rows",
+						RelationGetRelationName(relation))));
+		return false;
+	}
 
-	foreach(lc, pull_var_clause((Node *)joinrel->reltarget->exprs, PVC_RECURSE_PLACEHOLDERS))
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
 	{
-		Var *var = (Var *) lfirst(lc);
+		/* allow user to interrupt ANALYZE */
+#if PG_VERSION_NUM >= 180000
+		vacuum_delay_point(true);
+#else
+		vacuum_delay_point();
+#endif  /* PG_VERSION_NUM */
 
-		Assert(IsA(var, Var));
+		if (fdw_state->oraTable->cols[i]->pgname == NULL)
+			continue;
 
-		/*
-		 * Whole-row references and system columns are not pushed down.
-		 * ToDo: support whole-row by creating oraColumns for that.
-		 */
-		if (var->varattno <= 0)
-			return false;
+		if (importColumnStatistics(relation, fdw_state->session, schema, table, fdw_state->oraTable->cols[i], num_rows))
+			++ncols;
 	}
 
+	*totalrows = num_rows;
+
+	ereport(elevel,
+			(errmsg("\"%s\": imported Oracle statistics for %.0f rows and %d columns",
+					RelationGetRelationName(relation), num_rows, ncols)));
+
 	return true;
 }
 
-/* Output join name for given join type */
-const char *
-get_jointype_name(JoinType jointype)
+/*
+ * isInheritanceChild
+ * 		Returns true if the relation is a partition or inherits from another table.
+ */
+bool
+isInheritanceChild(Oid relid)
 {
-	switch (jointype)
-	{
-		case JOIN_INNER:
-			return "INNER";
+	Relation catalog;
+	SysScanDesc scan;
+	ScanKeyData key;
+	bool result;
 
-		case JOIN_LEFT:
-			return "LEFT";
+#if PG_VERSION_NUM >= 120000
+	catalog = table_open(InheritsRelationId, AccessShareLock);
+#else
+	catalog = heap_open(InheritsRelationId, AccessShareLock);
+#endif  /* PG_VERSION_NUM */
 
-		case JOIN_RIGHT:
-			return "RIGHT";
+	ScanKeyInit(&key,
+				Anum_pg_inherits_inhrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+	scan = systable_beginscan(catalog, InheritsRelidSeqnoIndexId, true, NULL, 1, &key);
 
-		case JOIN_FULL:
-			return "FULL";
+	result = HeapTupleIsValid(systable_getnext(scan));
 
-		default:
-			/* Shouldn't come here, but protect from buggy code. */
-			elog(ERROR, "unsupported join type %d", jointype);
-	}
+	systable_endscan(scan);
+#if PG_VERSION_NUM >= 120000
+	table_close(catalog, AccessShareLock);
+#else
+	heap_close(catalog, AccessShareLock);
+#endif  /* PG_VERSION_NUM */
 
-	/* Keep compiler happy */
-	return NULL;
+	return result;
 }
 
 /*
- * Build the targetlist for given relation to be deparsed as SELECT clause.
- *
- * The output targetlist contains the columns that need to be fetched from the
- * foreign server for the given relation.
+ * importColumnStatistics
+ * 		Copy the Oracle optimizer statistics for a column to pg_statistic.
+ * 		Frequency histograms become a list of most common values, other
+ * 		histograms become a histogram.  Values are only imported if the
+ * 		Oracle and PostgreSQL data types are compatible.
+ * 		Returns false if there are no statistics for the column.
  */
-List *
-build_tlist_to_deparse(RelOptInfo *foreignrel)
+bool
+importColumnStatistics(Relation relation, oracleSession *session, char *schema, char *table, struct oraColumn *col, double num_rows)
 {
-	List *tlist = NIL;
-	struct OracleFdwState *fdwState = (struct OracleFdwState *)foreignrel->fdw_private;
+	char *colname, *value, *p, *q;
+	double num_distinct, num_nulls, sample_size, endpoint, last_endpoint = 0.0;
+	int avg_col_len, frequency, nvalues = 0, maxvalues = 0, i;
+	bool import_values;
+	float4 nullfrac, ndistinct;
+	int32 width;
+	Datum *values = NULL;
+	float4 *freqs = NULL;
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(relation), col->pgattnum - 1);
+	Oid typinput, typioparam;
+	FmgrInfo flinfo;
+
+	/* remove the double quotes around the Oracle column name */
+	colname = palloc(strlen(col->name));
+	for (p = col->name + 1, q = colname; p[1] != '\0'; ++p)
+	{
+		*(q++) = *p;
+		if (*p == '"')
+			++p;
+	}
+	*q = '\0';
 
-	/*
-	 * We require columns specified in foreignrel->reltarget->exprs and those
-	 * required for evaluating the local conditions.
-	 */
-	tlist = add_to_flat_tlist(tlist,
-							  pull_var_clause((Node *) foreignrel->reltarget->exprs,
-											  PVC_RECURSE_PLACEHOLDERS));
-	tlist = add_to_flat_tlist(tlist,
-							  pull_var_clause((Node *) fdwState->local_conds,
-											  PVC_RECURSE_PLACEHOLDERS));
+	if (!oracleGetColumnStatistics(session, schema, table, colname, &num_distinct, &num_nulls, &avg_col_len, &sample_size, &frequency))
+		return false;
 
-	return tlist;
-}
+	nullfrac = (num_rows > 0.0) ? num_nulls / num_rows : 0.0;
+	if (nullfrac > 1.0)
+		nullfrac = 1.0;
 
-/*
- * Fill fdwState->oraTable with a table constructed from the
- * inner and outer tables using the target list in "fdw_scan_tlist".
- */
-struct oraTable *
-build_join_oratable(struct OracleFdwState *fdwState, List *fdw_scan_tlist)
-{
-	struct oraTable	*oraTable;
-	char			*tabname;		/* for warning messages */
-	List			*targetvars;	/* pulled Vars from targetlist */
-	ListCell		*lc;
-	struct OracleFdwState *fdwState_o = (struct OracleFdwState *)fdwState->outerrel->fdw_private;
-	struct OracleFdwState *fdwState_i = (struct OracleFdwState *)fdwState->innerrel->fdw_private;
-	struct oraTable *oraTable_o = fdwState_o->oraTable;
-	struct oraTable *oraTable_i = fdwState_i->oraTable;
+	/* Oracle's average length includes the length byte */
+	width = (attr->attlen > 0) ? attr->attlen : avg_col_len;
 
-	oraTable = (struct oraTable *) palloc0(sizeof(struct oraTable));
-	oraTable->name = pstrdup("");
-	oraTable->pgname = pstrdup("");
-	oraTable->ncols = 0;
-	oraTable->npgcols = 0;
-	oraTable->cols = (struct oraColumn **) palloc0(sizeof(struct oraColumn*) *
-												(oraTable_o->ncols + oraTable_i->ncols));
+	/* like ANALYZE, store a negative value if the number of distinct values scales with the table */
+	if (num_rows > 0.0 && num_distinct > 0.1 * num_rows)
+		ndistinct = (num_distinct >= num_rows) ? -1.0 : -(num_distinct / num_rows);
+	else
+		ndistinct = num_distinct;
 
-	/*
-	 * Search oraColumn from children's oraTable.
-	 * Here we assume that children are foreign table, not foreign join.
-	 * We need capability to track relid chain through join tree to support N-way join.
-	 *
-	 * Note: This code is O(#columns^2), but we have no better idea currently.
-	 */
-	tabname = "?";
-	/* get only Vars because there is not only Vars but also PlaceHolderVars in below exprs */
-	targetvars = pull_var_clause((Node *)fdw_scan_tlist, PVC_RECURSE_PLACEHOLDERS);
-	foreach(lc, targetvars)
+	/* only import values that PostgreSQL can read correctly */
+	switch (col->oratype)
 	{
-		int i;
-		Var *var = (Var *) lfirst(lc);
-		struct oraColumn *col = NULL;
-		struct oraColumn *newcol;
-		int used_flag = 0;
+		case ORA_TYPE_NUMBER:
+		case ORA_TYPE_FLOAT:
+		case ORA_TYPE_BINARYFLOAT:
+		case ORA_TYPE_BINARYDOUBLE:
+			import_values = (col->pgtype == INT2OID || col->pgtype == INT4OID || col->pgtype == INT8OID
+							 || col->pgtype == FLOAT4OID || col->pgtype == FLOAT8OID || col->pgtype == NUMERICOID);
+			break;
+		case ORA_TYPE_DATE:
+		case ORA_TYPE_TIMESTAMP:
+			import_values = (col->pgtype == DATEOID || col->pgtype == TIMESTAMPOID);
+			break;
+		case ORA_TYPE_CHAR:
+		case ORA_TYPE_NCHAR:
+		case ORA_TYPE_VARCHAR2:
+		case ORA_TYPE_NVARCHAR2:
+			import_values = (col->pgtype == TEXTOID || col->pgtype == VARCHAROID
+							 || col->pgtype == BPCHAROID || col->pgtype == NAMEOID);
+			break;
+		default:
+			import_values = false;
+	}
 
-		Assert(IsA(var, Var));
+	if (import_values)
+	{
+		getTypeInputInfo(col->pgtype, &typinput, &typioparam);
+		fmgr_info(typinput, &flinfo);
 
-		/* find appropriate entry from children's oraTable */
-		for (i=0; i<oraTable_o->ncols; ++i)
+		while (oracleGetHistogram(session, schema, table, colname, col->oratype, &endpoint, &value))
 		{
-			struct oraColumn *tmp = oraTable_o->cols[i];
+			/* if a value is unknown, skip the histogram (but fetch all rows) */
+			if (value == NULL)
+				import_values = false;
+			if (!import_values)
+				continue;
 
-			if (tmp->varno == var->varno)
+			if (nvalues == maxvalues)
 			{
-				tabname = oraTable_o->pgname;
+				maxvalues = (maxvalues == 0) ? 256 : 2 * maxvalues;
+				values = (values == NULL) ? palloc(maxvalues * sizeof(Datum))
+										  : repalloc(values, maxvalues * sizeof(Datum));
+				freqs = (freqs == NULL) ? palloc(maxvalues * sizeof(float4))
+										: repalloc(freqs, maxvalues * sizeof(float4));
+			}
 
-				if (tmp->pgattnum == var->varattno)
-				{
-					col = tmp;
-					break;
-				}
+			/* skip the histogram if a value cannot be converted */
+			if (!convertStatisticsValue(&flinfo, typioparam, col, value, &values[nvalues]))
+			{
+				import_values = false;
+				continue;
 			}
+
+			/* for frequency histograms, the endpoint is the cumulative row count */
+			freqs[nvalues] = endpoint - last_endpoint;
+			last_endpoint = endpoint;
+			++nvalues;
 		}
-		if (!col)
-		{
-			for (i=0; i<oraTable_i->ncols; ++i)
-			{
-				struct oraColumn *tmp = oraTable_i->cols[i];
+	}
 
-				if (tmp->varno == var->varno)
-				{
-					tabname = oraTable_i->pgname;
+	if (!import_values)
+		nvalues = 0;
 
-					if (tmp->pgattnum == var->varattno)
-					{
-						col = tmp;
-						break;
-					}
-				}
-			}
-		}
+	if (frequency && nvalues > 0)
+	{
+		/* the sample size also contains the rows not in a TOP-FREQUENCY histogram */
+		double total = (sample_size > last_endpoint) ? sample_size : last_endpoint;
+		struct mcvItem *mcv = palloc(nvalues * sizeof(struct mcvItem));
 
-		newcol = (struct oraColumn*) palloc0(sizeof(struct oraColumn));
-		if (col)
+		/* PostgreSQL wants the most common values in descending order of frequency */
+		for (i=0; i<nvalues; ++i)
 		{
-			memcpy(newcol, col, sizeof(struct oraColumn));
-			used_flag = 1;
+			mcv[i].value = values[i];
+			mcv[i].freq = freqs[i] / total * (1.0 - nullfrac);
 		}
-		else
-			/* non-existing column, print a warning */
-			ereport(WARNING,
-					(errcode(ERRCODE_WARNING),
-					errmsg("column number %d of foreign table \"%s\" does not exist in foreign Oracle table, will be replaced by NULL", var->varattno, tabname)));
+		qsort(mcv, nvalues, sizeof(struct mcvItem), compareMCV);
+		for (i=0; i<nvalues; ++i)
+		{
+			values[i] = mcv[i].value;
+			freqs[i] = mcv[i].freq;
+		}
+	}
+	else if (nvalues > 0)
+	{
+		/* a histogram needs two bounds sorted like PostgreSQL sorts them */
+		TypeCacheEntry *typentry = lookup_type_cache(col->pgtype, TYPECACHE_LT_OPR);
 
-		newcol->used = used_flag;
-		/* pgattnum should be the index in SELECT clause of join query. */
-		newcol->pgattnum = oraTable->ncols + 1;
+		if (nvalues < 2 || !OidIsValid(typentry->lt_opr))
+			nvalues = 0;
 
-		oraTable->cols[oraTable->ncols++] = newcol;
+		for (i=1; i<nvalues; ++i)
+			if (DatumGetBool(OidFunctionCall2Coll(get_opcode(typentry->lt_opr), attr->attcollation, values[i], values[i-1])))
+			{
+				nvalues = 0;
+				break;
+			}
 	}
 
-	oraTable->npgcols = oraTable->ncols;
+	storeColumnStatistics(relation, col->pgattnum, nullfrac, width, ndistinct, nvalues, values, frequency ? freqs : NULL);
 
-	return oraTable;
+	return true;
 }
-#endif  /* JOIN_API */
 
 /*
- * acquireSampleRowsFunc
- * 		Perform a sequential scan on the Oracle table and return a sampe of rows.
- * 		All LOB values are truncated to WIDTH_THRESHOLD+1 because anything
- * 		exceeding this is not used by compute_scalar_stats().
+ * convertStatisticsValue
+ * 		Convert a histogram value from Oracle to the column's PostgreSQL type.
+ * 		Returns false instead of throwing an error if that is not possible,
+ * 		for example if an Oracle NUMBER is out of range for "integer".
  */
-int
-acquireSampleRowsFunc(Relation relation, int elevel, HeapTuple *rows, int targrows, double *totalrows, double *totaldeadrows)
+bool
+convertStatisticsValue(FmgrInfo *flinfo, Oid typioparam, struct oraColumn *col, char *value, Datum *result)
 {
-	int collected_rows = 0, i;
-	struct OracleFdwState *fdw_state;
-	bool first_column = true;
-	StringInfoData query;
-	TupleDesc tupDesc = RelationGetDescr(relation);
-	Datum *values = (Datum *)palloc(tupDesc->natts * sizeof(Datum));
-	bool *nulls = (bool *)palloc(tupDesc->natts * sizeof(bool));
-	double rstate, rowstoskip = -1, sample_percent;
-	MemoryContext old_cxt, tmp_cxt;
-	unsigned int index;
-
-	elog(DEBUG1, "oracle_fdw: analyze foreign table %d", RelationGetRelid(relation));
-
-	*totalrows = 0;
-
-	/* create a memory context for short-lived data in convertTuple() */
-	tmp_cxt = AllocSetContextCreate(CurrentMemoryContext,
-								"oracle_fdw temporary data",
-								ALLOCSET_SMALL_SIZES);
-
-	/* Prepare for sampling rows */
-	rstate = anl_init_selection_state(targrows);
-
-	/*
-	 * Get connection options, connect and get the remote table description.
-	 * Always use the user mapping for the current user.
-	 */
-	fdw_state = getFdwState(RelationGetRelid(relation), &sample_percent, InvalidOid);
-	fdw_state->paramList = NULL;
-	fdw_state->rowcount = 0;
-	/* we don't have to prefetch more than that much from a LOB */
-	fdw_state->lob_prefetch = WIDTH_THRESHOLD;
+#if PG_VERSION_NUM >= 160000
+	ErrorSaveContext escontext = {T_ErrorSaveContext};
 
-	/* construct query */
-	initStringInfo(&query);
-	appendStringInfo(&query, "SELECT ");
+	return InputFunctionCallSafe(flinfo, value, typioparam, col->pgtypmod, (Node *) &escontext, result);
+#else
+	double val;
+	char *end;
 
-	/* loop columns */
-	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	/* check the values that the type input functions reject */
+	switch (col->pgtype)
 	{
-		/* don't get LONG, LONG RAW and untranslatable values */
-		if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONG
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONGRAW
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_GEOMETRY
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_OTHER)
-		{
-			fdw_state->oraTable->cols[i]->used = 0;
-		}
-		else
-		{
-			/* all columns are used */
-			fdw_state->oraTable->cols[i]->used = 1;
-
-			/* allocate memory for return value */
-			fdw_state->oraTable->cols[i]->val = (char *)palloc(fdw_state->oraTable->cols[i]->val_size * fdw_state->prefetch);
-			fdw_state->oraTable->cols[i]->val_len = (uint16 *)palloc(sizeof(uint16) * fdw_state->prefetch);
-			fdw_state->oraTable->cols[i]->val_len4 = 0;
-			fdw_state->oraTable->cols[i]->val_null = (int16 *)palloc(sizeof(int16) * fdw_state->prefetch);
-
-			if (first_column)
-				first_column = false;
-			else
-				appendStringInfo(&query, ", ");
-
-			/* append column name/expression */
-			if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
-				appendStringInfo(&query, "TO_CLOB(%s)", fdw_state->oraTable->cols[i]->name);
-			else
-				appendStringInfo(&query, "%s", fdw_state->oraTable->cols[i]->name);
-		}
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+		case FLOAT4OID:
+			val = strtod(value, &end);
+			if (*end != '\0')
+				return false;
+			if (col->pgtype == FLOAT4OID)
+			{
+				if (fabs(val) > FLT_MAX || (val != 0.0 && fabs(val) < FLT_MIN))
+					return false;
+				break;
+			}
+			if (val != floor(val))
+				return false;
+			if (col->pgtype == INT2OID && (val < SHRT_MIN || val > SHRT_MAX))
+				return false;
+			if (col->pgtype == INT4OID && (val < INT_MIN || val > INT_MAX))
+				return false;
+			/* 2^63 is exactly representable, the largest "bigint" is not */
+			if (val < -9223372036854775808.0 || val >= 9223372036854775808.0)
+				return false;
+			break;
+		default:
+			break;
 	}
 
-	/* if there are no columns, use NULL */
-	if (first_column)
-		appendStringInfo(&query, "NULL");
+	/* without type modifier, long strings and numbers with too many digits are accepted */
+	*result = InputFunctionCall(flinfo, value, typioparam, -1);
 
-	/* append Oracle table name */
-	appendStringInfo(&query, " FROM %s", fdw_state->oraTable->name);
+	return true;
+#endif  /* PG_VERSION_NUM */
+}
 
-	/* append SAMPLE clause if appropriate */
-	if (sample_percent < 100.0)
-		appendStringInfo(&query, " SAMPLE BLOCK (%f)", sample_percent);
+/*
+ * compareMCV
+ * 		qsort comparator that sorts most common values by descending frequency.
+ */
+int
+compareMCV(const void *a, const void *b)
+{
+	float4 freq_a = ((const struct mcvItem *)a)->freq, freq_b = ((const struct mcvItem *)b)->freq;
 
-	fdw_state->query = query.data;
-	elog(DEBUG1, "oracle_fdw: remote query is %s", fdw_state->query);
+	return (freq_a > freq_b) ? -1 : (freq_a < freq_b) ? 1 : 0;
+}
 
-	/* get PostgreSQL column data types, check that they match Oracle's */
-	for (i=0; i<fdw_state->oraTable->ncols; ++i)
-		if (fdw_state->oraTable->cols[i]->pgname != NULL
-				&& fdw_state->oraTable->cols[i]->used)
-			checkDataType(
-				fdw_state->oraTable->cols[i]->oratype,
-				fdw_state->oraTable->cols[i]->scale,
-				fdw_state->oraTable->cols[i]->pgtype,
-				fdw_state->oraTable->pgname,
-				fdw_state->oraTable->cols[i]->pgname
-			);
+/*
+ * storeColumnStatistics
+ * 		Insert or replace the pg_statistic entry for a column, like ANALYZE does.
+ * 		If "nvalues" is greater than zero, "values" is stored as list of most
+ * 		common values with frequencies "freqs" or, if "freqs" is NULL, as histogram.
+ */
+void
+storeColumnStatistics(Relation relation, AttrNumber attnum, float4 nullfrac, int32 width, float4 ndistinct, int nvalues, Datum *values, float4 *freqs)
+{
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(relation), attnum - 1);
+	Relation sd;
+	HeapTuple stup, oldtup;
+	Datum stat_values[Natts_pg_statistic];
+	bool nulls[Natts_pg_statistic];
+	bool replaces[Natts_pg_statistic];
+	int i;
+
+	for (i=0; i<Natts_pg_statistic; ++i)
+	{
+		nulls[i] = false;
+		replaces[i] = true;
+	}
 
-	/* execute the query */
-	oraclePrepareQuery(fdw_state->session, fdw_state->query, fdw_state->oraTable, fdw_state->prefetch, fdw_state->lob_prefetch);
-	(void)oracleExecuteQuery(fdw_state->session, fdw_state->oraTable, fdw_state->paramList, fdw_state->prefetch);
+	stat_values[Anum_pg_statistic_starelid - 1] = ObjectIdGetDatum(RelationGetRelid(relation));
+	stat_values[Anum_pg_statistic_staattnum - 1] = Int16GetDatum(attnum);
+	stat_values[Anum_pg_statistic_stainherit - 1] = BoolGetDatum(false);
+	stat_values[Anum_pg_statistic_stanullfrac - 1] = Float4GetDatum(nullfrac);
+	stat_values[Anum_pg_statistic_stawidth - 1] = Int32GetDatum(width);
+	stat_values[Anum_pg_statistic_stadistinct - 1] = Float4GetDatum(ndistinct);
 
-	/* loop through query results */
-	while((index = oracleFetchNext(fdw_state->session, fdw_state->prefetch)) > 0)
+	/* start with empty slots */
+	for (i=0; i<STATISTIC_NUM_SLOTS; ++i)
 	{
-		/* allow user to interrupt ANALYZE */
-#if PG_VERSION_NUM >= 180000
-		vacuum_delay_point(true);
-#else
-		vacuum_delay_point();
+		stat_values[Anum_pg_statistic_stakind1 - 1 + i] = Int16GetDatum(0);
+		stat_values[Anum_pg_statistic_staop1 - 1 + i] = ObjectIdGetDatum(InvalidOid);
+#if PG_VERSION_NUM >= 120000
+		stat_values[Anum_pg_statistic_stacoll1 - 1 + i] = ObjectIdGetDatum(InvalidOid);
 #endif  /* PG_VERSION_NUM */
+		stat_values[Anum_pg_statistic_stanumbers1 - 1 + i] = (Datum) 0;
+		nulls[Anum_pg_statistic_stanumbers1 - 1 + i] = true;
+		stat_values[Anum_pg_statistic_stavalues1 - 1 + i] = (Datum) 0;
+		nulls[Anum_pg_statistic_stavalues1 - 1 + i] = true;
+	}
 
-		++fdw_state->rowcount;
-
-		if (collected_rows < targrows)
-		{
-			/* the first "targrows" rows are added as samples */
+	if (nvalues > 0)
+	{
+		TypeCacheEntry *typentry = lookup_type_cache(attr->atttypid, TYPECACHE_EQ_OPR | TYPECACHE_LT_OPR);
+		int16 typlen;
+		bool typbyval;
+		char typalign;
 
-			/* use a temporary memory context during convertTuple */
-			old_cxt = MemoryContextSwitchTo(tmp_cxt);
-			convertTuple(fdw_state, index, values, nulls);
-			MemoryContextSwitchTo(old_cxt);
+		stat_values[Anum_pg_statistic_stakind1 - 1] = Int16GetDatum((freqs == NULL) ? STATISTIC_KIND_HISTOGRAM : STATISTIC_KIND_MCV);
+		stat_values[Anum_pg_statistic_staop1 - 1] = ObjectIdGetDatum((freqs == NULL) ? typentry->lt_opr : typentry->eq_opr);
+#if PG_VERSION_NUM >= 120000
+		stat_values[Anum_pg_statistic_stacoll1 - 1] = ObjectIdGetDatum(attr->attcollation);
+#endif  /* PG_VERSION_NUM */
 
-			rows[collected_rows++] = heap_form_tuple(tupDesc, values, nulls);
-			MemoryContextReset(tmp_cxt);
-		}
-		else
+		if (freqs != NULL)
 		{
-			/*
-			 * Skip a number of rows before replacing a random sample row.
-			 * A more detailed description of the algorithm can be found in analyze.c
-			 */
-			if (rowstoskip < 0)
-				rowstoskip = anl_get_next_S(*totalrows, targrows, &rstate);
-
-			if (rowstoskip <= 0)
-			{
-				int k = (int)(targrows * anl_random_fract());
+			Datum *numbers = palloc(nvalues * sizeof(Datum));
 
-				heap_freetuple(rows[k]);
-
-				/* use a temporary memory context during convertTuple */
-				old_cxt = MemoryContextSwitchTo(tmp_cxt);
-				convertTuple(fdw_state, index, values, nulls);
-				MemoryContextSwitchTo(old_cxt);
+			for (i=0; i<nvalues; ++i)
+				numbers[i] = Float4GetDatum(freqs[i]);
 
-				rows[k] = heap_form_tuple(tupDesc, values, nulls);
-				MemoryContextReset(tmp_cxt);
-			}
+			get_typlenbyvalalign(FLOAT4OID, &typlen, &typbyval, &typalign);
+			stat_values[Anum_pg_statistic_stanumbers1 - 1] = PointerGetDatum(
+				construct_array(numbers, nvalues, FLOAT4OID, typlen, typbyval, typalign));
+			nulls[Anum_pg_statistic_stanumbers1 - 1] = false;
 		}
+
+		get_typlenbyvalalign(attr->atttypid, &typlen, &typbyval, &typalign);
+		stat_values[Anum_pg_statistic_stavalues1 - 1] = PointerGetDatum(
+			construct_array(values, nvalues, attr->atttypid, typlen, typbyval, typalign));
+		nulls[Anum_pg_statistic_stavalues1 - 1] = false;
 	}
 
-	oracleCloseStatement(fdw_state->session);
+#if PG_VERSION_NUM >= 120000
+	sd = table_open(StatisticRelationId, RowExclusiveLock);
+#else
+	sd = heap_open(StatisticRelationId, RowExclusiveLock);
+#endif  /* PG_VERSION_NUM */
 
-	MemoryContextDelete(tmp_cxt);
+	/* replace an existing entry or insert a new one */
+	oldtup = SearchSysCache3(STATRELATTINH,
+							 ObjectIdGetDatum(RelationGetRelid(relation)),
+							 Int16GetDatum(attnum),
+							 BoolGetDatum(false));
 
-	*totalrows = (double)fdw_state->rowcount / sample_percent * 100.0;
-	*totaldeadrows = 0;
+	if (HeapTupleIsValid(oldtup))
+	{
+		stup = heap_modify_tuple(oldtup, RelationGetDescr(sd), stat_values, nulls, replaces);
+		ReleaseSysCache(oldtup);
+#if PG_VERSION_NUM >= 100000
+		CatalogTupleUpdate(sd, &stup->t_self, stup);
+#else
+		simple_heap_update(sd, &stup->t_self, stup);
+		CatalogUpdateIndexes(sd, stup);
+#endif  /* PG_VERSION_NUM */
+	}
+	else
+	{
+		stup = heap_form_tuple(RelationGetDescr(sd), stat_values, nulls);
+#if PG_VERSION_NUM >= 100000
+		CatalogTupleInsert(sd, stup);
+#else
+		simple_heap_insert(sd, stup);
+		CatalogUpdateIndexes(sd, stup);
+#endif  /* PG_VERSION_NUM */
+	}
 
-	/* report report */
-	ereport(elevel, (errmsg("\"%s\": table contains %lu rows; %d rows in sample",
-			RelationGetRelationName(relation), fdw_state->rowcount, collected_rows)));
+	heap_freetuple(stup);
 
-	return collected_rows;
+#if PG_VERSION_NUM >= 120000
+	table_close(sd, RowExclusiveLock);
+#else
+	heap_close(sd, RowExclusiveLock);
+#endif  /* PG_VERSION_NUM */
 }
 
 /*
@@ -3853,11 +7626,16 @@ deparseExpr(oracleSession *session, RelOptInfo *foreignrel, Expr *expr, const st
 #if PG_VERSION_NUM >= 100000
 	SQLValueFunction *sqlvalfunc;
 #endif  /* PG_VERSION_NUM */
+#ifdef UPPER_API
+	Aggref *aggref;
+	char *aggname;
+	bool numeric_arg;
+#endif  /* UPPER_API */
 	regproc typoutput;
 	HeapTuple tuple;
 	ListCell *cell;
 	StringInfoData result;
-	Oid leftargtype, rightargtype, schema;
+	Oid leftargtype, rightargtype, schema, elemtype;
 	oraType oratype;
 	ArrayIterator iterator;
 	Datum datum;
@@ -3943,17 +7721,10 @@ deparseExpr(oracleSession *session, RelOptInfo *foreignrel, Expr *expr, const st
 					var_table = oraTable;
 #ifdef JOIN_API
 			}
-			else
+			else if (variable->varlevelsup == 0)
 			{
-				struct OracleFdwState *joinstate = (struct OracleFdwState *)foreignrel->fdw_private;
-				struct OracleFdwState *outerstate = (struct OracleFdwState *)joinstate->outerrel->fdw_private;
-				struct OracleFdwState *innerstate = (struct OracleFdwState *)joinstate->innerrel->fdw_private;
-
-				/* we can't get here if the foreign table has no columns, so this is safe */
-				if (variable->varno == outerstate->oraTable->cols[0]->varno && variable->varlevelsup == 0)
-					var_table = outerstate->oraTable;
-				if (variable->varno == innerstate->oraTable->cols[0]->varno && variable->varlevelsup == 0)
-					var_table = innerstate->oraTable;
+				/* find the base relation in the join tree */
+				var_table = getBaseOraTable(foreignrel, variable->varno);
 			}
 #endif  /* JOIN_API */
 
@@ -4336,6 +8107,40 @@ deparseExpr(oracleSession *session, RelOptInfo *foreignrel, Expr *expr, const st
 
 					break;
 
+				case T_Param:
+					/*
+					 * An array parameter is bound as an Oracle collection,
+					 * so that all values are sent in a single round trip.
+					 * Only IN is supported, because NOT IN would not handle
+					 * NULL arrays correctly.
+					 */
+					param = (Param *)rightexpr;
+					elemtype = get_element_type(param->paramtype);
+					if (!arrayoper->useOr || !(isNumberArrayElem(elemtype) || isStringArrayElem(elemtype)))
+						return NULL;
+
+					if (is_check_only)
+						break;
+
+					/* find the index in the parameter list */
+					index = 0;
+					foreach(cell, *params)
+					{
+						++index;
+						if (equal(param, (Node *)lfirst(cell)))
+							break;
+					}
+					if (cell == NULL)
+					{
+						/* add the parameter to the list */
+						++index;
+						*params = lappend(*params, param);
+					}
+
+					appendStringInfo(&result, "SELECT column_value FROM TABLE(:p%.5d)", index);
+
+					break;
+
 				default:
 					return NULL;
 			}
@@ -4791,6 +8596,109 @@ deparseExpr(oracleSession *session, RelOptInfo *foreignrel, Expr *expr, const st
 
 			break;
 #endif  /* PG_VERSION_NUM >= 100000 */
+#ifdef UPPER_API
+		case T_Aggref:
+			aggref = (Aggref *)expr;
+
+			/* only simple aggregates without ORDER BY and FILTER can be translated */
+			if (aggref->aggorder != NIL || aggref->aggfilter != NULL
+					|| aggref->aggvariadic || aggref->aggkind != AGGKIND_NORMAL
+					|| aggref->aggsplit != AGGSPLIT_SIMPLE || aggref->agglevelsup != 0
+					|| (aggref->aggstar ? aggref->args != NIL : list_length(aggref->args) != 1))
+				return NULL;
+
+			/* get function name and schema */
+			tuple = SearchSysCache1(PROCOID, ObjectIdGetDatum(aggref->aggfnoid));
+			if (! HeapTupleIsValid(tuple))
+			{
+				elog(ERROR, "cache lookup failed for function %u", aggref->aggfnoid);
+			}
+			opername = pstrdup(((Form_pg_proc)GETSTRUCT(tuple))->proname.data);
+			schema = ((Form_pg_proc)GETSTRUCT(tuple))->pronamespace;
+			ReleaseSysCache(tuple);
+
+			/* ignore aggregates in other than the pg_catalog schema */
+			if (schema != PG_CATALOG_NAMESPACE)
+				return NULL;
+
+			/* deparse the argument, if there is one */
+			if (aggref->aggstar)
+			{
+				arg = "*";
+				leftargtype = InvalidOid;
+			}
+			else
+			{
+				Expr *argexpr = ((TargetEntry *)linitial(aggref->args))->expr;
+
+				leftargtype = exprType((Node *)argexpr);
+				arg = deparseExpr(session, foreignrel, argexpr, oraTable, params, is_check_only);
+				if (arg == NULL)
+					return NULL;
+			}
+
+			numeric_arg = (leftargtype == INT2OID || leftargtype == INT4OID
+						|| leftargtype == INT8OID || leftargtype == FLOAT4OID
+						|| leftargtype == FLOAT8OID || leftargtype == NUMERICOID);
+
+			/*
+			 * Translate the aggregates that Oracle has.
+			 * MIN and MAX are not translated for strings, because
+			 * Oracle would compare them with a different collation.
+			 * PostgreSQL's "stddev" and "variance" return NULL for a single
+			 * row, like Oracle's STDDEV_SAMP and VAR_SAMP do.
+			 */
+			aggname = NULL;
+			if (strcmp(opername, "count") == 0 && leftargtype != BOOLOID)
+				aggname = "COUNT";
+			else if ((strcmp(opername, "min") == 0 || strcmp(opername, "max") == 0)
+					&& (numeric_arg || leftargtype == DATEOID
+						|| leftargtype == TIMESTAMPOID || leftargtype == TIMESTAMPTZOID))
+				aggname = (strcmp(opername, "min") == 0) ? "MIN" : "MAX";
+			else if (!numeric_arg)
+				aggname = NULL;
+			else if (strcmp(opername, "sum") == 0)
+				aggname = "SUM";
+			else if (strcmp(opername, "avg") == 0)
+				aggname = "AVG";
+			else if (strcmp(opername, "stddev") == 0 || strcmp(opername, "stddev_samp") == 0)
+				aggname = "STDDEV_SAMP";
+			else if (strcmp(opername, "stddev_pop") == 0)
+				aggname = "STDDEV_POP";
+			else if (strcmp(opername, "variance") == 0 || strcmp(opername, "var_samp") == 0)
+				aggname = "VAR_SAMP";
+			else if (strcmp(opername, "var_pop") == 0)
+				aggname = "VAR_POP";
+
+			/* Oracle allows DISTINCT only with some of them */
+			if (aggname != NULL && aggref->aggdistinct != NIL
+					&& (strncmp(aggname, "STDDEV_", 7) == 0 || strncmp(aggname, "VAR_", 4) == 0))
+				return NULL;
+
+			initStringInfo(&result);
+			if (aggname != NULL)
+				appendStringInfo(&result, "%s(%s%s)",
+								 aggname,
+								 (aggref->aggdistinct != NIL) ? "DISTINCT " : "",
+								 arg);
+			else if (leftargtype == BOOLOID && aggref->aggdistinct == NIL
+					&& (strcmp(opername, "bool_and") == 0
+						|| strcmp(opername, "every") == 0
+						|| strcmp(opername, "bool_or") == 0))
+			{
+				/*
+				 * Oracle has no booleans, so the argument is a condition.
+				 * Map it to 1 and 0 and take the minimum or maximum.
+				 */
+				appendStringInfo(&result, "(%s(CASE WHEN %s THEN 1 WHEN NOT %s THEN 0 END) = 1)",
+								 (strcmp(opername, "bool_or") == 0) ? "MAX" : "MIN",
+								 arg, arg);
+			}
+			else
+				return NULL;  /* don't push down other aggregates */
+
+			break;
+#endif  /* UPPER_API */
 		default:
 			/* we cannot translate this to Oracle */
 			return NULL;
@@ -5559,6 +9467,20 @@ List
 	result = lappend(result, serializeInt((int)fdwState->prefetch));
 	/* Oracle LOB prefetch size */
 	result = lappend(result, serializeInt((int)fdwState->lob_prefetch));
+	/* number of rows in a batch insert */
+	result = lappend(result, serializeInt((int)fdwState->batch_size));
+	/* memory budget for fetched rows */
+	result = lappend(result, serializeInt((int)fdwState->fetch_memory));
+	/* pipelined fetch */
+	result = lappend(result, serializeInt((int)fdwState->pipeline_fetch));
+	/* maximal number of rows with a pushed down LIMIT */
+	result = lappend(result, serializeInt((int)fdwState->limit_rows));
+	/* count the rows of a direct modification */
+	result = lappend(result, serializeInt((int)fdwState->set_processed));
+	/* INSERT ... ON CONFLICT DO NOTHING */
+	result = lappend(result, serializeInt((int)fdwState->do_nothing));
+	/* number of slices for a parallel scan */
+	result = lappend(result, serializeInt(fdwState->parallel_slices));
 	/* Oracle table name */
 	result = lappend(result, serializeString(fdwState->oraTable->name));
 	/* PostgreSQL table name */
@@ -5580,6 +9502,7 @@ List
 		result = lappend(result, serializeInt(fdwState->oraTable->cols[i]->used));
 		result = lappend(result, serializeInt(fdwState->oraTable->cols[i]->strip_zeros));
 		result = lappend(result, serializeInt(fdwState->oraTable->cols[i]->pkey));
+		result = lappend(result, serializeInt(fdwState->oraTable->cols[i]->fetchtype));
 		result = lappend(result, serializeInt(fdwState->oraTable->cols[i]->val_size));
 		/* don't serialize val, val_len, val_len4, val_null and varno */
 	}
@@ -5600,7 +9523,7 @@ List
 	}
 	/*
 	 * Don't serialize params, startup_cost, total_cost, rowcount, columnindex,
-	 * temp_cxt, order_clause, usable_pathkeys and where_clause.
+	 * temp_cxt, order_clause, usable_pathkeys, where_clause and group_clause.
 	 */
 
 	return result;
@@ -5641,11 +9564,31 @@ struct OracleFdwState
 	state->total_cost = 0;
 	state->order_clause = NULL;
 	state->usable_pathkeys = NULL;
+	state->pushdown_safe = false;
+	state->grouped_tlist = NIL;
+	state->group_clause = NULL;
+	state->server_major = 0;
+	state->limit_clause = NULL;
+	state->load_schema = NULL;
+	state->load_table = NULL;
 	/* these are not serialized */
 	state->rowcount = 0;
 	state->columnindex = 0;
 	state->params = NULL;
 	state->temp_cxt = NULL;
+	state->converters = NULL;
+	state->direct_path = false;
+	state->queued_rows = 0;
+	state->queued_operation = CMD_UNKNOWN;
+	state->async_capable = false;
+	state->use_remote_estimate = false;
+	state->async_execution = false;
+	state->executed = false;
+	state->wait_fd = -1;
+	state->parallel_workers = 0;
+	state->pscan = NULL;
+	state->pscan_local = false;
+	state->slice = -1;
 
 	/* dbserver */
 	state->dbserver = deserializeString(lfirst(cell));
@@ -5687,6 +9630,34 @@ struct OracleFdwState
 	state->lob_prefetch = (unsigned int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
 	cell = list_next(list, cell);
 
+	/* number of rows in a batch insert */
+	state->batch_size = (unsigned int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* memory budget for fetched rows */
+	state->fetch_memory = (unsigned int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* pipelined fetch */
+	state->pipeline_fetch = (bool)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* maximal number of rows with a pushed down LIMIT */
+	state->limit_rows = (unsigned int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* count the rows of a direct modification */
+	state->set_processed = (bool)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* INSERT ... ON CONFLICT DO NOTHING */
+	state->do_nothing = (bool)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
+	/* number of slices for a parallel scan */
+	state->parallel_slices = (int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+	cell = list_next(list, cell);
+
 	/* table data */
 	state->oraTable = (struct oraTable *)palloc(sizeof(struct oraTable));
 	state->oraTable->name = deserializeString(lfirst(cell));
@@ -5723,16 +9694,43 @@ struct OracleFdwState
 		cell = list_next(list, cell);
 		state->oraTable->cols[i]->pkey = (int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
 		cell = list_next(list, cell);
+		state->oraTable->cols[i]->fetchtype = (oraFetchType)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
+		cell = list_next(list, cell);
 		state->oraTable->cols[i]->val_size = DatumGetInt32(((Const *)lfirst(cell))->constvalue);
 		cell = list_next(list, cell);
+	}
+
+	/* with "fetch_memory", the number of rows depends on the used columns */
+	if (state->fetch_memory > 0)
+		state->prefetch = getFetchRows(state);
+
+	/* there is no point in fetching more rows than the LIMIT allows */
+	if (state->limit_rows > 0 && state->prefetch > state->limit_rows)
+		state->prefetch = state->limit_rows;
+
+	/* a pipelined fetch needs two result buffers that share the memory budget */
+	if (state->pipeline_fetch && state->fetch_memory > 0 && state->prefetch > 1)
+		state->prefetch /= 2;
+
+	if (state->pipeline_fetch && !canPipelineFetch(state))
+		state->pipeline_fetch = false;
+
+	for (i=0; i<state->oraTable->ncols; ++i)
+	{
 		/*
 		 * Allocate memory for the result value.
-		 * Multiply the space to allocate with the prefetch count.
+		 * Multiply the space to allocate with the prefetch count
+		 * (twice that for a pipelined fetch),
+		 * unused columns need space for only one row.
 		 */
-		state->oraTable->cols[i]->val = (char *)palloc(state->oraTable->cols[i]->val_size * state->prefetch);
-		state->oraTable->cols[i]->val_len = (uint16 *)palloc(sizeof(uint16) * state->prefetch);
+		unsigned int rows = state->oraTable->cols[i]->used
+							? (state->pipeline_fetch ? 2 * state->prefetch : state->prefetch)
+							: 1;
+
+		state->oraTable->cols[i]->val = (char *)palloc(state->oraTable->cols[i]->val_size * rows);
+		state->oraTable->cols[i]->val_len = (uint16 *)palloc(sizeof(uint16) * rows);
 		state->oraTable->cols[i]->val_len4 = 0;
-		state->oraTable->cols[i]->val_null = (int16 *)palloc(sizeof(int16) * state->prefetch);
+		state->oraTable->cols[i]->val_null = (int16 *)palloc(sizeof(int16) * rows);
 	}
 
 	/* length of parameter list */
@@ -5756,6 +9754,7 @@ struct OracleFdwState
 			param->value = NULL;
 		param->node = NULL;
 		param->bindh = NULL;
+		param->values = NULL;
 		param->colnum = (int)DatumGetInt32(((Const *)lfirst(cell))->constvalue);
 		cell = list_next(list, cell);
 		param->next = state->paramList;
@@ -5991,6 +9990,7 @@ struct OracleFdwState
 		copy->oraTable->cols[i]->used = 0;
 		copy->oraTable->cols[i]->strip_zeros = orig->oraTable->cols[i]->strip_zeros;
 		copy->oraTable->cols[i]->pkey = orig->oraTable->cols[i]->pkey;
+		copy->oraTable->cols[i]->fetchtype = orig->oraTable->cols[i]->fetchtype;
 		/* these are not needed for planning */
 		copy->oraTable->cols[i]->val = NULL;
 		copy->oraTable->cols[i]->val_size = orig->oraTable->cols[i]->val_size;
@@ -6003,9 +10003,37 @@ struct OracleFdwState
 	copy->rowcount = 0;
 	copy->columnindex = 0;
 	copy->temp_cxt = NULL;
+	copy->converters = NULL;
 	copy->order_clause = NULL;
+	copy->pushdown_safe = false;
+	copy->grouped_tlist = NIL;
+	copy->group_clause = NULL;
+	copy->server_major = orig->server_major;
+	copy->limit_clause = NULL;
+	copy->limit_rows = 0;
+	copy->set_processed = false;
+	copy->do_nothing = false;
 	copy->prefetch = orig->prefetch;
 	copy->lob_prefetch = orig->lob_prefetch;
+	copy->batch_size = orig->batch_size;
+	copy->load_schema = NULL;
+	copy->load_table = NULL;
+	copy->direct_path = false;
+	copy->queued_rows = 0;
+	copy->queued_operation = CMD_UNKNOWN;
+	/* modifications process one row at a time */
+	copy->fetch_memory = 0;
+	copy->pipeline_fetch = false;
+	copy->async_capable = false;
+	copy->use_remote_estimate = false;
+	copy->async_execution = false;
+	copy->executed = false;
+	copy->wait_fd = -1;
+	copy->parallel_workers = 0;
+	copy->parallel_slices = 0;
+	copy->pscan = NULL;
+	copy->pscan_local = false;
+	copy->slice = -1;
 
 	return copy;
 }
@@ -6070,6 +10098,7 @@ addParam(struct paramDesc **paramList, char *name, Oid pgtype, oraType oratype,
 	param->value = NULL;
 	param->node = NULL;
 	param->bindh = NULL;
+	param->values = NULL;
 	param->colnum = colnum;
 	param->next = *paramList;
 	*paramList = param;
@@ -6238,51 +10267,186 @@ setModifyParameters(struct paramDesc *paramList, TupleTableSlot *newslot, TupleT
 				/* detoast it if necessary */
 				datum = (Datum)PG_DETOAST_DATUM(datum);
 
-				value_len = VARSIZE(DatumGetPointer(datum)) - VARHDRSZ;
+				value_len = VARSIZE(DatumGetPointer(datum)) - VARHDRSZ;
+
+				/*
+				 * If the value is an empty string, treat it as NULL.
+				 * The main reason for that is that binding an SQLT_LVB with
+				 * an empty string (four zero bytes) causes an ORA-01459.
+				 * The other reason is that Oracle treats empty strings as
+				 * NULL values anyway, so we don't lose much.
+				 * What we do lose is that a CLOB or BLOB column can actually
+				 * contain an empty string, so we should insert it as such,
+				 * but that is enough of a corner case that we can ignore it.
+				 */
+				if (value_len == 0)
+				{
+					param->value = NULL;
+					break;
+				}
+
+				/* the first 4 bytes contain the length */
+				param->value = palloc(value_len + 4);
+				memcpy(param->value, (const char *)&value_len, 4);
+				memcpy(param->value + 4, VARDATA(DatumGetPointer(datum)), value_len);
+				break;
+			case BIND_GEOMETRY:
+				if (isnull)
+				{
+					param->value = (char *)oracleEWKBToGeom(session, 0, NULL);
+				}
+				else
+				{
+					/* detoast it if necessary */
+					datum = (Datum)PG_DETOAST_DATUM(datum);
+
+					/* will allocate objects in the Oracle object cache */
+					param->value = (char *)oracleEWKBToGeom(session,
+															VARSIZE(DatumGetPointer(datum)) - VARHDRSZ,
+															VARDATA(DatumGetPointer(datum)));
+				}
+				value_len = 0;  /* not used */
+				break;
+			case BIND_NUMBER_ARRAY:
+			case BIND_STRING_ARRAY:
+			case BIND_OUTPUT:
+				/* unreachable */
+				break;
+		}
+	}
+}
+
+/*
+ * canBatchModify
+ * 		Check if the rows of an UPDATE or DELETE can be collected and sent
+ * 		to Oracle in batches of "batch_size" rows.
+ * 		That is not possible if values have to be returned for a RETURNING
+ * 		clause or triggers, since the output parameters hold only one row.
+ * 		Since the last batch is sent at the end of execution, AFTER
+ * 		STATEMENT triggers would not see it, so they prevent batching too.
+ */
+bool
+canBatchModify(ResultRelInfo *rinfo)
+{
+	struct OracleFdwState *fdw_state = (struct OracleFdwState *)rinfo->ri_FdwState;
+	TriggerDesc *trigdesc = rinfo->ri_TrigDesc;
+	struct paramDesc *param;
+
+	if (fdw_state->batch_size <= 1
+		|| rinfo->ri_projectReturning != NULL
+		|| rinfo->ri_WithCheckOptions != NIL
+		|| (trigdesc != NULL
+			&& (trigdesc->trig_update_after_statement || trigdesc->trig_delete_after_statement)))
+		return false;
+
+	/* the same parameters as for INSERT (see oracleGetForeignModifyBatchSize) */
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		if (param->bindType == BIND_OUTPUT || param->bindType == BIND_GEOMETRY
+			|| param->bindType == BIND_LONG || param->bindType == BIND_LONGRAW)
+			return false;
+
+	return true;
+}
+
+/*
+ * queueModifyRow
+ * 		Store the parameter values for a row of a batched UPDATE or DELETE.
+ * 		The batch is sent to Oracle when it is full.
+ */
+void
+queueModifyRow(struct OracleFdwState *fdw_state, CmdType operation, TupleTableSlot *slot, TupleTableSlot *planSlot)
+{
+	struct paramDesc *param;
+	MemoryContext oldcontext;
+
+	/* the values are kept in temp_cxt until the batch is sent */
+	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
+
+	if (fdw_state->queued_rows == 0)
+		for (param=fdw_state->paramList; param!=NULL; param=param->next)
+			param->values = (char **)palloc(fdw_state->batch_size * sizeof(char *));
+
+	/* extract the values from the slot and collect them in the parameters */
+	setModifyParameters(fdw_state->paramList, slot, planSlot, fdw_state->oraTable, fdw_state->session);
+
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		param->values[fdw_state->queued_rows] = param->value;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	fdw_state->queued_operation = operation;
+	if (++fdw_state->queued_rows == fdw_state->batch_size)
+		flushModifyBatch(fdw_state);
+}
+
+/*
+ * flushModifyBatch
+ * 		Execute the UPDATE or DELETE statement for all queued rows at once
+ * 		and check that each row affected at most one Oracle row.
+ */
+void
+flushModifyBatch(struct OracleFdwState *fdw_state)
+{
+	struct paramDesc *param;
+	MemoryContext oldcontext;
+	unsigned int *row_counts, i;
+
+	if (fdw_state->queued_rows == 0)
+		return;
 
-				/*
-				 * If the value is an empty string, treat it as NULL.
-				 * The main reason for that is that binding an SQLT_LVB with
-				 * an empty string (four zero bytes) causes an ORA-01459.
-				 * The other reason is that Oracle treats empty strings as
-				 * NULL values anyway, so we don't lose much.
-				 * What we do lose is that a CLOB or BLOB column can actually
-				 * contain an empty string, so we should insert it as such,
-				 * but that is enough of a corner case that we can ignore it.
-				 */
-				if (value_len == 0)
-				{
-					param->value = NULL;
-					break;
-				}
+	oldcontext = MemoryContextSwitchTo(fdw_state->temp_cxt);
 
-				/* the first 4 bytes contain the length */
-				param->value = palloc(value_len + 4);
-				memcpy(param->value, (const char *)&value_len, 4);
-				memcpy(param->value + 4, VARDATA(DatumGetPointer(datum)), value_len);
-				break;
-			case BIND_GEOMETRY:
-				if (isnull)
-				{
-					param->value = (char *)oracleEWKBToGeom(session, 0, NULL);
-				}
-				else
-				{
-					/* detoast it if necessary */
-					datum = (Datum)PG_DETOAST_DATUM(datum);
+	row_counts = (unsigned int *)palloc(fdw_state->queued_rows * sizeof(unsigned int));
 
-					/* will allocate objects in the Oracle object cache */
-					param->value = (char *)oracleEWKBToGeom(session,
-															VARSIZE(DatumGetPointer(datum)) - VARHDRSZ,
-															VARDATA(DatumGetPointer(datum)));
-				}
-				value_len = 0;  /* not used */
-				break;
-			case BIND_OUTPUT:
-				/* unreachable */
-				break;
+	(void)oracleExecuteBatch(fdw_state->session, fdw_state->paramList, fdw_state->queued_rows, row_counts);
+
+	for (i=0; i<fdw_state->queued_rows; ++i)
+	{
+		if (row_counts[i] > 1)
+		{
+			if (fdw_state->queued_operation == CMD_UPDATE)
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+						errmsg("UPDATE on Oracle table changed %d rows instead of one in iteration %lu", row_counts[i], fdw_state->rowcount),
+						errhint("This probably means that you did not set the \"key\" option on all primary key columns.")));
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+						errmsg("DELETE on Oracle table removed %d rows instead of one in iteration %lu", row_counts[i], fdw_state->rowcount),
+						errhint("This probably means that you did not set the \"key\" option on all primary key columns.")));
 		}
+
+		if (row_counts[i] == 1)
+			++fdw_state->rowcount;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	for (param=fdw_state->paramList; param!=NULL; param=param->next)
+		param->values = NULL;
+	fdw_state->queued_rows = 0;
+
+	MemoryContextReset(fdw_state->temp_cxt);
+}
+
+/*
+ * appendOracleName
+ * 		Append an Oracle identifier in double quotes, for use inside
+ * 		an SQL string literal (single quotes are doubled).
+ */
+void
+appendOracleName(StringInfo buf, const char *name)
+{
+	const char *p;
+
+	appendStringInfoChar(buf, '"');
+	for (p=name; *p!='\0'; ++p)
+	{
+		if (*p == '\'')
+			appendStringInfoChar(buf, '\'');
+		appendStringInfoChar(buf, *p);
 	}
+	appendStringInfoChar(buf, '"');
 }
 
 bool
@@ -6352,6 +10516,141 @@ buildInsertQuery(StringInfo sql, struct OracleFdwState *fdwState)
 	appendStringInfo(sql, ")");
 }
 
+/*
+ * buildMergeQuery
+ * 		Build the statement for INSERT ... ON CONFLICT DO NOTHING:
+ * 		a MERGE that only inserts the row if no row with the same
+ * 		values in the "key" columns exists.
+ */
+void
+buildMergeQuery(StringInfo sql, struct OracleFdwState *fdwState)
+{
+	bool firstcol;
+	int i;
+	char paramName[10];
+
+	if (fdwState->oraTable->name[0] == '(')
+		ereport(ERROR,
+				(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+				errmsg("INSERT with ON CONFLICT clause is not supported on foreign table \"%s\"", fdwState->oraTable->pgname),
+				errdetail("The foreign table is defined on an Oracle query.")));
+
+	for (i=0; i<fdwState->oraTable->ncols; ++i)
+		if (fdwState->oraTable->cols[i]->used)
+			ereport(ERROR,
+					(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+					errmsg("INSERT with ON CONFLICT clause cannot return values from foreign table \"%s\"", fdwState->oraTable->pgname),
+					errdetail("RETURNING clauses and AFTER triggers are not supported with ON CONFLICT.")));
+
+	appendStringInfo(sql, "MERGE INTO %s t USING (SELECT ", fdwState->oraTable->name);
+
+	firstcol = true;
+	for (i = 0; i < fdwState->oraTable->ncols; ++i)
+	{
+		/* don't add columns beyond the end of the PostgreSQL table */
+		if (fdwState->oraTable->cols[i]->pgname == NULL)
+			continue;
+
+		/* check that the data types can be converted */
+		checkDataType(
+			fdwState->oraTable->cols[i]->oratype,
+			fdwState->oraTable->cols[i]->scale,
+			fdwState->oraTable->cols[i]->pgtype,
+			fdwState->oraTable->pgname,
+			fdwState->oraTable->cols[i]->pgname
+		);
+
+		/* LOB and LONG values cannot be selected from a bind variable (ORA-01461) */
+		switch (fdwState->oraTable->cols[i]->oratype)
+		{
+			case ORA_TYPE_LONG:
+			case ORA_TYPE_LONGRAW:
+			case ORA_TYPE_CLOB:
+			case ORA_TYPE_NCLOB:
+			case ORA_TYPE_BLOB:
+				ereport(ERROR,
+						(errcode(ERRCODE_FDW_INVALID_DATA_TYPE),
+						errmsg("INSERT with ON CONFLICT clause is not supported on foreign table \"%s\"", fdwState->oraTable->pgname),
+						errdetail("Column \"%s\" has a LOB, LONG or LONG RAW data type in Oracle.", fdwState->oraTable->cols[i]->pgname)));
+				break;
+			default:
+				break;
+		}
+
+		/* add a parameter description for the column */
+		snprintf(paramName, 9, ":p%.5d", fdwState->oraTable->cols[i]->pgattnum);
+		addParam(&fdwState->paramList, paramName, fdwState->oraTable->cols[i]->pgtype,
+			fdwState->oraTable->cols[i]->oratype, i);
+
+		/* add the parameter with the column name as alias */
+		if (firstcol)
+			firstcol = false;
+		else
+			appendStringInfo(sql, ", ");
+
+		appendAsType(sql, paramName, fdwState->oraTable->cols[i]->pgtype);
+		appendStringInfo(sql, " %s", fdwState->oraTable->cols[i]->name);
+	}
+
+	appendStringInfo(sql, " FROM dual) s ON (");
+
+	/* the primary key columns decide if there is a conflict */
+	firstcol = true;
+	for (i = 0; i < fdwState->oraTable->ncols; ++i)
+	{
+		if (! fdwState->oraTable->cols[i]->pkey)
+			continue;
+
+		if (firstcol)
+			firstcol = false;
+		else
+			appendStringInfo(sql, " AND ");
+
+		appendStringInfo(sql, "t.%s = s.%s",
+						 fdwState->oraTable->cols[i]->name,
+						 fdwState->oraTable->cols[i]->name);
+	}
+
+	/* throw a meaningful error if there is no key column */
+	if (firstcol)
+		ereport(ERROR,
+				(errcode(ERRCODE_FDW_UNABLE_TO_CREATE_EXECUTION),
+				errmsg("INSERT with ON CONFLICT clause requires a primary key on foreign table \"%s\"", fdwState->oraTable->pgname),
+				errhint("Set the option \"%s\" on the columns that belong to the primary key.", OPT_KEY)));
+
+	appendStringInfo(sql, ") WHEN NOT MATCHED THEN INSERT (");
+
+	firstcol = true;
+	for (i = 0; i < fdwState->oraTable->ncols; ++i)
+	{
+		if (fdwState->oraTable->cols[i]->pgname == NULL)
+			continue;
+
+		if (firstcol)
+			firstcol = false;
+		else
+			appendStringInfo(sql, ", ");
+		appendStringInfo(sql, "t.%s", fdwState->oraTable->cols[i]->name);
+	}
+
+	appendStringInfo(sql, ") VALUES (");
+
+	firstcol = true;
+	for (i = 0; i < fdwState->oraTable->ncols; ++i)
+	{
+		if (fdwState->oraTable->cols[i]->pgname == NULL)
+			continue;
+
+		if (firstcol)
+			firstcol = false;
+		else
+			appendStringInfo(sql, ", ");
+		appendStringInfo(sql, "s.%s", fdwState->oraTable->cols[i]->name);
+	}
+
+	appendStringInfo(sql, ")");
+}
+
 void
 buildUpdateQuery(StringInfo sql, struct OracleFdwState *fdwState, List *targetAttrs)
 {
@@ -6457,6 +10756,7 @@ appendReturningClause(StringInfo sql, struct OracleFdwState *fdwState)
 			param->value = (void *)42;  /* something != NULL */
 			param->node = NULL;
 			param->bindh = NULL;
+			param->values = NULL;
 			param->colnum = i;
 			param->next = fdwState->paramList;
 			fdwState->paramList = param;
@@ -6580,6 +10880,15 @@ setSelectParameters(struct paramDesc *paramList, ExprContext *econtext)
 	/* iterate parameter list and fill values */
 	for (param=paramList; param; param=param->next)
 	{
+		/* the SCN and slice of a parallel scan have been set by the caller */
+		if (strcmp(param->name, ":scn") == 0 || strcmp(param->name, ":slice") == 0)
+		{
+			appendStringInfo(&info, "%s%s=\"%s\"", (first_param ? ", parameters " : ", "),
+				param->name, param->value);
+			first_param = false;
+			continue;
+		}
+
 		if (strcmp(param->name, ":now") == 0)
 		{
 			/* get transaction start timestamp */
@@ -6601,56 +10910,224 @@ setSelectParameters(struct paramDesc *paramList, ExprContext *econtext)
 #endif  /* PG_VERSION_NUM */
 		}
 
-		if (is_null)
+		if (param->bindType == BIND_NUMBER_ARRAY || param->bindType == BIND_STRING_ARRAY)
+		{
+			/* a NULL array matches no rows, just like an empty one */
+			param->value = deparseArrayParam(is_null ? (Datum)0 : datum, is_null);
+		}
+		else if (is_null)
+		{
+			param->value = NULL;
+		}
+		else
+		{
+			if (param->type == DATEOID)
+				param->value = deparseDate(datum);
+			else if (param->type == TIMESTAMPOID || param->type == TIMESTAMPTZOID)
+				param->value = deparseTimestamp(datum, (param->type == TIMESTAMPTZOID));
+			else
+			{
+				regproc typoutput;
+
+				/* get the type's output function */
+				tuple = SearchSysCache1(TYPEOID, ObjectIdGetDatum(param->type));
+				if (!HeapTupleIsValid(tuple))
+				{
+					elog(ERROR, "cache lookup failed for type %u", param->type);
+				}
+				typoutput = ((Form_pg_type)GETSTRUCT(tuple))->typoutput;
+				ReleaseSysCache(tuple);
+
+				/* convert the parameter value into a string */
+				param->value = DatumGetCString(OidFunctionCall1(typoutput, datum));
+
+				/* strip hyphens from UUID values */
+				if (param->type == UUIDOID)
+					convertUUID(param->value);
+			}
+		}
+
+		/* build a parameter list for the DEBUG message */
+		if (param->bindType == BIND_NUMBER_ARRAY || param->bindType == BIND_STRING_ARRAY)
+		{
+			appendStringInfo(&info, "%s%s=(%d elements)", (first_param ? ", parameters " : ", "),
+				param->name, *((int32 *)param->value));
+			first_param = false;
+		}
+		else if (first_param)
+		{
+			first_param = false;
+			appendStringInfo(&info, ", parameters %s=\"%s\"", param->name,
+				(param->value ? param->value : "(null)"));
+		}
+		else
+		{
+			appendStringInfo(&info, ", %s=\"%s\"", param->name,
+				(param->value ? param->value : "(null)"));
+		}
+	}
+
+	/* reset memory context */
+	MemoryContextSwitchTo(oldcontext);
+
+	return info.data;
+}
+
+/*
+ * deparseArrayParam
+ * 		Render the value of an array parameter for oracleExecuteQuery.
+ * 		The first four bytes contain the number of elements, followed by
+ * 		the elements as zero-terminated strings.  NULL elements are
+ * 		rendered as empty strings, which Oracle considers NULL anyway.
+ */
+char *
+deparseArrayParam(Datum datum, bool is_null)
+{
+	StringInfoData result;
+	int32 count = 0;
+
+	initStringInfo(&result);
+	appendBinaryStringInfo(&result, (const char *)&count, 4);
+
+	if (!is_null)
+	{
+		ArrayType *arr = DatumGetArrayTypeP(datum);
+		ArrayIterator iterator;
+		Datum elem;
+		bool elem_null, isvarlena;
+		Oid typoutput;
+
+		getTypeOutputInfo(ARR_ELEMTYPE(arr), &typoutput, &isvarlena);
+
+		iterator = array_create_iterator(arr, 0);
+		while (array_iterate(iterator, &elem, &elem_null))
+		{
+			if (!elem_null)
+				appendStringInfoString(&result, OidOutputFunctionCall(typoutput, elem));
+			appendStringInfoChar(&result, '\0');
+			++count;
+		}
+		array_free_iterator(iterator);
+
+		/* store the number of elements */
+		memcpy(result.data, (const char *)&count, 4);
+	}
+
+	return result.data;
+}
+
+/*
+ * initConverters
+ * 		Compute the per-column conversion information used by convertTuple.
+ * 		This must be called before the first row is converted, so that the
+ * 		type input functions do not have to be looked up for each row.
+ */
+void
+initConverters(struct OracleFdwState *fdw_state)
+{
+	int i;
+
+	fdw_state->converters = (struct oraConverter *)palloc0(
+		sizeof(struct oraConverter) * (fdw_state->oraTable->ncols > 0 ? fdw_state->oraTable->ncols : 1));
+
+	for (i=0; i<fdw_state->oraTable->ncols; ++i)
+	{
+		struct oraColumn *col = fdw_state->oraTable->cols[i];
+		struct oraConverter *conv = &(fdw_state->converters[i]);
+		Oid typinput;
+
+		if (col->used == 0 || col->pgname == NULL)
+		{
+			conv->kind = CONV_NONE;
+			continue;
+		}
+
+		conv->is_lob = (col->oratype == ORA_TYPE_BLOB
+						|| col->oratype == ORA_TYPE_BFILE
+						|| col->oratype == ORA_TYPE_CLOB
+						|| col->oratype == ORA_TYPE_NCLOB);
+		conv->is_long = (col->oratype == ORA_TYPE_LONG
+						|| col->oratype == ORA_TYPE_LONGRAW);
+		conv->is_number = (col->oratype == ORA_TYPE_FLOAT
+						|| col->oratype == ORA_TYPE_NUMBER);
+		conv->is_interval_ds = (col->oratype == ORA_TYPE_INTERVALD2S);
+		conv->strip_zeros = col->strip_zeros;
+
+		if (col->oratype == ORA_TYPE_GEOMETRY)
 		{
-			param->value = NULL;
+			conv->kind = CONV_GEOMETRY;
+			continue;
 		}
-		else
+		else if (col->fetchtype == FETCH_NUMBER
+				&& (col->pgtype == INT2OID || col->pgtype == INT4OID || col->pgtype == INT8OID))
 		{
-			if (param->type == DATEOID)
-				param->value = deparseDate(datum);
-			else if (param->type == TIMESTAMPOID || param->type == TIMESTAMPTZOID)
-				param->value = deparseTimestamp(datum, (param->type == TIMESTAMPTZOID));
+			conv->kind = CONV_INTEGER;
+			continue;
+		}
+		else if (col->fetchtype == FETCH_NUMBER && col->pgtype == NUMERICOID)
+		{
+			conv->kind = CONV_NUMERIC;
+			conv->typmod = col->pgtypmod;
+			continue;
+		}
+		else if (col->fetchtype == FETCH_BFLOAT || col->fetchtype == FETCH_BDOUBLE)
+		{
+			conv->kind = (col->pgtype == FLOAT4OID) ? CONV_FLOAT4 : CONV_FLOAT8;
+			continue;
+		}
+		else if (col->fetchtype == FETCH_DATE
+				|| col->fetchtype == FETCH_TIMESTAMP
+				|| col->fetchtype == FETCH_TIMESTAMPTZ)
+		{
+			if (col->pgtype == DATEOID)
+				conv->kind = CONV_DATE;
+			else if (col->pgtype == TIMESTAMPOID)
+				conv->kind = CONV_TIMESTAMP;
 			else
-			{
-				regproc typoutput;
-
-				/* get the type's output function */
-				tuple = SearchSysCache1(TYPEOID, ObjectIdGetDatum(param->type));
-				if (!HeapTupleIsValid(tuple))
-				{
-					elog(ERROR, "cache lookup failed for type %u", param->type);
-				}
-				typoutput = ((Form_pg_type)GETSTRUCT(tuple))->typoutput;
-				ReleaseSysCache(tuple);
-
-				/* convert the parameter value into a string */
-				param->value = DatumGetCString(OidFunctionCall1(typoutput, datum));
-
-				/* strip hyphens from UUID values */
-				if (param->type == UUIDOID)
-					convertUUID(param->value);
-			}
+				conv->kind = CONV_TIMESTAMPTZ;
+			conv->typmod = col->pgtypmod;
+			continue;
 		}
-
-		/* build a parameter list for the DEBUG message */
-		if (first_param)
+		else if (col->fetchtype == FETCH_INTERVALYM || col->fetchtype == FETCH_INTERVALDS)
 		{
-			first_param = false;
-			appendStringInfo(&info, ", parameters %s=\"%s\"", param->name,
-				(param->value ? param->value : "(null)"));
+			conv->kind = CONV_INTERVAL;
+			conv->typmod = col->pgtypmod;
+			continue;
 		}
-		else
+		else if (col->pgtype == BYTEAOID)
 		{
-			appendStringInfo(&info, ", %s=\"%s\"", param->name,
-				(param->value ? param->value : "(null)"));
+			conv->kind = CONV_BYTEA;
+			continue;
 		}
-	}
+		else if (col->pgtype == BOOLOID)
+		{
+			conv->kind = CONV_BOOL;
+			continue;
+		}
+		else if (col->pgtype == BPCHAROID || col->pgtype == VARCHAROID || col->pgtype == TEXTOID)
+			conv->kind = CONV_STRING;
+		else
+			conv->kind = CONV_INPUT;
 
-	/* reset memory context */
-	MemoryContextSwitchTo(oldcontext);
+		/* find the appropriate conversion function */
+		getTypeInputInfo(col->pgtype, &typinput, &conv->typioparam);
+		fmgr_info(typinput, &conv->typinput);
 
-	return info.data;
+		/* only pass the type modifier to functions that have always received it */
+		switch (col->pgtype)
+		{
+			case BPCHAROID:
+			case VARCHAROID:
+			case TIMESTAMPOID:
+			case TIMESTAMPTZOID:
+			case INTERVALOID:
+			case NUMERICOID:
+				conv->typmod = col->pgtypmod;
+				break;
+			default:
+				conv->typmod = -1;
+		}
+	}
 }
 
 /*
@@ -6658,23 +11135,41 @@ setSelectParameters(struct paramDesc *paramList, ExprContext *econtext)
  * 		Convert a result row from Oracle stored in oraTable
  * 		into arrays of values and null indicators.
  * 		"index" is the (1 based) index into the array of results.
+ * 		initConverters must have been called before.
  */
 void
-convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values, bool *nulls)
+convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *tuple_values, bool *tuple_nulls)
 {
 	char *value = NULL, *oraval;
 	long value_len = 0;
 	int j, i = -1;
 	unsigned short oralen;
 	ErrorContextCallback errcb;
-	Oid pgtype;
+	struct oraColumn *col;
+	struct oraConverter *conv;
+	Datum *values = tuple_values;
+	bool *nulls = tuple_nulls;
+	int nattrs = fdw_state->oraTable->npgcols;
 
 	/* initialize error context callback, install it only during conversions */
 	errcb.callback = errorContextCallback;
 	errcb.arg = (void *)fdw_state;
 
+	/*
+	 * For whole-row references in a pushed down join, the columns of the
+	 * tables follow the result columns (see build_join_oratable).
+	 * Convert all of them into temporary arrays.
+	 */
+	if (fdw_state->oraTable->ncols > 0
+		&& fdw_state->oraTable->cols[fdw_state->oraTable->ncols - 1]->pgattnum > nattrs)
+	{
+		nattrs = fdw_state->oraTable->cols[fdw_state->oraTable->ncols - 1]->pgattnum;
+		values = (Datum *)palloc(sizeof(Datum) * nattrs);
+		nulls = (bool *)palloc(sizeof(bool) * nattrs);
+	}
+
 	/* assign result values */
-	for (j=0; j<fdw_state->oraTable->npgcols; ++j)
+	for (j=0; j<nattrs; ++j)
 	{
 		/* for dropped columns, insert a NULL */
 		if ((i + 1 < fdw_state->oraTable->ncols)
@@ -6694,8 +11189,8 @@ convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values
 		 * for all other types use the NULL indicator.
 		 */
 		if (i >= fdw_state->oraTable->ncols
-			|| fdw_state->oraTable->cols[i]->used == 0
-			|| (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_GEOMETRY
+			|| fdw_state->converters[i].kind == CONV_NONE
+			|| (fdw_state->converters[i].kind == CONV_GEOMETRY
 				&& ((ora_geometry *)fdw_state->oraTable->cols[i]->val)->geometry == NULL)
 			|| fdw_state->oraTable->cols[i]->val_null[index-1] == -1)
 		{
@@ -6706,27 +11201,24 @@ convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values
 
 		/* from here on, we can assume columns to be NOT NULL */
 		nulls[j] = false;
-		pgtype = fdw_state->oraTable->cols[i]->pgtype;
+		col = fdw_state->oraTable->cols[i];
+		conv = &(fdw_state->converters[i]);
 
 		/* calculate the offset into the arays in "val" and "val_len" */
-		oraval = fdw_state->oraTable->cols[i]->val +
-			(index - 1) * fdw_state->oraTable->cols[i]->val_size;
-		oralen = (fdw_state->oraTable->cols[i]->val_len)[index - 1];
+		oraval = col->val + (index - 1) * col->val_size;
+		oralen = (col->val_len)[index - 1];
 
 		/* get the data and its length */
-		if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_BLOB
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_BFILE
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_CLOB
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
+		if (conv->is_lob)
 		{
 			/* for LOBs, get the actual LOB contents (palloc'ed) */
 			oracleGetLob(fdw_state->session,
-				(void *)oraval, fdw_state->oraTable->cols[i]->oratype,
+				(void *)oraval, col->oratype,
 				&value, &value_len);
 		}
-		else if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_GEOMETRY)
+		else if (conv->kind == CONV_GEOMETRY)
 		{
-			ora_geometry *geom = (ora_geometry *)fdw_state->oraTable->cols[i]->val;
+			ora_geometry *geom = (ora_geometry *)col->val;
 
 			/* install error context callback */
 			errcb.previous = error_context_stack;
@@ -6740,8 +11232,7 @@ convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values
 
 			value = NULL;  /* we will fetch that later to avoid unnecessary copying */
 		}
-		else if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONG
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_LONGRAW)
+		else if (conv->is_long)
 		{
 			/* for LONG and LONG RAW, the first 4 bytes contain the length */
 			value_len = *((int32 *)oraval);
@@ -6750,15 +11241,20 @@ convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values
 			/* terminating zero byte (needed for LONGs) */
 			value[value_len] = '\0';
 		}
+		else if (col->fetchtype != FETCH_DEFAULT)
+		{
+			/* binary values are converted below */
+			value = oraval;
+			value_len = oralen;
+		}
 		else
 		{
 			/* special handling for NUMBER's "infinity tilde" */
-			if ((fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_FLOAT
-					|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_NUMBER)
+			if (conv->is_number
 				&& (oraval[0] == '~' || (oraval[0] == '-' && oraval[1] == '~')))
 			{
 				/* "numeric" does not know infinity, so map to NaN */
-				if (pgtype == NUMERICOID)
+				if (col->pgtype == NUMERICOID)
 					strcpy(oraval, "Nan");
 				else
 					strcpy(oraval, (oraval[0] == '-' ? "-inf" : "inf"));
@@ -6770,135 +11266,551 @@ convertTuple(struct OracleFdwState *fdw_state, unsigned int index, Datum *values
 		}
 
 		/* fill the TupleSlot with the data (after conversion if necessary) */
-		if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_GEOMETRY)
+		switch (conv->kind)
 		{
-			ora_geometry *geom = (ora_geometry *)fdw_state->oraTable->cols[i]->val;
-			struct varlena *result = NULL;
+			case CONV_GEOMETRY:
+				{
+					ora_geometry *geom = (ora_geometry *)col->val;
+					struct varlena *result = NULL;
 
-			/* install error context callback */
-			errcb.previous = error_context_stack;
-			error_context_stack = &errcb;
-			fdw_state->columnindex = i;
+					/* install error context callback */
+					errcb.previous = error_context_stack;
+					error_context_stack = &errcb;
+					fdw_state->columnindex = i;
 
-			result = (bytea *)palloc(value_len + VARHDRSZ);
-			oracleFillEWKB(fdw_state->session, geom, value_len, VARDATA(result));
-			SET_VARSIZE(result, value_len + VARHDRSZ);
+					result = (bytea *)palloc(value_len + VARHDRSZ);
+					oracleFillEWKB(fdw_state->session, geom, value_len, VARDATA(result));
+					SET_VARSIZE(result, value_len + VARHDRSZ);
 
-			/* uninstall error context callback */
-			error_context_stack = errcb.previous;
+					/* uninstall error context callback */
+					error_context_stack = errcb.previous;
 
-			values[j] = PointerGetDatum(result);
+					values[j] = PointerGetDatum(result);
 
-			/* free the storage for the object */
-			oracleGeometryFree(fdw_state->session, geom);
-		}
-		else if (pgtype == BYTEAOID)
-		{
-			/* binary columns are not converted */
-			bytea *result = (bytea *)palloc(value_len + VARHDRSZ);
-			memcpy(VARDATA(result), value, value_len);
-			SET_VARSIZE(result, value_len + VARHDRSZ);
+					/* free the storage for the object */
+					oracleGeometryFree(fdw_state->session, geom);
+				}
+				break;
+			case CONV_BYTEA:
+				{
+					/* binary columns are not converted */
+					bytea *result = (bytea *)palloc(value_len + VARHDRSZ);
+					memcpy(VARDATA(result), value, value_len);
+					SET_VARSIZE(result, value_len + VARHDRSZ);
 
-			values[j] = PointerGetDatum(result);
-		}
-		else if (pgtype == BOOLOID)
-			values[j] = BoolGetDatum(value[0] != '0' || value_len > 1);
-		else
-		{
-			regproc typinput;
-			HeapTuple tuple;
-			Datum dat;
+					values[j] = PointerGetDatum(result);
+				}
+				break;
+			case CONV_BOOL:
+				values[j] = BoolGetDatum(value[0] != '0' || value_len > 1);
+				break;
+			case CONV_INTEGER:
+				{
+					int64_t intval;
+					double dblval;
+					const char *typname = (col->pgtype == INT2OID) ? "smallint"
+						: ((col->pgtype == INT4OID) ? "integer" : "bigint");
 
-			/*
-			 * Negative INTERVAL DAY TO SECOND need some preprocessing:
-			 * In Oracle they are rendered like this: "-01 12:00:00.000000"
-			 * They have to be changed to "-01 -12:00:00.000000" for PostgreSQL.
-			 */
-			if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_INTERVALD2S
-				&& value[0] == '-')
-			{
-				char *newval = palloc(strlen(value) + 2);
-				char *pos = strchr(value, ' ');
+					/* install error context callback */
+					errcb.previous = error_context_stack;
+					error_context_stack = &errcb;
+					fdw_state->columnindex = i;
 
-				if (pos == NULL)
-					elog(ERROR, "no space in INTERVAL DAY TO SECOND");
-				strncpy(newval, value, pos - value + 1);
-				newval[pos - value + 1] = '\0';
-				strcat(newval, "-");
-				strcat(newval, pos + 1);
+					if (!oracleNumberToInt(fdw_state->session, value, &intval))
+					{
+						/* raise the same errors as the type input function would */
+						dblval = oracleNumberToDouble(fdw_state->session, value);
+
+						if (isinf(dblval) || dblval != rint(dblval))
+							ereport(ERROR,
+									(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+									 errmsg("invalid input syntax for type %s: \"%.*g\"",
+											typname, DBL_DIG, dblval)));
+						else
+							ereport(ERROR,
+									(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+									 errmsg("value \"%.*g\" is out of range for type %s",
+											DBL_DIG, dblval, typname)));
+					}
 
-				value = newval;
-			}
+					if ((col->pgtype == INT2OID && (int16)intval != intval)
+						|| (col->pgtype == INT4OID && (int32)intval != intval))
+						ereport(ERROR,
+								(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+								 errmsg("value \"" INT64_FORMAT "\" is out of range for type %s",
+										(int64)intval, typname)));
 
-			/* find the appropriate conversion function */
-			tuple = SearchSysCache1(TYPEOID, ObjectIdGetDatum(pgtype));
-			if (!HeapTupleIsValid(tuple))
-			{
-				elog(ERROR, "cache lookup failed for type %u", pgtype);
-			}
-			typinput = ((Form_pg_type)GETSTRUCT(tuple))->typinput;
-			ReleaseSysCache(tuple);
+					/* uninstall error context callback */
+					error_context_stack = errcb.previous;
 
-			dat = CStringGetDatum(value);
+					if (col->pgtype == INT2OID)
+						values[j] = Int16GetDatum((int16)intval);
+					else if (col->pgtype == INT4OID)
+						values[j] = Int32GetDatum((int32)intval);
+					else
+						values[j] = Int64GetDatum(intval);
+				}
+				break;
+			case CONV_NUMERIC:
+				/* install error context callback */
+				errcb.previous = error_context_stack;
+				error_context_stack = &errcb;
+				fdw_state->columnindex = i;
+
+				values[j] = numberToNumeric((unsigned char *)value);
+
+				/* apply the type modifier like numeric_in does */
+				if (conv->typmod >= (int32)VARHDRSZ)
+					values[j] = DirectFunctionCall2(numeric,
+						values[j],
+						Int32GetDatum(conv->typmod));
+
+				/* uninstall error context callback */
+				error_context_stack = errcb.previous;
+				break;
+			case CONV_FLOAT4:
+			case CONV_FLOAT8:
+				{
+					float8 dblval;
+					float4 fltval;
 
-			/* install error context callback */
-			errcb.previous = error_context_stack;
-			error_context_stack = &errcb;
-			fdw_state->columnindex = i;
+					if (col->fetchtype == FETCH_BFLOAT)
+					{
+						memcpy(&fltval, value, sizeof(float4));
+						dblval = (float8)fltval;
+					}
+					else
+					{
+						memcpy(&dblval, value, sizeof(float8));
+						fltval = (float4)dblval;
 
-			if (pgtype == BPCHAROID || pgtype == VARCHAROID || pgtype == TEXTOID)
-			{
-				/* optionally strip zero bytes from string types */
-				if (fdw_state->oraTable->cols[i]->strip_zeros)
+						/* check for overflow and underflow like float4in does */
+						if (conv->kind == CONV_FLOAT4
+							&& ((isinf(fltval) && !isinf(dblval))
+								|| (fltval == 0.0 && dblval != 0.0)))
+						{
+							/* install error context callback */
+							errcb.previous = error_context_stack;
+							error_context_stack = &errcb;
+							fdw_state->columnindex = i;
+
+							ereport(ERROR,
+									(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+									 errmsg("\"%.*g\" is out of range for type real",
+											DBL_DIG, dblval)));
+						}
+					}
+
+					if (conv->kind == CONV_FLOAT4)
+						values[j] = Float4GetDatum(fltval);
+					else
+						values[j] = Float8GetDatum(dblval);
+				}
+				break;
+			case CONV_DATE:
+			case CONV_TIMESTAMP:
+			case CONV_TIMESTAMPTZ:
 				{
-					char *from_p, *to_p = value;
-					long new_length = value_len;
+					struct pg_tm tm;
+					fsec_t fsec;
+					int tz = 0;
+					Timestamp ts;
+
+					/* install error context callback */
+					errcb.previous = error_context_stack;
+					error_context_stack = &errcb;
+					fdw_state->columnindex = i;
+
+					/* like the type input functions, ignore the time zone unless the result is timestamptz */
+					if (!getDateTime(fdw_state->session, col->fetchtype, value, &tm, &fsec, &tz)
+						&& conv->kind == CONV_TIMESTAMPTZ)
+						tz = DetermineTimeZoneOffset(&tm, session_timezone);
+
+					if (conv->kind == CONV_DATE)
+						values[j] = DateADTGetDatum(date2j(tm.tm_year, tm.tm_mon, tm.tm_mday) - POSTGRES_EPOCH_JDATE);
+					else
+					{
+						if (tm2timestamp(&tm, fsec, (conv->kind == CONV_TIMESTAMPTZ) ? &tz : NULL, &ts) != 0)
+							ereport(ERROR,
+									(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+									 errmsg("timestamp out of range")));
 
-					for (from_p = value; from_p < value + value_len; ++from_p)
-						if (*from_p != '\0')
-							*to_p++ = *from_p;
+						if (conv->kind == CONV_TIMESTAMP)
+						{
+							values[j] = TimestampGetDatum(ts);
+							if (conv->typmod >= 0)
+								values[j] = DirectFunctionCall2(timestamp_scale,
+									values[j],
+									Int32GetDatum(conv->typmod));
+						}
 						else
-							--new_length;
+						{
+							values[j] = TimestampTzGetDatum((TimestampTz)ts);
+							if (conv->typmod >= 0)
+								values[j] = DirectFunctionCall2(timestamptz_scale,
+									values[j],
+									Int32GetDatum(conv->typmod));
+						}
+					}
 
-					value_len = new_length;
-					value[value_len] = '\0';
+					/* uninstall error context callback */
+					error_context_stack = errcb.previous;
 				}
+				break;
+			case CONV_INTERVAL:
+				{
+					Interval *result = (Interval *)palloc(sizeof(Interval));
 
-				/* check that the string types are in the database encoding */
-				(void)pg_verify_mbstr(GetDatabaseEncoding(), value, value_len, false);
-			}
+					/* install error context callback */
+					errcb.previous = error_context_stack;
+					error_context_stack = &errcb;
+					fdw_state->columnindex = i;
 
-			/* call the type input function */
-			switch (pgtype)
-			{
-				case BPCHAROID:
-				case VARCHAROID:
-				case TIMESTAMPOID:
-				case TIMESTAMPTZOID:
-				case INTERVALOID:
-				case NUMERICOID:
-					/* these functions require the type modifier */
-					values[j] = OidFunctionCall3(typinput,
-						dat,
-						ObjectIdGetDatum(InvalidOid),
-						Int32GetDatum(fdw_state->oraTable->cols[i]->pgtypmod));
-					break;
-				default:
-					/* the others don't */
-					values[j] = OidFunctionCall1(typinput, dat);
-			}
+					if (col->fetchtype == FETCH_INTERVALYM)
+					{
+						int years, months;
+
+						oracleGetIntervalYM(fdw_state->session, value, &years, &months);
+
+						/* Oracle allows up to 999999999 years */
+						if (pg_mul_s32_overflow(years, MONTHS_PER_YEAR, &result->month)
+							|| pg_add_s32_overflow(result->month, months, &result->month))
+							ereport(ERROR,
+									(errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+									 errmsg("interval out of range")));
+						result->day = 0;
+						result->time = 0;
+					}
+					else
+					{
+						int days, hours, minutes, seconds, nsec;
 
-			/* uninstall error context callback */
-			error_context_stack = errcb.previous;
+						/* all parts have the sign of the interval */
+						oracleGetIntervalDS(fdw_state->session, value,
+							&days, &hours, &minutes, &seconds, &nsec);
+
+						result->month = 0;
+						result->day = days;
+						result->time = (((int64)hours * MINS_PER_HOUR + minutes) * SECS_PER_MINUTE + seconds)
+										* USECS_PER_SEC
+										+ (nsec >= 0 ? (nsec + 500) / 1000 : (nsec - 500) / 1000);
+					}
+
+					values[j] = IntervalPGetDatum(result);
+					if (conv->typmod >= 0)
+						values[j] = DirectFunctionCall2(interval_scale,
+							values[j],
+							Int32GetDatum(conv->typmod));
+
+					/* uninstall error context callback */
+					error_context_stack = errcb.previous;
+				}
+				break;
+			default:
+				/*
+				 * Negative INTERVAL DAY TO SECOND need some preprocessing:
+				 * In Oracle they are rendered like this: "-01 12:00:00.000000"
+				 * They have to be changed to "-01 -12:00:00.000000" for PostgreSQL.
+				 */
+				if (conv->is_interval_ds && value[0] == '-')
+				{
+					char *newval = palloc(strlen(value) + 2);
+					char *pos = strchr(value, ' ');
+
+					if (pos == NULL)
+						elog(ERROR, "no space in INTERVAL DAY TO SECOND");
+					strncpy(newval, value, pos - value + 1);
+					newval[pos - value + 1] = '\0';
+					strcat(newval, "-");
+					strcat(newval, pos + 1);
+
+					value = newval;
+				}
+
+				/* install error context callback */
+				errcb.previous = error_context_stack;
+				error_context_stack = &errcb;
+				fdw_state->columnindex = i;
+
+				if (conv->kind == CONV_STRING)
+				{
+					/* optionally strip zero bytes from string types */
+					if (conv->strip_zeros)
+					{
+						char *from_p, *to_p = value;
+						long new_length = value_len;
+
+						for (from_p = value; from_p < value + value_len; ++from_p)
+							if (*from_p != '\0')
+								*to_p++ = *from_p;
+							else
+								--new_length;
+
+						value_len = new_length;
+						value[value_len] = '\0';
+					}
+
+					/* check that the string types are in the database encoding */
+					(void)pg_verify_mbstr(GetDatabaseEncoding(), value, value_len, false);
+				}
+
+				/* call the type input function */
+				values[j] = FunctionCall3(&conv->typinput,
+					CStringGetDatum(value),
+					ObjectIdGetDatum(conv->typioparam),
+					Int32GetDatum(conv->typmod));
+
+				/* uninstall error context callback */
+				error_context_stack = errcb.previous;
 		}
 
 		/* free the data buffer for LOBs */
-		if (fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_BLOB
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_BFILE
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_CLOB
-				|| fdw_state->oraTable->cols[i]->oratype == ORA_TYPE_NCLOB)
+		if (conv->is_lob)
 			pfree(value);
 	}
+
+	if (values != tuple_values)
+		buildWholeRows(fdw_state, values, nulls, tuple_values, tuple_nulls);
+}
+
+/*
+ * buildWholeRows
+ * 		Copy the result columns of a pushed down join from "values" and
+ * 		"nulls" to "tuple_values" and "tuple_nulls" and form the values
+ * 		of whole-row references from the table columns that follow.
+ * 		A whole-row reference is an unused column with a row type.
+ * 		The table columns are followed by a marker that is NULL if the
+ * 		row is missing on the nullable side of an outer join.
+ */
+void
+buildWholeRows(struct OracleFdwState *fdw_state, Datum *values, bool *nulls, Datum *tuple_values, bool *tuple_nulls)
+{
+	int i, k, next = fdw_state->oraTable->npgcols;
+
+	for (i=0; i<fdw_state->oraTable->npgcols; ++i)
+	{
+		struct oraColumn *col = fdw_state->oraTable->cols[i];
+		TupleDesc tupdesc;
+		Datum *rowvalues;
+		bool *rownulls;
+
+		tuple_values[i] = values[i];
+		tuple_nulls[i] = nulls[i];
+
+		if (col->used || !OidIsValid(col->pgtype) || !type_is_rowtype(col->pgtype))
+			continue;
+
+		tupdesc = lookup_rowtype_tupdesc(col->pgtype, -1);
+		rowvalues = (Datum *)palloc(sizeof(Datum) * tupdesc->natts);
+		rownulls = (bool *)palloc(sizeof(bool) * tupdesc->natts);
+
+		/* the table columns are in the order of the row type's attributes */
+		for (k=0; k<tupdesc->natts; ++k)
+		{
+			if (TupleDescAttr(tupdesc, k)->attisdropped)
+			{
+				rowvalues[k] = PointerGetDatum(NULL);
+				rownulls[k] = true;
+				continue;
+			}
+
+			rowvalues[k] = values[next];
+			rownulls[k] = nulls[next];
+			++next;
+		}
+
+		/* the marker for the ROWID */
+		if (!nulls[next++])
+		{
+			tuple_values[i] = HeapTupleGetDatum(heap_form_tuple(tupdesc, rowvalues, rownulls));
+			tuple_nulls[i] = false;
+		}
+
+		ReleaseTupleDesc(tupdesc);
+	}
+}
+
+/*
+ * getDateTime
+ * 		Extract the fields of a DATE or TIMESTAMP value that was fetched
+ * 		in binary form into "tm" and "fsec".
+ * 		If the value has a time zone, store its offset in PostgreSQL's
+ * 		convention (seconds west of UTC) in "tz" and return true.
+ */
+bool
+getDateTime(oracleSession *session, oraFetchType fetchtype, char *value, struct pg_tm *tm, fsec_t *fsec, int *tz)
+{
+	int year, nsec, offset;
+
+	memset(tm, 0, sizeof(struct pg_tm));
+
+	if (fetchtype == FETCH_DATE)
+	{
+		unsigned char *dat = (unsigned char *)value;
+
+		/* century and year are stored excess 100, the time fields excess 1 */
+		year = ((int)dat[0] - 100) * 100 + ((int)dat[1] - 100);
+		tm->tm_mon = dat[2];
+		tm->tm_mday = dat[3];
+		tm->tm_hour = dat[4] - 1;
+		tm->tm_min = dat[5] - 1;
+		tm->tm_sec = dat[6] - 1;
+		*fsec = 0;
+	}
+	else
+	{
+		oracleGetDateTime(session, value, (fetchtype == FETCH_TIMESTAMPTZ),
+			&year, &tm->tm_mon, &tm->tm_mday,
+			&tm->tm_hour, &tm->tm_min, &tm->tm_sec,
+			&nsec, &offset);
+
+		/* PostgreSQL has microsecond precision */
+		*fsec = (nsec + 500) / 1000;
+	}
+
+	/* Oracle has no year 0, PostgreSQL counts 1 BC as year 0 */
+	tm->tm_year = (year < 0) ? year + 1 : year;
+
+	if (fetchtype != FETCH_TIMESTAMPTZ)
+		return false;
+
+	*tz = -offset;
+	return true;
+}
+
+/*
+ * Constants from the on-disk format of "numeric", see
+ * src/backend/utils/adt/numeric.c in the PostgreSQL source.
+ */
+#define ORA_NUMERIC_SHORT                0x8000
+#define ORA_NUMERIC_NAN                  0xC000
+#define ORA_NUMERIC_NEG                  0x4000
+#define ORA_NUMERIC_SHORT_SIGN_MASK      0x2000
+#define ORA_NUMERIC_SHORT_DSCALE_SHIFT   7
+#define ORA_NUMERIC_SHORT_DSCALE_MAX     0x003F
+#define ORA_NUMERIC_SHORT_WEIGHT_SIGN_MASK 0x0040
+#define ORA_NUMERIC_SHORT_WEIGHT_MASK    0x003F
+#define ORA_NUMERIC_SHORT_WEIGHT_MAX     ORA_NUMERIC_SHORT_WEIGHT_MASK
+#define ORA_NUMERIC_SHORT_WEIGHT_MIN     (-(ORA_NUMERIC_SHORT_WEIGHT_MASK+1))
+#define ORA_NUMERIC_DSCALE_MASK          0x3FFF
+
+/*
+ * numberToNumeric
+ * 		Convert an Oracle NUMBER in OCINumber format to a "numeric" Datum.
+ * 		The first byte of an OCINumber is the length of the rest.
+ * 		The next byte contains the sign and the exponent (base 100),
+ * 		followed by the mantissa digits in base 100.  For positive numbers,
+ * 		digits are stored as value + 1, for negative numbers as 101 - value,
+ * 		and the exponent byte is complemented.
+ * 		The base 100 digits are combined into base 10000 digits,
+ * 		and the "numeric" is constructed the same way as make_result() does.
+ * 		The display scale is the number of significant decimal digits after
+ * 		the decimal point, which is what numeric_in() would produce from
+ * 		the string that Oracle renders for the number.
+ */
+Datum
+numberToNumeric(const unsigned char *number)
+{
+	int len = number[0], ndigits100, ndigits, exponent, weight, dscale, i, last_exp;
+	bool negative;
+	int16 digits[(ORA_NUMBER_SIZE + 1) / 2 + 1];
+	char *result;
+	Size size;
+
+	/* zero */
+	if (len == 1 && number[1] == 0x80)
+	{
+		ndigits = 0;
+		weight = 0;
+		dscale = 0;
+		negative = false;
+	}
+	/* infinity cannot be represented by "numeric", so map it to NaN */
+	else if ((len == 1 && number[1] == 0x00)
+			|| (len == 2 && number[1] == 0xFF && number[2] == 101))
+	{
+		result = palloc(VARHDRSZ + sizeof(uint16));
+		SET_VARSIZE(result, VARHDRSZ + sizeof(uint16));
+		*((uint16 *)(result + VARHDRSZ)) = ORA_NUMERIC_NAN;
+
+		return PointerGetDatum(result);
+	}
+	else
+	{
+		negative = ((number[1] & 0x80) == 0);
+		ndigits100 = len - 1;
+
+		if (negative)
+		{
+			exponent = (int)((~number[1]) & 0xFF) - 0xC1;
+			/* negative numbers with less than 20 digits have a terminating byte 102 */
+			if (number[len] == 102)
+				--ndigits100;
+		}
+		else
+			exponent = (int)number[1] - 0xC1;
+
+		/* the base 100 exponent of the last digit */
+		last_exp = exponent - ndigits100 + 1;
+
+		/* "weight" is the base 10000 exponent of the first digit (rounded down) */
+		weight = (exponent >= 0) ? exponent / 2 : -((1 - exponent) / 2);
+		ndigits = weight - ((last_exp >= 0) ? last_exp / 2 : -((1 - last_exp) / 2)) + 1;
+
+		memset(digits, 0, sizeof(digits));
+		for (i=0; i<ndigits100; ++i)
+		{
+			int digit = negative ? 101 - number[i + 2] : number[i + 2] - 1;
+			int exp100 = exponent - i;
+			int exp10000 = (exp100 >= 0) ? exp100 / 2 : -((1 - exp100) / 2);
+
+			digits[weight - exp10000] += (exp100 - 2 * exp10000) ? digit * 100 : digit;
+		}
+
+		/* number of decimal digits after the decimal point, without trailing zeros */
+		if (last_exp >= 0)
+			dscale = 0;
+		else
+		{
+			int lastdigit = negative ? 101 - number[ndigits100 + 1] : number[ndigits100 + 1] - 1;
+
+			dscale = -2 * last_exp - ((lastdigit % 10 == 0) ? 1 : 0);
+		}
+	}
+
+	/* construct the result, preferring the short format */
+	if (dscale <= ORA_NUMERIC_SHORT_DSCALE_MAX
+		&& weight <= ORA_NUMERIC_SHORT_WEIGHT_MAX
+		&& weight >= ORA_NUMERIC_SHORT_WEIGHT_MIN)
+	{
+		uint16 header = ORA_NUMERIC_SHORT;
+
+		if (negative)
+			header |= ORA_NUMERIC_SHORT_SIGN_MASK;
+		header |= (uint16)(dscale << ORA_NUMERIC_SHORT_DSCALE_SHIFT);
+		if (weight < 0)
+			header |= ORA_NUMERIC_SHORT_WEIGHT_SIGN_MASK;
+		header |= (uint16)(weight & ORA_NUMERIC_SHORT_WEIGHT_MASK);
+
+		size = VARHDRSZ + sizeof(uint16) + ndigits * sizeof(int16);
+		result = palloc(size);
+		*((uint16 *)(result + VARHDRSZ)) = header;
+		memcpy(result + VARHDRSZ + sizeof(uint16), digits, ndigits * sizeof(int16));
+	}
+	else
+	{
+		uint16 sign_dscale = (negative ? ORA_NUMERIC_NEG : 0) | (dscale & ORA_NUMERIC_DSCALE_MASK);
+		int16 n_weight = (int16)weight;
+
+		size = VARHDRSZ + sizeof(uint16) + sizeof(int16) + ndigits * sizeof(int16);
+		result = palloc(size);
+		*((uint16 *)(result + VARHDRSZ)) = sign_dscale;
+		*((int16 *)(result + VARHDRSZ + sizeof(uint16))) = n_weight;
+		memcpy(result + VARHDRSZ + sizeof(uint16) + sizeof(int16), digits, ndigits * sizeof(int16));
+	}
+	SET_VARSIZE(result, size);
+
+	return PointerGetDatum(result);
 }
 
 /*
@@ -7323,6 +12235,19 @@ oracleDebug2(const char *message)
 	elog(DEBUG2, "%s", message);
 }
 
+/*
+ * oracleSleep
+ * 		Wait for the given number of microseconds while polling the
+ * 		Oracle server, allowing the user to interrupt the query.
+ */
+void
+oracleSleep(long microsec)
+{
+	CHECK_FOR_INTERRUPTS();
+
+	pg_usleep(microsec);
+}
+
 /*
  * initializePostGIS
  * 		Checks if PostGIS is installed and sets GEOMETRYOID if it is.
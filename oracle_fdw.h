@@ -30,11 +30,25 @@ struct connEntry
 	OCISvcCtx *svchp;
 	OCISession *userhp;
 	OCIType *geomtype;
+	OCIType *numlisttype;  /* SYS.ODCINUMBERLIST for array parameters */
+	OCIType *strlisttype;  /* SYS.ODCIVARCHAR2LIST for array parameters */
 	struct stmtHandleEntry *stmtlist;
+	struct dirPathEntry *dirpath;  /* direct path load in progress, else NULL */
 	int xact_level;  /* 0 = none, 1 = main, else subtransaction */
 	struct connEntry *next;
 };
 
+/* handles of a direct path load */
+struct dirPathEntry
+{
+	OCIDirPathCtx *dpctx;
+	OCIDirPathColArray *dpca;
+	OCIDirPathStream *dpstr;
+	ub4 max_rows;  /* number of rows in the column array */
+	ub4 rows;      /* rows currently stored in the column array */
+	int xact_level;  /* transaction level at which the load was started */
+};
+
 struct srvEntry
 {
 	char *connectstring;
@@ -42,6 +56,7 @@ struct srvEntry
 	struct srvEntry *next;
 	struct connEntry *connlist;
 	int server_version[5];
+	struct stmtHandleEntry *pending_fetch;  /* statement with a non-blocking fetch in progress */
 };
 
 struct envEntry
@@ -70,6 +85,11 @@ struct oracleSession
 	unsigned int last_batch;   /* got OCI_NO_DATA */
 	unsigned int fetched_rows;
 	unsigned int current_row;  /* first row is 1 */
+	unsigned int buffer_rows;  /* rows per result buffer with double buffering, else 0 */
+	unsigned int buffer;       /* result buffer with the current rows (0 or 1) */
+	const struct oraTable *oraTable;  /* result columns for double buffering */
+	OCIDefine **defines;       /* define handles of the result columns */
+	unsigned int async;        /* execute the query without waiting for the result */
 };
 #endif
 typedef struct oracleSession oracleSession;
@@ -108,12 +128,42 @@ typedef enum
 #define UUIDOID 2950
 #endif
 
+/* type OIDs needed in oracle_utils.c, which cannot include catalog headers */
+#ifndef DATEOID
+#define DATEOID 1082
+#endif
+#ifndef TIMESTAMPOID
+#define TIMESTAMPOID 1114
+#endif
+#ifndef TIMESTAMPTZOID
+#define TIMESTAMPTZOID 1184
+#endif
+
 /* PostgreSQL before 9.6 doesn't have this macro */
 #ifndef ALLOCSET_SMALL_SIZES
 #define ALLOCSET_SMALL_SIZES \
 ALLOCSET_SMALL_MINSIZE, ALLOCSET_SMALL_INITSIZE, ALLOCSET_SMALL_MAXSIZE
 #endif
 
+/* formats in which result values can be stored in oraColumn->val */
+typedef enum
+{
+	FETCH_DEFAULT,  /* Oracle's native format for binary types and LOBs, else a string */
+	FETCH_NUMBER,   /* OCINumber */
+	FETCH_BFLOAT,   /* binary float */
+	FETCH_BDOUBLE,  /* binary double */
+	FETCH_DATE,     /* 7-byte Oracle DATE */
+	FETCH_TIMESTAMP,    /* OCIDateTime descriptor for TIMESTAMP */
+	FETCH_TIMESTAMPTZ,  /* OCIDateTime descriptor for TIMESTAMP WITH TIME ZONE */
+	FETCH_INTERVALYM,   /* OCIInterval descriptor for INTERVAL YEAR TO MONTH */
+	FETCH_INTERVALDS    /* OCIInterval descriptor for INTERVAL DAY TO SECOND */
+} oraFetchType;
+
+/* size of an OCINumber (OCI_NUMBER_SIZE) */
+#define ORA_NUMBER_SIZE 22
+/* size of an Oracle DATE in SQLT_DAT format */
+#define ORA_DATE_SIZE 7
+
 struct oraColumn
 {
 	char *name;         /* name in Oracle */
@@ -126,6 +176,7 @@ struct oraColumn
 	int used;           /* is the column used in the query? */
 	int strip_zeros;    /* should ASCII zero be removed from Oracle strings? */
 	int pkey;           /* nonzero for primary keys, later set to the resjunk attribute number */
+	oraFetchType fetchtype;  /* format in which values are stored in val */
 	char *val;          /* buffer for Oracle to return results in (LOB locators for LOBs) */
 	int32_t val_size;   /* allocated size of one element in val */
 	uint16_t *val_len;  /* array of actual lengths of val */
@@ -151,6 +202,8 @@ typedef enum {
 	BIND_LONG,
 	BIND_LONGRAW,
 	BIND_GEOMETRY,
+	BIND_NUMBER_ARRAY,
+	BIND_STRING_ARRAY,
 	BIND_OUTPUT
 } oraBindType;
 
@@ -160,6 +213,7 @@ struct paramDesc
 	Oid type;              /* PostgreSQL data type */
 	oraBindType bindType;  /* which type to use for binding to Oracle statement */
 	char *value;           /* value rendered for Oracle */
+	char **values;         /* values for all rows of a batch, else NULL */
 	void *node;            /* the executable expression */
 	int colnum;            /* corresponding column in oraTable (-1 in SELECT queries unless output column) */
 	void *bindh;           /* bind handle */
@@ -203,6 +257,14 @@ typedef enum
 	ORA_TRANS_SERIALIZABLE
 } oraIsoLevel;
 
+/* how the rows of a query are fetched */
+typedef enum
+{
+	PIPELINE_OFF,    /* fetch a batch of rows when it is needed */
+	PIPELINE_FETCH,  /* fetch the next batch while the current one is processed */
+	PIPELINE_ASYNC   /* like PIPELINE_FETCH, but don't wait for query execution */
+} oraPipeline;
+
 /*
  * functions defined in oracle_utils.c
  */
@@ -213,18 +275,34 @@ extern void oracleShutdown(void);
 extern void oracleCancel(void);
 extern void oracleEndTransaction(void *arg, int is_commit, int silent);
 extern void oracleEndSubtransaction(void *arg, int nest_level, int is_commit);
+extern void oracleResetStatement(oracleSession *session);
 extern int oracleIsStatementOpen(oracleSession *session);
 extern struct oraTable *oracleDescribe(oracleSession *session, char *dblink, char *schema, char *table, char *pgname, long max_long, int *has_geometry);
 extern void oracleExplain(oracleSession *session, const char *query, int *nrows, char ***plan);
-extern void oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTable *oraTable, unsigned int prefetch, unsigned int lob_prefetch);
+extern void oracleEstimate(oracleSession *session, const char *query, double *rows, int *width, double *cost);
+extern void oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTable *oraTable, unsigned int prefetch, unsigned int lob_prefetch, oraPipeline pipeline);
 extern unsigned int oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, struct paramDesc *paramList, unsigned int prefetch);
+extern unsigned int oracleExecuteBatch(oracleSession *session, struct paramDesc *paramList, unsigned int rows, unsigned int *row_counts);
+extern void oracleDirectPathBegin(oracleSession *session, const char *schema, const char *table, const struct oraTable *oraTable, struct paramDesc *paramList);
+extern unsigned int oracleDirectPathLoad(oracleSession *session, struct paramDesc *paramList);
+extern unsigned int oracleDirectPathFinish(oracleSession *session);
 extern unsigned int oracleFetchNext(oracleSession *session, unsigned int prefetch);
+extern int oracleFetchReady(oracleSession *session, unsigned int prefetch);
 extern void oracleExecuteCall(oracleSession *session, char * const stmt);
 extern void oracleGetLob(oracleSession *session, void *locptr, oraType type, char **value, long *value_len);
 extern void oracleClientVersion(int *major, int *minor, int *update, int *patch, int *port_patch);
 extern void oracleServerVersion(oracleSession *session, int *major, int *minor, int *update, int *patch, int *port_patch);
+extern void oracleGetSCN(oracleSession *session, char *scn);
 extern void *oracleGetGeometryType(oracleSession *session);
+extern int oracleNumberToInt(oracleSession *session, const void *number, int64_t *result);
+extern double oracleNumberToDouble(oracleSession *session, const void *number);
+extern void oracleGetDateTime(oracleSession *session, void *dtptr, int has_tz, int *year, int *month, int *day, int *hour, int *minute, int *second, int *nsec, int *tz_offset);
+extern void oracleGetIntervalYM(oracleSession *session, void *intvptr, int *years, int *months);
+extern void oracleGetIntervalDS(oracleSession *session, void *intvptr, int *days, int *hours, int *minutes, int *seconds, int *nsec);
 extern int oracleGetImportColumn(oracleSession *session, char *dblink, char *schema, char *limit_to, char **tabname, char **colname, oraType *type, int *charlen, int *typeprec, int *typescale, int *nullable, int *key, int skip_tables, int skip_views, int skip_matviews);
+extern int oracleGetTableStatistics(oracleSession *session, char *schema, char *table, double *num_rows);
+extern int oracleGetColumnStatistics(oracleSession *session, char *schema, char *table, char *column, double *num_distinct, double *num_nulls, int *avg_col_len, double *sample_size, int *frequency);
+extern int oracleGetHistogram(oracleSession *session, char *schema, char *table, char *column, oraType type, double *endpoint, char **value);
 
 /*
  * functions defined in oracle_fdw.c
@@ -243,6 +321,7 @@ extern void oracleError_ii(oraError sqlstate, const char *message, int arg1, int
 extern void oracleError_i(oraError sqlstate, const char *message, int arg);
 extern void oracleError(oraError sqlstate, const char *message);
 extern void oracleDebug2(const char *message);
+extern void oracleSleep(long microsec);
 extern void initializePostGIS(void);
 
 /*
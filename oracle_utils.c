@@ -35,6 +35,9 @@
 /* number of bytes to read per LOB chunk */
 #define LOB_CHUNK_SIZE 65536
 
+/* number of statements kept in the OCI statement cache of a connection */
+#define STMT_CACHE_SIZE 50
+
 /* emit no error messages when set, used for shutdown */
 static int silent = 0;
 
@@ -51,12 +54,13 @@ static int readonly = 0;
 
 /*
  * Linked list of open Oracle statement handles.
- * Each of these has a linked list of LOB locators.
+ * Each of these has a linked list of LOB locators and other descriptors.
  */
 
 struct lobLocatorEntry
 {
-	OCILobLocator *lobloc;
+	void *lobloc;
+	ub4 dtype;  /* descriptor type, OCI_DTYPE_LOB for LOB locators */
 	struct lobLocatorEntry *next;
 };
 
@@ -65,6 +69,17 @@ struct stmtHandleEntry
 	OCIStmt *stmthp;
 	struct lobLocatorEntry *loclist;
 	struct stmtHandleEntry *next;
+	/* state of a non-blocking fetch for double buffering */
+	struct srvEntry *fetch_srvp;  /* server connection while the fetch is running */
+	OCISvcCtx *exec_svchp;        /* service context if the statement is being executed */
+	ub4 fetch_rows;               /* number of rows requested */
+	unsigned int rows_fetched;    /* number of rows received */
+	int no_data;                  /* the fetch returned OCI_NO_DATA */
+	/* parameters of a non-blocking execute, freed when it is done */
+	OCIEnv *exec_envhp;           /* environment of the collections */
+	sb2 *exec_indicators;         /* indicators bound to the parameters */
+	OCIColl **exec_collections;   /* collections bound to array parameters */
+	int exec_params;              /* number of entries in exec_collections */
 };
 
 /*
@@ -84,6 +99,7 @@ static void getServerVersion(struct srvEntry *srvp, OCIError *errhp);
 static void oracleSetSavepoint(oracleSession *session, int nest_level);
 static void setOracleEnvironment(char *nls_lang, char *timezone);
 static OCIStmt *oracleQueryPlan(oracleSession *session, const char *query, const char *desc_query, int nres, dvoid **res, sb4 *res_size, ub2 *res_type, ub2 *res_len, sb2 *res_ind);
+static sword oracleStatisticsQuery(oracleSession *session, OCIStmt **stmthp, const char *query, char *schema, char *table, char *column, int nres, dvoid **res, sb4 *res_size, ub2 *res_type, ub2 *res_len, sb2 *res_ind);
 static sword checkerr(sword status, dvoid *handle, ub4 handleType);
 static char *copyOraText(const char *string, int size, int quote);
 static void closeSession(OCIEnv *envhp, OCIServer *srvhp, OCISession *userhp, int disconnect);
@@ -91,11 +107,30 @@ static void disconnectServer(OCIEnv *envhp, OCIServer *srvhp);
 static void removeEnvironment(OCIEnv *envhp);
 static void registerStmt(OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp);
 static void allocLobLocator(OCILobLocator **locpp, OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp, oraError error, const char *errmsg);
+static void allocDescriptor(void **descpp, ub4 dtype, OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp, oraError error, const char *errmsg);
+static ub4 getDescriptorType(const struct oraColumn *column);
 static void freeStmt(OCIStmt *stmthp, struct connEntry *connp, OCIError *errhp);
+static struct stmtHandleEntry *findStmt(OCIStmt *stmthp, struct connEntry *connp);
+static sword setNonblocking(struct srvEntry *srvp, OCIError *errhp, int on);
+static void defineResultBuffer(oracleSession *session, unsigned int buffer);
+static void startFetch(oracleSession *session, ub4 rows);
+static void startExecute(oracleSession *session);
+static sword pollFetch(struct stmtHandleEntry *entry, OCIError *errhp);
+static void switchBuffer(oracleSession *session, unsigned int prefetch);
+static void finishFetch(struct srvEntry *srvp, OCIError *errhp, sword result);
+static void cancelFetch(struct srvEntry *srvp, OCIError *errhp);
+static void freeExecuteParams(struct stmtHandleEntry *entry, OCIError *errhp);
 static ub2 getOraType(oraType arg);
+static ub2 getDefineType(const struct oraColumn *column);
 static sb4 bind_out_callback(void *octxp, OCIBind *bindp, ub4 iter, ub4 index, void **bufpp, ub4 **alenp, ub1 *piecep, void **indp, ub2 **rcodep);
 static sb4 bind_in_callback(void *ictxp, OCIBind *bindp, ub4 iter, ub4 index, void **bufpp, ub4 *alenp, ub1 *piecep, void **indpp);
 static void setNullGeometry(oracleSession *session, ora_geometry *geom);
+static void textToNumber(oracleSession *session, const char *value, OCINumber *number);
+static oraError executeErrorState(sb4 code);
+static unsigned int loadDirPathRows(oracleSession *session);
+static void freeDirPath(struct connEntry *connp, OCIError *errhp, int abort);
+static OCIType *getCollectionType(oracleSession *session, oraBindType bindType);
+static OCIColl *buildCollection(oracleSession *session, oraBindType bindType, const char *value);
 
 /*
  * oracleGetSession
@@ -122,6 +157,7 @@ oracleSession
 	ub4 is_connected;
 	int retry = 1, i;
 	ub4 isolevel = OCI_TRANS_SERIALIZABLE;
+	ub4 stmt_cache_size = STMT_CACHE_SIZE;
 
 	/* convert isolation_level to Oracle OCI value */
 	switch(isolation_level)
@@ -337,9 +373,14 @@ oracleSession
 		srvp->srvhp = srvhp;
 		srvp->next = envp->srvlist;
 		srvp->connlist = NULL;
+		srvp->pending_fetch = NULL;
 		envp->srvlist = srvp;
 	}
 
+	/* a non-blocking fetch has to finish before the connection can be used */
+	if (srvp->pending_fetch != NULL)
+		finishFetch(srvp, errhp, OCI_STILL_EXECUTING);
+
 	/* search user session for this server in cache */
 	for (connp = srvp->connlist; connp != NULL; connp = connp->next)
 	{
@@ -501,6 +542,21 @@ oracleSession
 				oraMessage);
 		}
 
+		/*
+		 * Enable the statement cache.  OCIStmtPrepare2 will then find
+		 * statements by their text, and OCIStmtRelease keeps them open
+		 * for the next use, which saves parsing them again.
+		 */
+		if (checkerr(
+			OCIAttrSet(svchp, OCI_HTYPE_SVCCTX, (dvoid *)&stmt_cache_size, 0,
+				OCI_ATTR_STMTCACHESIZE, errhp),
+			(dvoid *)errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_ESTABLISH_CONNECTION,
+				"error connecting to Oracle: OCIAttrSet failed to set statement cache size",
+				oraMessage);
+		}
+
 		/* store the server version in the service handle cache */
 		getServerVersion(srvp, errhp);
 
@@ -520,7 +576,10 @@ oracleSession
 		connp->svchp = svchp;
 		connp->userhp = userhp;
 		connp->geomtype = NULL;
+		connp->numlisttype = NULL;
+		connp->strlisttype = NULL;
 		connp->stmtlist = NULL;
+		connp->dirpath = NULL;
 		connp->xact_level = 0;
 		connp->next = srvp->connlist;
 		srvp->connlist = connp;
@@ -580,6 +639,11 @@ oracleSession
 	session->last_batch = 0;
 	session->fetched_rows = 0;
 	session->current_row = 0;
+	session->buffer_rows = 0;
+	session->buffer = 0;
+	session->oraTable = NULL;
+	session->defines = NULL;
+	session->async = 0;
 
 	/* set savepoints up to the current level */
 	oracleSetSavepoint(session, curlevel);
@@ -706,6 +770,14 @@ void oracleEndTransaction(void *arg, int is_commit, int noerror)
 		oracleError(FDW_ERROR, "oracleEndTransaction internal error: handle not found in cache");
 	}
 
+	/* interrupt a non-blocking fetch, no matter which session it belongs to */
+	if (srvp->pending_fetch != NULL)
+		cancelFetch(srvp, envp->errhp);
+
+	/* abort a direct path load that was not finished */
+	if (connp->dirpath != NULL)
+		freeDirPath(connp, envp->errhp, 1);
+
 	/* close all statements and free their LOB descriptors */
 	while (connp->stmtlist != NULL)
 		freeStmt(connp->stmtlist->stmthp, connp, envp->errhp);
@@ -821,6 +893,14 @@ oracleEndSubtransaction(void *arg, int nest_level, int is_commit)
 	if (! found)
 		oracleError(FDW_ERROR, "oracleEndSubtransaction internal error: handle not found in cache");
 
+	/* the fetch might belong to a scan in the surrounding transaction */
+	if (srvp->pending_fetch != NULL)
+		finishFetch(srvp, envp->errhp, OCI_STILL_EXECUTING);
+
+	/* abort a direct path load that was started in the rolled back subtransaction */
+	if (connp->dirpath != NULL && connp->dirpath->xact_level >= nest_level)
+		freeDirPath(connp, envp->errhp, 1);
+
 	snprintf(message, 59, "oracle_fdw: rollback to savepoint s%d", nest_level);
 	oracleDebug2(message);
 
@@ -855,6 +935,31 @@ oracleEndSubtransaction(void *arg, int nest_level, int is_commit)
 	freeStmt(stmthp, connp, envp->errhp);
 }
 
+/*
+ * oracleResetStatement
+ * 		Prepare the current statement for another execution.
+ * 		A non-blocking fetch or execution in progress is interrupted,
+ * 		but the statement handle, its result definitions and its
+ * 		LOB locators are kept, so that oracleExecuteQuery can be
+ * 		called again right away.
+ */
+void
+oracleResetStatement(oracleSession *session)
+{
+	struct stmtHandleEntry *entry;
+
+	if (session->stmthp == NULL)
+		return;
+
+	entry = findStmt(session->stmthp, session->connp);
+	if (entry->fetch_srvp != NULL)
+		cancelFetch(entry->fetch_srvp, session->envp->errhp);
+
+	session->last_batch = 0;
+	session->fetched_rows = 0;
+	session->current_row = 0;
+}
+
 /*
  * oracleIsStatementOpen
  * 		Return 1 if there is a statement handle, else 0.
@@ -886,6 +991,10 @@ struct oraTable
 	ub4 ncols, ident_size, typname_size, typschema_size;
 	int i, length;
 
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
 	/* get a complete quoted table name */
 	qtable = copyOraText(table, strlen(table), 1);
 	length = strlen(qtable);
@@ -987,6 +1096,7 @@ struct oraTable
 		reply->cols[i-1]->used = 0;
 		reply->cols[i-1]->strip_zeros = 0;
 		reply->cols[i-1]->pkey = 0;
+		reply->cols[i-1]->fetchtype = FETCH_DEFAULT;
 		reply->cols[i-1]->val = NULL;
 		reply->cols[i-1]->val_len = NULL;
 		reply->cols[i-1]->val_null = NULL;
@@ -1315,6 +1425,36 @@ oracleExplain(oracleSession *session, const char *query, int *nrows, char ***pla
 	freeStmt(stmthp, session->connp, session->envp->errhp);
 }
 
+/*
+ * oracleEstimate
+ * 		Get the Oracle optimizer's estimates for the query from the
+ * 		execution plan: the number of result rows, the average width
+ * 		of a result row and the cost (in units of single block reads).
+ */
+void
+oracleEstimate(oracleSession *session, const char *query, double *rows, int *width, double *cost)
+{
+	double res_rows, res_bytes, res_cost;
+	dvoid *res[3] = { (dvoid *)&res_rows, (dvoid *)&res_bytes, (dvoid *)&res_cost };
+	sb4 res_size[3] = { sizeof(double), sizeof(double), sizeof(double) };
+	ub2 res_type[3] = { SQLT_FLT, SQLT_FLT, SQLT_FLT }, res_len[3];
+	sb2 res_ind[3];
+	OCIStmt *stmthp;
+	const char * const desc_query =
+		"SELECT nvl(cardinality, 0), nvl(bytes, 0), nvl(cost, 0) FROM v$sql_plan"
+		" WHERE sql_id = :sql_id AND child_number = :child_number AND id = 1";
+
+	/* execute the query and get the result row */
+	stmthp = oracleQueryPlan(session, query, desc_query, 3, res, res_size, res_type, res_len, res_ind);
+
+	/* close the statement */
+	freeStmt(stmthp, session->connp, session->envp->errhp);
+
+	*rows = res_rows;
+	*width = (res_rows > 0.0) ? (int)(res_bytes / res_rows) : 0;
+	*cost = res_cost;
+}
+
 /*
  * oracleSetSavepoint
  * 		Set savepoints up to level "nest_level".
@@ -1508,6 +1648,10 @@ oracleQueryPlan(oracleSession *session, const char *query, const char *desc_quer
 	ub2 len1, len2;
 	ub4 prefetch_rows = 50;
 
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
 	/* prepare the query */
 	if (checkerr(
 		OCIStmtPrepare2(session->connp->svchp, &stmthp, session->envp->errhp,
@@ -1733,11 +1877,17 @@ oracleQueryPlan(oracleSession *session, const char *query, const char *desc_quer
  * 		even if the statement is executed multiple times, that is:
  * 		- For SELECT statements, defines the result values to be stored in oraTable.
  * 		- For DML statements, allocates LOB locators for the RETURNING clause in oraTable.
+ * 		Unless "pipeline" is PIPELINE_OFF, the result arrays in oraTable must have
+ * 		room for 2 * "prefetch" rows.  Then the next rows are fetched into one
+ * 		half of the arrays while the rows in the other half are processed.
+ * 		With PIPELINE_ASYNC, oracleExecuteQuery does not wait for the query either.
+ * 		This is only possible for SELECT statements without LOBs and geometries.
  */
 void
-oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTable *oraTable, unsigned int prefetch, unsigned int lob_prefetch)
+oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTable *oraTable, unsigned int prefetch, unsigned int lob_prefetch, oraPipeline pipeline)
 {
 	int i, j, col_pos, is_select;
+	unsigned int buffer_rows;
 	OCIDefine *defnhp;
 	const ub1 nchar = SQLCS_NCHAR;
 	const boolean is_true = TRUE;
@@ -1749,7 +1899,27 @@ oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTa
 	if (session->stmthp != NULL)
 		oracleError(FDW_ERROR, "oraclePrepareQuery internal error: statement handle is not NULL");
 
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
 	session->last_batch = 0;
+	session->buffer = 0;
+	session->buffer_rows = (is_select && pipeline != PIPELINE_OFF) ? prefetch : 0;
+	session->async = (is_select && pipeline == PIPELINE_ASYNC);
+	session->oraTable = oraTable;
+	session->defines = NULL;
+
+	/* the number of rows in the result arrays */
+	buffer_rows = (session->buffer_rows > 0) ? 2 * prefetch : prefetch;
+
+	if (session->buffer_rows > 0)
+	{
+		/* remember the define handles, we need them to switch buffers */
+		session->defines = oracleAlloc(sizeof(OCIDefine *) * (oraTable->ncols > 0 ? oraTable->ncols : 1));
+		for (i=0; i<oraTable->ncols; ++i)
+			session->defines[i] = NULL;
+	}
 
 	/* prepare the statement */
 	if (checkerr(
@@ -1787,9 +1957,7 @@ oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTa
 				oraType oracle_type = oraTable->cols[i]->oratype;
 
 				/* figure out in which format we want the results */
-				type = getOraType(oraTable->cols[i]->oratype);
-				if (oraTable->cols[i]->pgtype == UUIDOID)
-					type = SQLT_STR;
+				type = getDefineType(oraTable->cols[i]);
 
 				/* check if it is a LOB column */
 				if (type == SQLT_BLOB || type == SQLT_BFILE || type == SQLT_CLOB)
@@ -1802,6 +1970,18 @@ oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTa
 							"error executing query: OCIDescriptorAlloc failed to allocate LOB descriptor");
 				}
 
+				/* datetime and interval values are fetched into descriptors */
+				if (getDescriptorType(oraTable->cols[i]) != 0)
+				{
+					/* allocate an array of descriptors, store the pointers in "val" */
+					for (j = 0; j < buffer_rows; ++j)
+						allocDescriptor((void **)oraTable->cols[i]->val + j,
+							getDescriptorType(oraTable->cols[i]),
+							session->stmthp, session->envp->envhp, session->connp,
+							FDW_UNABLE_TO_CREATE_EXECUTION,
+							"error executing query: OCIDescriptorAlloc failed to allocate datetime descriptor");
+				}
+
 				/* define result value */
 				defnhp = NULL;
 				if (checkerr(
@@ -1816,6 +1996,9 @@ oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTa
 						oraMessage);
 				}
 
+				if (session->defines != NULL)
+					session->defines[i] = defnhp;
+
 				/* LOBs should be prefetched to save round trips */
 				if (type == SQLT_BLOB || type == SQLT_BFILE || type == SQLT_CLOB)
 				{
@@ -1899,6 +2082,16 @@ oraclePrepareQuery(oracleSession *session, const char *query, const struct oraTa
 						FDW_UNABLE_TO_CREATE_EXECUTION,
 						"error executing query: OCIDescriptorAlloc failed to allocate LOB descriptor");
 				}
+
+				/* ... and descriptors for datetime and interval values */
+				if (getDescriptorType(oraTable->cols[i]) != 0)
+				{
+					allocDescriptor((void **)oraTable->cols[i]->val,
+						getDescriptorType(oraTable->cols[i]),
+						session->stmthp, session->envp->envhp, session->connp,
+						FDW_UNABLE_TO_CREATE_EXECUTION,
+						"error executing query: OCIDescriptorAlloc failed to allocate datetime descriptor");
+				}
 			}
 		}
 	}
@@ -1941,14 +2134,51 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 	struct paramDesc *param;
 	sword result;
 	ub4 rowcount;
-	int param_count = 0;
+	int param_count = 0, i;
+	OCIColl **collections;
 	const ub1 nchar = SQLCS_NCHAR;
 
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
 	for (param=paramList; param; param=param->next)
 		++param_count;
 
-	/* allocate a temporary array of indicators */
-	indicators = oracleAlloc(param_count * sizeof(sb2 *));
+	if (session->async)
+	{
+		struct stmtHandleEntry *entry = findStmt(session->stmthp, session->connp);
+
+		/* free what an earlier execution that failed to start left behind */
+		freeExecuteParams(entry, session->envp->errhp);
+
+		/*
+		 * For asynchronous execution, the arrays must survive until the
+		 * execution is finished, which can be in a different memory context.
+		 */
+		indicators = calloc(param_count + 1, sizeof(sb2));
+		collections = calloc(param_count + 1, sizeof(OCIColl *));
+		if (indicators == NULL || collections == NULL)
+		{
+			oracleError_i(FDW_OUT_OF_MEMORY,
+				"error executing query: failed to allocate %d bytes of memory",
+				(param_count + 1) * (sizeof(sb2) + sizeof(OCIColl *)));
+		}
+
+		entry->exec_envhp = session->envp->envhp;
+		entry->exec_indicators = indicators;
+		entry->exec_collections = collections;
+		entry->exec_params = param_count + 1;
+	}
+	else
+	{
+		/* allocate a temporary array of indicators */
+		indicators = oracleAlloc(param_count * sizeof(sb2 *));
+
+		/* ... and one for the collections bound to array parameters */
+		collections = oracleAlloc(param_count * sizeof(OCIColl *));
+		memset(collections, 0, param_count * sizeof(OCIColl *));
+	}
 
 	/* bind the parameters */
 	param_count = -1;
@@ -1959,7 +2189,6 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 		ub2 value_type = SQLT_STR;   /* SQL_STR works for NULLs of all types */
 		ub4 oci_mode = OCI_DEFAULT;  /* changed only for output parameters */
 		OCINumber *number;
-		char *num_format, *pos;
 
 		++param_count;
 		indicators[param_count] = (sb2)((param->value == NULL) ? -1 : 0);
@@ -1970,36 +2199,8 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 					/* allocate a new NUMBER */
 					number = oracleAlloc(sizeof(OCINumber));
 
-					/*
-					 * Construct number format.
-					 */
-					value_len = strlen(param->value);
-					num_format = oracleAlloc(value_len + 3);
-					/* fill everything with '9' */
-					memset(num_format, '9', value_len);
-					num_format[value_len] = '\0';
-					/* write 'D' in the decimal point position */
-					if ((pos = strchr(param->value, '.')) != NULL)
-						num_format[pos - param->value] = 'D';
-					/* replace the scientific notation part with 'EEEE' */
-					if ((pos = strchr(param->value, 'e')) != NULL)
-					{
-						memset(num_format + (pos - param->value), 'E', 4);
-						num_format[(pos - param->value) + 4] = '\0';
-					}
-
 					/* convert parameter string to NUMBER */
-					if (checkerr(
-						OCINumberFromText(session->envp->errhp, (const OraText *)param->value,
-							(ub4)value_len, (const OraText *)num_format, (ub4)strlen(num_format),
-							(const OraText *)NULL, (ub4)0, number),
-						(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
-					{
-						oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-							"error executing query: OCINumberFromText failed to convert parameter",
-							oraMessage);
-					}
-					oracleFree(num_format);
+					textToNumber(session, param->value, number);
 
 					value = (dvoid *)number;
 					value_len = sizeof(OCINumber);
@@ -2025,15 +2226,18 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 					value_len = 0;
 					value_type = SQLT_NTY;
 					break;
+				case BIND_NUMBER_ARRAY:
+				case BIND_STRING_ARRAY:
+					/* the collection pointer must stay valid until the query is executed */
+					collections[param_count] = buildCollection(session, param->bindType, param->value);
+					value = (dvoid *)&collections[param_count];
+					value_len = 0;
+					value_type = SQLT_NTY;
+					break;
 				case BIND_OUTPUT:
 					value = NULL;
 					value_len = oraTable->cols[param->colnum]->val_size;
-					value_type = getOraType(oraTable->cols[param->colnum]->oratype);
-					if (oraTable->cols[param->colnum]->pgtype == UUIDOID)
-					{
-						/* the type input function will interpret the string value correctly */
-						value_type = SQLT_STR;
-					}
+					value_type = getDefineType(oraTable->cols[param->colnum]);
 					oci_mode = OCI_DATA_AT_EXEC;
 					break;
 			}
@@ -2079,8 +2283,10 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 		 * Use the expensive character conversion only if we are dealing with
 		 * "national character sets" on the Oracle side.
 		 * CLOBs have their own encoding, so we have to exclude them.
+		 * The same holds for collections of VARCHAR2 and NUMBER.
 		 */
 		if (session->have_nchar && value_type != SQLT_CLOB
+			&& param->bindType != BIND_NUMBER_ARRAY && param->bindType != BIND_STRING_ARRAY
 			&& checkerr(
 				OCIAttrSet((void *)param->bindh, OCI_HTYPE_BIND, (void *)&nchar, 0,
 					OCI_ATTR_CHARSET_FORM, session->envp->errhp),
@@ -2124,6 +2330,20 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 			}
 		}
 
+		/* for array parameters, bind the collection object */
+		if (param->bindType == BIND_NUMBER_ARRAY || param->bindType == BIND_STRING_ARRAY)
+		{
+			if (checkerr(
+				OCIBindObject((OCIBind *)param->bindh, session->envp->errhp,
+					getCollectionType(session, param->bindType), (void **)value, NULL, NULL, NULL),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+			{
+				oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+					"error executing query: OCIBindObject failed to bind array parameter",
+					oraMessage);
+			}
+		}
+
 		/* for output parameters, define callbacks that provide storage space */
 		if (param->bindType == BIND_OUTPUT)
 		{
@@ -2140,6 +2360,29 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 		}
 	}
 
+	/*
+	 * For asynchronous execution, only start the query.  OCI still needs
+	 * the indicators and collections while the call is pending, so they
+	 * are freed by finishFetch() or cancelFetch().
+	 */
+	if (session->async)
+	{
+		startExecute(session);
+
+		session->last_batch = 0;
+		session->fetched_rows = 0;
+		session->current_row = 0;
+
+		return 0;
+	}
+
+	/* with double buffering, the first rows go into the first buffer */
+	if (session->buffer_rows > 0 && session->buffer != 0)
+	{
+		session->buffer = 0;
+		defineResultBuffer(session, 0);
+	}
+
 	/* execute the query and get the first "prefetch" rows */
 	result = checkerr(
 		OCIStmtExecute(session->connp->svchp, session->stmthp, session->envp->errhp, (ub4)prefetch, (ub4)0,
@@ -2148,34 +2391,18 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 
 	if (result != OCI_SUCCESS && result != OCI_NO_DATA)
 	{
-		oraError sqlstate;
-		switch (err_code)
-		{
-			case 1:
-				sqlstate = FDW_UNIQUE_VIOLATION; break;
-			case 60:
-				sqlstate = FDW_DEADLOCK_DETECTED; break;
-			case 1400:
-				sqlstate = FDW_NOT_NULL_VIOLATION; break;
-			case 2290:
-				sqlstate = FDW_CHECK_VIOLATION; break;
-			case 2291:
-			case 2292:
-				sqlstate = FDW_FOREIGN_KEY_VIOLATION; break;
-			case 8177:
-				sqlstate = FDW_SERIALIZATION_FAILURE; break;
-			default:
-				sqlstate = FDW_UNABLE_TO_CREATE_EXECUTION;
-		}
-
 		/* use the correct SQLSTATE for serialization failures */
-		oracleError_d(sqlstate,
+		oracleError_d(executeErrorState(err_code),
 			"error executing query: OCIStmtExecute failed to execute remote query",
 			oraMessage);
 	}
 
-	/* free indicators */
+	/* free indicators and collections */
 	oracleFree(indicators);
+	for (i=0; i<=param_count; ++i)
+		if (collections[i] != NULL)
+			(void)OCIObjectFree(session->envp->envhp, session->envp->errhp, collections[i], 0);
+	oracleFree(collections);
 
 	/* get the number of processed rows (important for DML) */
 	if (checkerr(
@@ -2192,6 +2419,10 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 	session->fetched_rows = (unsigned int)rowcount;
 	session->current_row = 0;
 
+	/* with double buffering, start fetching the next rows right away */
+	if (session->buffer_rows > 0 && !session->last_batch)
+		startFetch(session, (ub4)prefetch);
+
 	/* post processing of output parameters */
 	for (param=paramList; param; param=param->next)
 		if (param->bindType == BIND_OUTPUT)
@@ -2228,137 +2459,738 @@ oracleExecuteQuery(oracleSession *session, const struct oraTable *oraTable, stru
 }
 
 /*
- * oracleFetchNext
- * 		Fetch the next result rows if the buffer is empty.
- * 		Return the position of the next result in the result buffer
- * 		if there is one, else 0.
+ * oracleExecuteBatch
+ * 		Execute a prepared DML statement for "rows" rows at once.
+ * 		The parameter values are taken from the "values" arrays in paramList,
+ * 		and all values of a parameter are bound as a single array.
+ * 		Only string, number, LONG and LONG RAW parameters can be used.
+ * 		With OCI_BATCH_ERRORS, Oracle processes all rows even if some of
+ * 		them fail; the error for the first failing row is reported.
+ * 		If "row_counts" is not NULL, the number of rows processed for each
+ * 		array element is stored there.
+ * 		Return the number of rows processed.
  */
 unsigned int
-oracleFetchNext(oracleSession *session, unsigned int prefetch)
+oracleExecuteBatch(oracleSession *session, struct paramDesc *paramList, unsigned int rows, unsigned int *row_counts)
 {
+	struct paramDesc *param;
 	sword result;
-	ub4 rowcount;
-
-	/* make sure there is a statement handle stored in "session" */
-	if (session->stmthp == NULL)
-		oracleError(FDW_ERROR, "oracleFetchNext internal error: statement handle is NULL");
-
-	/* if there are still rows in the result set, return the next one */
-	if (session->current_row < session->fetched_rows)
-		return ++(session->current_row);
+	ub4 rowcount, num_errors, exec_mode;
+	unsigned int iters;
+	int param_count = 0, i;
+	unsigned int row;
+	sb2 **indicators;
+	char **buffers;
+	const ub1 nchar = SQLCS_NCHAR;
 
-	/* return 0 if we are done */
-	if (session->last_batch == 1)
-		return 0;
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
 
-	/* fetch the next result rows */
-	result = checkerr(
-		OCIStmtFetch2(session->stmthp, session->envp->errhp, (ub4)prefetch, OCI_FETCH_NEXT, 0, OCI_DEFAULT),
-		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+	for (param=paramList; param; param=param->next)
+		++param_count;
 
-	if (result != OCI_SUCCESS && result != OCI_NO_DATA)
-	{
-		oracleError_d(err_code == 8177 ? FDW_SERIALIZATION_FAILURE : FDW_UNABLE_TO_CREATE_EXECUTION,
-			"error fetching result: OCIStmtFetch2 failed to fetch next result rows",
-			oraMessage);
-	}
+	/* allocate temporary arrays for the indicator and value arrays */
+	indicators = oracleAlloc(param_count * sizeof(sb2 *));
+	buffers = oracleAlloc(param_count * sizeof(char *));
 
-	/* get the number of rows fetched */
-	if (checkerr(
-		OCIAttrGet((dvoid *)session->stmthp, (ub4)OCI_HTYPE_STMT,
-			(dvoid *)&rowcount, (ub4 *)0,
-			(ub4)OCI_ATTR_ROWS_FETCHED, session->envp->errhp),
-		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	/* bind the parameters */
+	param_count = -1;
+	for (param=paramList; param; param=param->next)
 	{
-		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-			"error fetching result: OCIAttrGet failed to get number of affected rows",
-			oraMessage);
-	}
-	session->last_batch = (result == OCI_NO_DATA);
-	session->fetched_rows = (unsigned int)rowcount;
-	session->current_row = (rowcount == 0) ? 0 : 1;
+		sb4 value_size;  /* size of an array element */
+		ub2 value_type;
 
-	return session->current_row;
-}
+		++param_count;
 
-/*
- * oracleExecuteCall
- * 		Execute an Oracle statement that has no results.
- */
-void
-oracleExecuteCall(oracleSession *session, char * const stmt)
-{
-	OCIStmt *stmthp = NULL;
+		switch (param->bindType)
+		{
+			case BIND_NUMBER:
+				value_type = SQLT_VNU;
+				value_size = sizeof(OCINumber);
+				break;
+			case BIND_STRING:
+				value_type = SQLT_STR;
+				value_size = 1;
+				break;
+			default:
+				oracleError(FDW_ERROR, "oracleExecuteBatch internal error: parameter type cannot be bound as an array");
+				return 0;  /* keep compiler quiet */
+		}
 
-	/* prepare the query */
-	if (checkerr(
-		OCIStmtPrepare2(session->connp->svchp, &stmthp, session->envp->errhp,
-			(text *)stmt, (ub4)strlen(stmt), (text *)NULL, (ub4)0,
-			(ub4) OCI_NTV_SYNTAX, (ub4) OCI_DEFAULT),
-		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
-	{
-		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-			"error executing statement: OCIStmtPrepare2 failed to prepare query",
-			oraMessage);
-	}
+		/* the array elements must be large enough for the longest value */
+		indicators[param_count] = oracleAlloc(rows * sizeof(sb2));
+		for (row=0; row<rows; ++row)
+		{
+			const char *value = param->values[row];
 
-	/* register statement handle */
-	registerStmt(stmthp, session->envp->envhp, session->connp);
+			indicators[param_count][row] = (sb2)((value == NULL) ? -1 : 0);
+			if (value == NULL)
+				continue;
 
-	if (checkerr(
-		OCIStmtExecute(session->connp->svchp, stmthp, session->envp->errhp, (ub4)1, (ub4)0,
-			(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT),
-		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
-	{
-		if (err_code == 24374)
-			oracleError(FDW_UNABLE_TO_CREATE_EXECUTION,
-				"Oracle statement must not return a result");
-		else
-			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-				"error executing statement: OCIStmtExecute failed to execute query",
-				oraMessage);
-	}
+			if (param->bindType == BIND_STRING && strlen(value) + 1 > value_size)
+				value_size = strlen(value) + 1;
+		}
 
-	/* free the statement handle */
-	freeStmt(stmthp, session->connp, session->envp->errhp);
-}
+		/* copy the values into the array, computing the size with size_t to avoid overflow */
+		buffers[param_count] = oracleAlloc((size_t)rows * (size_t)value_size);
+		for (row=0; row<rows; ++row)
+		{
+			const char *value = param->values[row];
+			char *element = buffers[param_count] + (size_t)row * (size_t)value_size;
 
-/*
- * oracleGetLob
- * 		Get the LOB contents and store them in *value and *value_len.
- */
-void
-oracleGetLob(oracleSession *session, void *locptr, oraType type, char **value, long *value_len)
-{
-	OCILobLocator *locp = *(OCILobLocator **)locptr;
-	oraub8 amount_byte, amount_char, lobsize;
-	sword result = OCI_SUCCESS;
+			if (value == NULL)
+				continue;
 
-	/* initialize result buffer length */
-	*value_len = 0;
+			if (param->bindType == BIND_NUMBER)
+				textToNumber(session, value, (OCINumber *)element);
+			else
+				strcpy(element, value);
+		}
 
-	if (type == ORA_TYPE_BFILE)
-	{
-		/* BFILEs must be opened, LOBs not */
+		/* bind the array to the parameter */
 		if (checkerr(
-			OCILobFileOpen(session->connp->svchp, session->envp->errhp, locp, OCI_FILE_READONLY),
+			OCIBindByName(session->stmthp, (OCIBind **)&param->bindh, session->envp->errhp, (text *)param->name,
+				(sb4)strlen(param->name), (dvoid *)buffers[param_count], value_size, value_type,
+				(dvoid *)indicators[param_count], NULL, NULL, (ub4)0, NULL, OCI_DEFAULT),
 			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
 		{
 			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-				"error fetching result: OCILobFileOpen failed to open BFILE",
+				"error executing query: OCIBindByName failed to bind parameter",
+				oraMessage);
+		}
+
+		/* see oracleExecuteQuery for national character set conversion */
+		if (session->have_nchar
+			&& checkerr(
+				OCIAttrSet((void *)param->bindh, OCI_HTYPE_BIND, (void *)&nchar, 0,
+					OCI_ATTR_CHARSET_FORM, session->envp->errhp),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: OCIAttrSet failed to set charset form on bind parameter",
 				oraMessage);
 		}
 	}
 
-	/* get the size of the LOB */
-	if (checkerr(
-		OCILobGetLength2(session->connp->svchp, session->envp->errhp, locp, &lobsize),
-		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	exec_mode = OCI_BATCH_ERRORS;
+#ifdef OCI_RETURN_ROW_COUNT_ARRAY
+	/* ask Oracle for the number of rows processed for each array element */
+	if (row_counts != NULL)
+		exec_mode |= OCI_RETURN_ROW_COUNT_ARRAY;
+	iters = rows;
+#else
+	/* before Oracle 12.1, the row counts require an execution per element */
+	iters = (row_counts == NULL) ? rows : 1;
+#endif  /* OCI_RETURN_ROW_COUNT_ARRAY */
+
+	rowcount = 0;
+	for (row=0; row<rows; row+=iters)
 	{
-		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-			"error fetching result: OCILobGetLength2 failed get the LOB size",
-			oraMessage);
-	}
+		ub4 count;
+
+		/* execute the statement once for each row */
+		result = checkerr(
+			OCIStmtExecute(session->connp->svchp, session->stmthp, session->envp->errhp, (ub4)iters, (ub4)row,
+				(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, exec_mode),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+
+		/* failing rows can be reported as ORA-24381, they are examined below */
+		if (result != OCI_SUCCESS && (result != OCI_ERROR || err_code != 24381))
+		{
+			oracleError_d(executeErrorState(err_code),
+				"error executing query: OCIStmtExecute failed to execute remote query",
+				oraMessage);
+		}
+
+		/* check for errors in individual rows */
+		if (checkerr(
+			OCIAttrGet((dvoid *)session->stmthp, (ub4)OCI_HTYPE_STMT,
+				(dvoid *)&num_errors, (ub4 *)0,
+				(ub4)OCI_ATTR_NUM_DML_ERRORS, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: OCIAttrGet failed to get number of DML errors",
+				oraMessage);
+		}
+
+		if (num_errors > 0)
+		{
+			OCIError *row_errhp = NULL;
+			ub4 row_offset = 0;
+			char rownum[20];
+
+			if (checkerr(
+				OCIHandleAlloc((dvoid *)session->envp->envhp, (dvoid **)&row_errhp,
+					(ub4)OCI_HTYPE_ERROR, (size_t)0, NULL),
+				(dvoid *)session->envp->envhp, OCI_HTYPE_ENV) != OCI_SUCCESS)
+			{
+				oracleError(FDW_OUT_OF_MEMORY,
+					"error executing query: OCIHandleAlloc failed to allocate error handle");
+			}
+
+			/* get the error handle for the first failing row */
+			if (checkerr(
+				OCIParamGet((dvoid *)session->envp->errhp, (ub4)OCI_HTYPE_ERROR, session->envp->errhp,
+					(dvoid **)&row_errhp, (ub4)0),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS
+				|| checkerr(
+				OCIAttrGet((dvoid *)row_errhp, (ub4)OCI_HTYPE_ERROR,
+					(dvoid *)&row_offset, (ub4 *)0,
+					(ub4)OCI_ATTR_DML_ROW_OFFSET, session->envp->errhp),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+			{
+				(void)OCIHandleFree((dvoid *)row_errhp, OCI_HTYPE_ERROR);
+				oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+					"error executing query: failed to get the error of a batch row",
+					oraMessage);
+			}
+
+			/* get the Oracle error message for that row */
+			(void)checkerr(OCI_ERROR, (dvoid *)row_errhp, OCI_HTYPE_ERROR);
+			(void)OCIHandleFree((dvoid *)row_errhp, OCI_HTYPE_ERROR);
+
+			snprintf(rownum, 20, "%u", row + (unsigned int)row_offset + 1);
+			oracleError_sd(executeErrorState(err_code),
+				"error executing query: OCIStmtExecute failed for row %s of the batch",
+				rownum,
+				oraMessage);
+		}
+
+		/* get the number of processed rows */
+		if (checkerr(
+			OCIAttrGet((dvoid *)session->stmthp, (ub4)OCI_HTYPE_STMT,
+				(dvoid *)&count, (ub4 *)0,
+				(ub4)OCI_ATTR_ROW_COUNT, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: OCIAttrGet failed to get number of affected rows",
+				oraMessage);
+		}
+
+		if (row_counts != NULL && iters == 1)
+			row_counts[row] = (unsigned int)count;
+		rowcount += count;
+	}
+
+#ifdef OCI_RETURN_ROW_COUNT_ARRAY
+	/* get the number of processed rows for each array element */
+	if (row_counts != NULL)
+	{
+		ub8 *counts = NULL;
+		ub4 ncounts = 0;
+
+		if (checkerr(
+			OCIAttrGet((dvoid *)session->stmthp, (ub4)OCI_HTYPE_STMT,
+				(dvoid *)&counts, (ub4 *)&ncounts,
+				(ub4)OCI_ATTR_DML_ROW_COUNT_ARRAY, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: OCIAttrGet failed to get row counts of the batch",
+				oraMessage);
+		}
+
+		for (row=0; row<rows; ++row)
+			row_counts[row] = (row < ncounts) ? (unsigned int)counts[row] : 0;
+	}
+#endif  /* OCI_RETURN_ROW_COUNT_ARRAY */
+
+	/* free indicators and values */
+	for (i=0; i<=param_count; ++i)
+	{
+		oracleFree(indicators[i]);
+		oracleFree(buffers[i]);
+	}
+	oracleFree(indicators);
+	oracleFree(buffers);
+
+	return (unsigned int)rowcount;
+}
+
+/*
+ * oracleDirectPathBegin
+ * 		Prepare a direct path load into the Oracle table "schema"."table".
+ * 		The loaded columns are the columns of the parameters in paramList,
+ * 		in that order.  Values are passed as strings (or binary data for RAW),
+ * 		so Oracle converts them like it converts bound strings.
+ * 		The handles are kept in the connection, so that the load can be
+ * 		aborted at the end of the transaction if it was not finished.
+ */
+void
+oracleDirectPathBegin(oracleSession *session, const char *schema, const char *table, const struct oraTable *oraTable, struct paramDesc *paramList)
+{
+	struct dirPathEntry *dirpath;
+	struct paramDesc *param;
+	OCIParam *collist = NULL, *colp = NULL;
+	ub2 ncols = 0, i;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	if (session->connp->dirpath != NULL)
+		oracleError(FDW_ERROR, "oracleDirectPathBegin internal error: a direct path load is already in progress");
+
+	for (param=paramList; param; param=param->next)
+		++ncols;
+
+	/* the entry must survive errors so that the load can be aborted */
+	if ((dirpath = malloc(sizeof(struct dirPathEntry))) == NULL)
+	{
+		oracleError_i(FDW_OUT_OF_MEMORY,
+			"error starting direct path load: failed to allocate %d bytes of memory",
+			sizeof(struct dirPathEntry));
+	}
+	dirpath->dpctx = NULL;
+	dirpath->dpca = NULL;
+	dirpath->dpstr = NULL;
+	dirpath->max_rows = 0;
+	dirpath->rows = 0;
+	dirpath->xact_level = session->connp->xact_level;
+	session->connp->dirpath = dirpath;
+
+	/* allocate the direct path context */
+	if (checkerr(
+		OCIHandleAlloc((dvoid *)session->envp->envhp, (dvoid **)&dirpath->dpctx,
+			(ub4)OCI_HTYPE_DIRPATH_CTX, (size_t)0, NULL),
+		(dvoid *)session->envp->envhp, OCI_HTYPE_ENV) != OCI_SUCCESS)
+	{
+		oracleError(FDW_OUT_OF_MEMORY,
+			"error starting direct path load: OCIHandleAlloc failed to allocate direct path context handle");
+	}
+
+	/* set the table and the number of columns */
+	if (checkerr(
+		OCIAttrSet((dvoid *)dirpath->dpctx, OCI_HTYPE_DIRPATH_CTX, (dvoid *)table, (ub4)strlen(table),
+			OCI_ATTR_NAME, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS
+		|| (schema != NULL && checkerr(
+		OCIAttrSet((dvoid *)dirpath->dpctx, OCI_HTYPE_DIRPATH_CTX, (dvoid *)schema, (ub4)strlen(schema),
+			OCI_ATTR_SCHEMA_NAME, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		|| checkerr(
+		OCIAttrSet((dvoid *)dirpath->dpctx, OCI_HTYPE_DIRPATH_CTX, (dvoid *)&ncols, (ub4)0,
+			OCI_ATTR_NUM_COLS, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error starting direct path load: OCIAttrSet failed to set table attributes",
+			oraMessage);
+	}
+
+	/* get the column list */
+	if (checkerr(
+		OCIAttrGet((dvoid *)dirpath->dpctx, OCI_HTYPE_DIRPATH_CTX, (dvoid *)&collist, (ub4 *)0,
+			OCI_ATTR_LIST_COLUMNS, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error starting direct path load: OCIAttrGet failed to get column list",
+			oraMessage);
+	}
+
+	/* describe the columns */
+	for (param=paramList, i=1; param; param=param->next, ++i)
+	{
+		const struct oraColumn *column = oraTable->cols[param->colnum];
+		ub2 data_type = (param->bindType == BIND_LONGRAW) ? SQLT_BIN : SQLT_CHR;
+		/* big enough for the string representation of numbers and datetimes */
+		ub4 data_size = (column->val_size > 140) ? (ub4)column->val_size : 140;
+		const char *dateformat = NULL;
+
+		/*
+		 * The format must match the string that setModifyParameters produced,
+		 * which depends on the PostgreSQL type and not on the Oracle column.
+		 * Other types are passed as they are and use the NLS settings.
+		 */
+		switch (param->type)
+		{
+			case DATEOID:
+				dateformat = "YYYY-MM-DD HH24:MI:SS BC";
+				break;
+			case TIMESTAMPOID:
+				dateformat = "YYYY-MM-DD HH24:MI:SS.FF BC";
+				break;
+			case TIMESTAMPTZOID:
+				dateformat = "YYYY-MM-DD HH24:MI:SS.FFTZH:TZM BC";
+				break;
+			default:
+				break;
+		}
+
+		if (checkerr(
+			OCIParamGet((dvoid *)collist, (ub4)OCI_DTYPE_PARAM, session->envp->errhp,
+				(dvoid **)&colp, (ub4)i),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error starting direct path load: OCIParamGet failed to get column",
+				oraMessage);
+		}
+
+		/* the column name is stored in quotes */
+		if (checkerr(
+			OCIAttrSet((dvoid *)colp, OCI_DTYPE_PARAM, (dvoid *)(column->name + 1), (ub4)strlen(column->name) - 2,
+				OCI_ATTR_NAME, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS
+			|| checkerr(
+			OCIAttrSet((dvoid *)colp, OCI_DTYPE_PARAM, (dvoid *)&data_type, (ub4)0,
+				OCI_ATTR_DATA_TYPE, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS
+			|| checkerr(
+			OCIAttrSet((dvoid *)colp, OCI_DTYPE_PARAM, (dvoid *)&data_size, (ub4)0,
+				OCI_ATTR_DATA_SIZE, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS
+			|| (dateformat != NULL && checkerr(
+			OCIAttrSet((dvoid *)colp, OCI_DTYPE_PARAM, (dvoid *)dateformat, (ub4)strlen(dateformat),
+				OCI_ATTR_DATEFORMAT, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS))
+		{
+			(void)OCIDescriptorFree((dvoid *)colp, OCI_DTYPE_PARAM);
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error starting direct path load: OCIAttrSet failed to set column attributes",
+				oraMessage);
+		}
+
+		(void)OCIDescriptorFree((dvoid *)colp, OCI_DTYPE_PARAM);
+	}
+
+	/* prepare the load */
+	if (checkerr(
+		OCIDirPathPrepare(dirpath->dpctx, session->connp->svchp, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error starting direct path load: OCIDirPathPrepare failed to prepare the load",
+			oraMessage);
+	}
+
+	/* allocate the column array and the stream */
+	if (checkerr(
+		OCIHandleAlloc((dvoid *)dirpath->dpctx, (dvoid **)&dirpath->dpca,
+			(ub4)OCI_HTYPE_DIRPATH_COLUMN_ARRAY, (size_t)0, NULL),
+		(dvoid *)session->envp->envhp, OCI_HTYPE_ENV) != OCI_SUCCESS
+		|| checkerr(
+		OCIHandleAlloc((dvoid *)dirpath->dpctx, (dvoid **)&dirpath->dpstr,
+			(ub4)OCI_HTYPE_DIRPATH_STREAM, (size_t)0, NULL),
+		(dvoid *)session->envp->envhp, OCI_HTYPE_ENV) != OCI_SUCCESS)
+	{
+		oracleError(FDW_OUT_OF_MEMORY,
+			"error starting direct path load: OCIHandleAlloc failed to allocate direct path handles");
+	}
+
+	/* get the number of rows that fit into the column array */
+	if (checkerr(
+		OCIAttrGet((dvoid *)dirpath->dpca, OCI_HTYPE_DIRPATH_COLUMN_ARRAY, (dvoid *)&dirpath->max_rows, (ub4 *)0,
+			OCI_ATTR_NUM_ROWS, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error starting direct path load: OCIAttrGet failed to get number of rows",
+			oraMessage);
+	}
+}
+
+/*
+ * oracleDirectPathLoad
+ * 		Add a row with the parameter values to the column array of the
+ * 		direct path load.  When the array is full, the rows are sent to Oracle.
+ * 		The column array only points to the values, so they must stay valid
+ * 		until they are sent.
+ * 		Returns the number of rows sent to Oracle (0 if the row was only stored).
+ */
+unsigned int
+oracleDirectPathLoad(oracleSession *session, struct paramDesc *paramList)
+{
+	struct dirPathEntry *dirpath = session->connp->dirpath;
+	struct paramDesc *param;
+	ub4 col;
+
+	if (dirpath == NULL)
+		oracleError(FDW_ERROR, "oracleDirectPathLoad internal error: no direct path load in progress");
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	for (param=paramList, col=0; param; param=param->next, ++col)
+	{
+		ub1 *data = NULL;
+		ub4 len = 0;
+		ub1 flag = OCI_DIRPATH_COL_COMPLETE;
+
+		/* Oracle treats empty strings as NULL */
+		if (param->value == NULL
+			|| (param->bindType != BIND_LONGRAW && param->value[0] == '\0'))
+			flag = OCI_DIRPATH_COL_NULL;
+		else if (param->bindType == BIND_LONGRAW)
+		{
+			/* the first 4 bytes contain the length */
+			data = (ub1 *)param->value + 4;
+			len = (ub4)*((sb4 *)param->value);
+		}
+		else
+		{
+			data = (ub1 *)param->value;
+			len = (ub4)strlen(param->value);
+		}
+
+		if (checkerr(
+			OCIDirPathColArrayEntrySet(dirpath->dpca, session->envp->errhp, dirpath->rows, (ub2)col,
+				data, len, flag),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error loading data: OCIDirPathColArrayEntrySet failed to set column value",
+				oraMessage);
+		}
+	}
+
+	if (++dirpath->rows < dirpath->max_rows)
+		return 0;
+
+	return loadDirPathRows(session);
+}
+
+/*
+ * oracleDirectPathFinish
+ * 		Send the remaining rows to Oracle and finish the direct path load,
+ * 		which saves the loaded data in the table.
+ * 		Returns the number of rows that were sent.
+ */
+unsigned int
+oracleDirectPathFinish(oracleSession *session)
+{
+	struct dirPathEntry *dirpath = session->connp->dirpath;
+	unsigned int rows = 0;
+
+	if (dirpath == NULL)
+		oracleError(FDW_ERROR, "oracleDirectPathFinish internal error: no direct path load in progress");
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	if (dirpath->rows > 0)
+		rows = loadDirPathRows(session);
+
+	if (checkerr(
+		OCIDirPathFinish(dirpath->dpctx, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error loading data: OCIDirPathFinish failed to finish the load",
+			oraMessage);
+	}
+
+	freeDirPath(session->connp, session->envp->errhp, 0);
+
+	return rows;
+}
+
+/*
+ * oracleFetchNext
+ * 		Fetch the next result rows if the buffer is empty.
+ * 		Return the position of the next result in the result buffer
+ * 		if there is one, else 0.
+ * 		With double buffering, the rows have already been fetched into
+ * 		the other buffer by a non-blocking fetch; wait for it to finish,
+ * 		switch buffers and start fetching into the buffer just processed.
+ */
+unsigned int
+oracleFetchNext(oracleSession *session, unsigned int prefetch)
+{
+	sword result;
+	ub4 rowcount;
+
+	/* make sure there is a statement handle stored in "session" */
+	if (session->stmthp == NULL)
+		oracleError(FDW_ERROR, "oracleFetchNext internal error: statement handle is NULL");
+
+	/* if there are still rows in the result set, return the next one */
+	if (session->current_row < session->fetched_rows)
+		return session->buffer * session->buffer_rows + ++(session->current_row);
+
+	/* return 0 if we are done */
+	if (session->last_batch == 1)
+		return 0;
+
+	if (session->buffer_rows > 0)
+	{
+		/* after a non-blocking execution, the first switch yields no rows */
+		do
+			switchBuffer(session, prefetch);
+		while (session->fetched_rows == 0 && !session->last_batch);
+
+		if (session->fetched_rows == 0)
+			return 0;
+
+		return session->buffer * session->buffer_rows + ++(session->current_row);
+	}
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	/* fetch the next result rows */
+	result = checkerr(
+		OCIStmtFetch2(session->stmthp, session->envp->errhp, (ub4)prefetch, OCI_FETCH_NEXT, 0, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+
+	if (result != OCI_SUCCESS && result != OCI_NO_DATA)
+	{
+		oracleError_d(err_code == 8177 ? FDW_SERIALIZATION_FAILURE : FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCIStmtFetch2 failed to fetch next result rows",
+			oraMessage);
+	}
+
+	/* get the number of rows fetched */
+	if (checkerr(
+		OCIAttrGet((dvoid *)session->stmthp, (ub4)OCI_HTYPE_STMT,
+			(dvoid *)&rowcount, (ub4 *)0,
+			(ub4)OCI_ATTR_ROWS_FETCHED, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCIAttrGet failed to get number of affected rows",
+			oraMessage);
+	}
+	session->last_batch = (result == OCI_NO_DATA);
+	session->fetched_rows = (unsigned int)rowcount;
+	session->current_row = (rowcount == 0) ? 0 : 1;
+
+	return session->current_row;
+}
+
+/*
+ * oracleFetchReady
+ * 		Return 1 if the next call to oracleFetchNext won't have to wait
+ * 		for the Oracle server, else 0.
+ * 		For a query that is executed asynchronously, this polls the
+ * 		non-blocking call and starts the next fetch once it has finished.
+ */
+int
+oracleFetchReady(oracleSession *session, unsigned int prefetch)
+{
+	struct stmtHandleEntry *entry;
+	sword result;
+
+	/* make sure there is a statement handle stored in "session" */
+	if (session->stmthp == NULL)
+		oracleError(FDW_ERROR, "oracleFetchReady internal error: statement handle is NULL");
+
+	/* without double buffering, we cannot tell */
+	if (session->buffer_rows == 0)
+		return 1;
+
+	entry = findStmt(session->stmthp, session->connp);
+
+	while (session->current_row >= session->fetched_rows && !session->last_batch)
+	{
+		if (entry->fetch_srvp != NULL)
+		{
+			result = pollFetch(entry, session->envp->errhp);
+			if (result == OCI_STILL_EXECUTING)
+				return 0;
+
+			finishFetch(session->srvp, session->envp->errhp, result);
+		}
+
+		switchBuffer(session, prefetch);
+	}
+
+	return 1;
+}
+
+/*
+ * oracleExecuteCall
+ * 		Execute an Oracle statement that has no results.
+ */
+void
+oracleExecuteCall(oracleSession *session, char * const stmt)
+{
+	OCIStmt *stmthp = NULL;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	/* prepare the query */
+	if (checkerr(
+		OCIStmtPrepare2(session->connp->svchp, &stmthp, session->envp->errhp,
+			(text *)stmt, (ub4)strlen(stmt), (text *)NULL, (ub4)0,
+			(ub4) OCI_NTV_SYNTAX, (ub4) OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error executing statement: OCIStmtPrepare2 failed to prepare query",
+			oraMessage);
+	}
+
+	/* register statement handle */
+	registerStmt(stmthp, session->envp->envhp, session->connp);
+
+	if (checkerr(
+		OCIStmtExecute(session->connp->svchp, stmthp, session->envp->errhp, (ub4)1, (ub4)0,
+			(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		if (err_code == 24374)
+			oracleError(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"Oracle statement must not return a result");
+		else
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing statement: OCIStmtExecute failed to execute query",
+				oraMessage);
+	}
+
+	/* free the statement handle */
+	freeStmt(stmthp, session->connp, session->envp->errhp);
+}
+
+/*
+ * oracleGetLob
+ * 		Get the LOB contents and store them in *value and *value_len.
+ */
+void
+oracleGetLob(oracleSession *session, void *locptr, oraType type, char **value, long *value_len)
+{
+	OCILobLocator *locp = *(OCILobLocator **)locptr;
+	oraub8 amount_byte, amount_char, lobsize;
+	sword result = OCI_SUCCESS;
+
+	/* initialize result buffer length */
+	*value_len = 0;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	if (type == ORA_TYPE_BFILE)
+	{
+		/* BFILEs must be opened, LOBs not */
+		if (checkerr(
+			OCILobFileOpen(session->connp->svchp, session->envp->errhp, locp, OCI_FILE_READONLY),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error fetching result: OCILobFileOpen failed to open BFILE",
+				oraMessage);
+		}
+	}
+
+	/* get the size of the LOB */
+	if (checkerr(
+		OCILobGetLength2(session->connp->svchp, session->envp->errhp, locp, &lobsize),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCILobGetLength2 failed get the LOB size",
+			oraMessage);
+	}
 
 	/*
 	 * Read the LOB in chunks.
@@ -2439,69 +3271,300 @@ oracleClientVersion(int *major, int *minor, int *update, int *patch, int *port_p
 }
 
 /*
- * oracleServerVersion
- * 		Returns the five components of the server version.
+ * oracleServerVersion
+ * 		Returns the five components of the server version.
+ */
+void
+oracleServerVersion(oracleSession *session, int *major, int *minor, int *update, int *patch, int *port_patch)
+{
+	*major = session->server_version[0];
+	*minor = session->server_version[1];
+	*update = session->server_version[2];
+	*patch = session->server_version[3];
+	*port_patch = session->server_version[4];
+}
+
+/*
+ * oracleGetSCN
+ * 		Store the current system change number of the Oracle database
+ * 		as a string in "scn", which must have room for 41 bytes.
+ * 		This requires the SELECT privilege on V$DATABASE.
+ */
+void
+oracleGetSCN(oracleSession *session, char *scn)
+{
+	const char * const scn_query = "SELECT TO_CHAR(current_scn) FROM v$database";
+	OCIStmt *stmthp = NULL;
+	OCIDefine *defnhp = NULL;
+	sb2 ind = 0;
+	ub2 len = 0;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	/* prepare */
+	if (checkerr(
+		OCIStmtPrepare2(session->connp->svchp, &stmthp, session->envp->errhp,
+			(text *)scn_query, (ub4)strlen(scn_query), (text *)NULL, (ub4)0,
+			(ub4) OCI_NTV_SYNTAX, (ub4) OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error getting SCN: OCIStmtPrepare2 failed to prepare query",
+			oraMessage);
+	}
+
+	/* register statement handle */
+	registerStmt(stmthp, session->envp->envhp, session->connp);
+
+	/* define result value */
+	if (checkerr(
+		OCIDefineByPos(stmthp, &defnhp, session->envp->errhp, (ub4)1,
+			(dvoid *)scn, (sb4)41,
+			SQLT_STR, (dvoid *)&ind,
+			(ub2 *)&len, NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error getting SCN: OCIDefineByPos failed to define result value",
+			oraMessage);
+	}
+
+	/* execute */
+	if (checkerr(
+		OCIStmtExecute(session->connp->svchp, stmthp, session->envp->errhp, (ub4)1, (ub4)0,
+			(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		/* create a better message if we lack permissions on V$DATABASE */
+		if (err_code == 942)
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"no SELECT privilege on V$DATABASE in the remote database",
+				oraMessage);
+		else
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error getting SCN: OCIStmtExecute failed to execute query",
+				oraMessage);
+	}
+
+	freeStmt(stmthp, session->connp, session->envp->errhp);
+}
+
+/*
+ * getServerVersion
+ * 		Retrieves the server version and stores it in the service handle cache.
+ */
+void
+getServerVersion(struct srvEntry *srvp, OCIError *errhp)
+{
+	OraText version_text[1000];
+	ub4 version;
+
+	/* get version information from remote server */
+	if (checkerr(
+		OCIServerRelease(srvp->srvhp, errhp, version_text, 1000, OCI_HTYPE_SERVER, &version),
+		(dvoid *)errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_REPLY,
+			"error getting server version: OCIServerRelease failed to retrieve version",
+			oraMessage);
+	}
+
+	srvp->server_version[0] = (version >> 24) & 0x000000FF;
+	srvp->server_version[1] = (version >> 20) & 0x0000000F;
+	srvp->server_version[2] = (version >> 12) & 0x000000FF;
+	srvp->server_version[3] = (version >> 8) & 0x0000000F;
+	srvp->server_version[4] = (version >> 0) & 0x000000FF;
+}
+
+/*
+ * oracleGetGeometryType
+ * 		Get the MDSYS.DSO_GEOMETRY type.
+ * 		The result is cached in the session' connEntry.
+ */
+void *oracleGetGeometryType(oracleSession *session)
+{
+	if (session->connp->geomtype == NULL)
+	{
+		/* type is not cached, get it */
+		if (checkerr(
+			OCITypeByName(session->envp->envhp, session->envp->errhp, session->connp->svchp,
+				(const oratext *)"MDSYS", 5, (const oratext *)"SDO_GEOMETRY", 12, NULL, 0,
+				OCI_DURATION_SESSION, OCI_TYPEGET_HEADER,
+				&session->connp->geomtype), (dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"Error getting type MDSYS.SDO_GEOMETRY",
+				oraMessage);
+		}
+	}
+
+	return session->connp->geomtype;
+}
+
+/*
+ * oracleNumberToInt
+ * 		Convert an OCINumber to a 64-bit integer.
+ * 		Returns 0 if the number has a fractional part or is out of range, else 1.
+ */
+int
+oracleNumberToInt(oracleSession *session, const void *number, int64_t *result)
+{
+	boolean is_int;
+
+	if (checkerr(
+		OCINumberIsInt(session->envp->errhp, (const OCINumber *)number, &is_int),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCINumberIsInt failed to check NUMBER value",
+			oraMessage);
+	}
+
+	if (!is_int)
+		return 0;
+
+	/* this fails on overflow, which is not an error here */
+	if (OCINumberToInt(session->envp->errhp, (const OCINumber *)number,
+			(uword)sizeof(int64_t), OCI_NUMBER_SIGNED, (void *)result) != OCI_SUCCESS)
+		return 0;
+
+	return 1;
+}
+
+/*
+ * oracleNumberToDouble
+ * 		Convert an OCINumber to a double precision value.
+ */
+double
+oracleNumberToDouble(oracleSession *session, const void *number)
+{
+	double result;
+
+	if (checkerr(
+		OCINumberToReal(session->envp->errhp, (const OCINumber *)number,
+			(uword)sizeof(double), (void *)&result),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCINumberToReal failed to convert NUMBER value",
+			oraMessage);
+	}
+
+	return result;
+}
+
+/*
+ * oracleGetDateTime
+ * 		Get the components of a TIMESTAMP [WITH TIME ZONE] stored in an
+ * 		OCIDateTime descriptor.  "dtptr" points to the descriptor pointer.
+ * 		Years before Christ are negative, and there is no year 0.
+ * 		The fractional seconds are returned in nanoseconds.
+ * 		If "has_tz" is true, the time zone offset is returned in seconds
+ * 		east of UTC in "tz_offset".
  */
 void
-oracleServerVersion(oracleSession *session, int *major, int *minor, int *update, int *patch, int *port_patch)
+oracleGetDateTime(oracleSession *session, void *dtptr, int has_tz, int *year, int *month, int *day, int *hour, int *minute, int *second, int *nsec, int *tz_offset)
 {
-	*major = session->server_version[0];
-	*minor = session->server_version[1];
-	*update = session->server_version[2];
-	*patch = session->server_version[3];
-	*port_patch = session->server_version[4];
+	OCIDateTime *datetime = *(OCIDateTime **)dtptr;
+	sb2 yr;
+	ub1 mnth, dy, hr, mm, ss;
+	ub4 fsec;
+	sb1 tzh, tzm;
+
+	if (checkerr(
+		OCIDateTimeGetDate(session->envp->envhp, session->envp->errhp, datetime, &yr, &mnth, &dy),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCIDateTimeGetDate failed to get date",
+			oraMessage);
+	}
+
+	if (checkerr(
+		OCIDateTimeGetTime(session->envp->envhp, session->envp->errhp, datetime, &hr, &mm, &ss, &fsec),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCIDateTimeGetTime failed to get time",
+			oraMessage);
+	}
+
+	*year = (int)yr;
+	*month = (int)mnth;
+	*day = (int)dy;
+	*hour = (int)hr;
+	*minute = (int)mm;
+	*second = (int)ss;
+	*nsec = (int)fsec;
+
+	if (!has_tz)
+		return;
+
+	if (checkerr(
+		OCIDateTimeGetTimeZoneOffset(session->envp->envhp, session->envp->errhp, datetime, &tzh, &tzm),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCIDateTimeGetTimeZoneOffset failed to get time zone offset",
+			oraMessage);
+	}
+
+	*tz_offset = (int)tzh * 3600 + (int)tzm * 60;
 }
 
 /*
- * getServerVersion
- * 		Retrieves the server version and stores it in the service handle cache.
+ * oracleGetIntervalYM
+ * 		Get the components of an INTERVAL YEAR TO MONTH stored in an
+ * 		OCIInterval descriptor.  "intvptr" points to the descriptor pointer.
  */
 void
-getServerVersion(struct srvEntry *srvp, OCIError *errhp)
+oracleGetIntervalYM(oracleSession *session, void *intvptr, int *years, int *months)
 {
-	OraText version_text[1000];
-	ub4 version;
+	OCIInterval *interval = *(OCIInterval **)intvptr;
+	sb4 yr, mnth;
 
-	/* get version information from remote server */
 	if (checkerr(
-		OCIServerRelease(srvp->srvhp, errhp, version_text, 1000, OCI_HTYPE_SERVER, &version),
-		(dvoid *)errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		OCIIntervalGetYearMonth(session->envp->envhp, session->envp->errhp, &yr, &mnth, interval),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
 	{
-		oracleError_d(FDW_UNABLE_TO_CREATE_REPLY,
-			"error getting server version: OCIServerRelease failed to retrieve version",
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCIIntervalGetYearMonth failed to get interval",
 			oraMessage);
 	}
 
-	srvp->server_version[0] = (version >> 24) & 0x000000FF;
-	srvp->server_version[1] = (version >> 20) & 0x0000000F;
-	srvp->server_version[2] = (version >> 12) & 0x000000FF;
-	srvp->server_version[3] = (version >> 8) & 0x0000000F;
-	srvp->server_version[4] = (version >> 0) & 0x000000FF;
+	*years = (int)yr;
+	*months = (int)mnth;
 }
 
 /*
- * oracleGetGeometryType
- * 		Get the MDSYS.DSO_GEOMETRY type.
- * 		The result is cached in the session' connEntry.
+ * oracleGetIntervalDS
+ * 		Get the components of an INTERVAL DAY TO SECOND stored in an
+ * 		OCIInterval descriptor.  "intvptr" points to the descriptor pointer.
+ * 		All components have the sign of the interval, and the fractional
+ * 		seconds are returned in nanoseconds.
  */
-void *oracleGetGeometryType(oracleSession *session)
+void
+oracleGetIntervalDS(oracleSession *session, void *intvptr, int *days, int *hours, int *minutes, int *seconds, int *nsec)
 {
-	if (session->connp->geomtype == NULL)
+	OCIInterval *interval = *(OCIInterval **)intvptr;
+	sb4 dy, hr, mm, ss, fsec;
+
+	if (checkerr(
+		OCIIntervalGetDaySecond(session->envp->envhp, session->envp->errhp, &dy, &hr, &mm, &ss, &fsec, interval),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
 	{
-		/* type is not cached, get it */
-		if (checkerr(
-			OCITypeByName(session->envp->envhp, session->envp->errhp, session->connp->svchp,
-				(const oratext *)"MDSYS", 5, (const oratext *)"SDO_GEOMETRY", 12, NULL, 0,
-				OCI_DURATION_SESSION, OCI_TYPEGET_HEADER,
-				&session->connp->geomtype), (dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
-		{
-			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
-				"Error getting type MDSYS.SDO_GEOMETRY",
-				oraMessage);
-		}
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error converting result: OCIIntervalGetDaySecond failed to get interval",
+			oraMessage);
 	}
 
-	return session->connp->geomtype;
+	*days = (int)dy;
+	*hours = (int)hr;
+	*minutes = (int)mm;
+	*seconds = (int)ss;
+	*nsec = (int)fsec;
 }
 
 /*
@@ -2556,6 +3619,10 @@ int oracleGetImportColumn(oracleSession *session, char *dblink, char *schema, ch
 	*tabname = s_tabname;
 	*colname = s_colname;
 
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
 	/* when first called, check if the schema does exist */
 	if (session->stmthp == NULL)
 	{
@@ -2854,59 +3921,340 @@ int oracleGetImportColumn(oracleSession *session, char *dblink, char *schema, ch
 			*type = ORA_TYPE_CHAR;
 		else if (strncmp(typename, "TIMESTAMP", 9) == 0)
 		{
-			if (strlen(typename) < 17)
-				*type = ORA_TYPE_TIMESTAMP;
-			else
-				*type = ORA_TYPE_TIMESTAMPTZ;
+			if (strlen(typename) < 17)
+				*type = ORA_TYPE_TIMESTAMP;
+			else
+				*type = ORA_TYPE_TIMESTAMPTZ;
+		}
+		else if (strcmp(typename, "RAW") == 0)
+			*type = ORA_TYPE_RAW;
+		else if (strcmp(typename, "BLOB") == 0)
+			*type = ORA_TYPE_BLOB;
+		else if (strcmp(typename, "CLOB") == 0)
+			*type = ORA_TYPE_CLOB;
+		else if (strcmp(typename, "NCLOB") == 0)
+			*type = ORA_TYPE_NCLOB;
+		else if (strcmp(typename, "BFILE") == 0)
+			*type = ORA_TYPE_BFILE;
+		else if (strcmp(typename, "LONG") == 0)
+			*type = ORA_TYPE_LONG;
+		else if (strcmp(typename, "LONG RAW") == 0)
+			*type = ORA_TYPE_LONGRAW;
+		else if (strcmp(typename, "SDO_GEOMETRY") == 0
+				&& ind_typeowner == OCI_IND_NOTNULL && strcmp(typeowner, "MDSYS") == 0)
+			*type = ORA_TYPE_GEOMETRY;
+		else if (strcmp(typename, "XMLTYPE") == 0
+				&& ind_typeowner == OCI_IND_NOTNULL
+				&& (strcmp(typeowner, "PUBLIC") == 0 || strcmp(typeowner, "SYS") == 0))
+			*type = ORA_TYPE_XMLTYPE;
+		else if (strcmp(typename, "FLOAT") == 0)
+			*type = ORA_TYPE_FLOAT;
+		else if (strncmp(typename, "NVARCHAR", 8) == 0)
+			*type = ORA_TYPE_NVARCHAR2;
+		else if (strcmp(typename, "NCHAR") == 0)
+			*type = ORA_TYPE_NCHAR;
+		else if (strncmp(typename, "INTERVAL DAY", 12) == 0)
+			*type = ORA_TYPE_INTERVALD2S;
+		else if (strncmp(typename, "INTERVAL YEAR", 13) == 0)
+			*type = ORA_TYPE_INTERVALY2M;
+		else if (strcmp(typename, "BINARY_FLOAT") == 0)
+			*type = ORA_TYPE_BINARYFLOAT;
+		else if (strcmp(typename, "BINARY_DOUBLE") == 0)
+			*type = ORA_TYPE_BINARYDOUBLE;
+		else
+			*type = ORA_TYPE_OTHER;
+
+		/* set character length, precision and scale to 0 if it was a NULL value */
+		if (ind_charlen != OCI_IND_NOTNULL)
+			*charlen = 0;
+		if (ind_precision != OCI_IND_NOTNULL)
+			*typeprec = 0;
+		if (ind_scale != OCI_IND_NOTNULL)
+			*typescale = 0;
+	}
+
+	return 1;
+}
+
+/*
+ * oracleGetTableStatistics
+ * 		Get the number of rows of an Oracle table from the optimizer statistics.
+ * 		If "schema" is NULL, the current schema is used.
+ * 		Returns 0 if the table has no statistics, else 1.
+ */
+int
+oracleGetTableStatistics(oracleSession *session, char *schema, char *table, double *num_rows)
+{
+	const char * const stat_query =
+		"SELECT num_rows FROM all_tab_statistics\n"
+		"WHERE owner = nvl(:owner, sys_context('USERENV', 'CURRENT_SCHEMA'))\n"
+		"  AND table_name = :tab AND partition_name IS NULL AND num_rows IS NOT NULL";
+	dvoid *res[1] = { (dvoid *)num_rows };
+	sb4 res_size[1] = { sizeof(double) };
+	ub2 res_type[1] = { SQLT_FLT }, res_len[1];
+	sb2 res_ind[1];
+	OCIStmt *stmthp = NULL;
+	sword result;
+
+	result = oracleStatisticsQuery(session, &stmthp, stat_query, schema, table, NULL,
+								   1, res, res_size, res_type, res_len, res_ind);
+
+	/* close the statement */
+	freeStmt(stmthp, session->connp, session->envp->errhp);
+
+	return (result != OCI_NO_DATA);
+}
+
+/*
+ * oracleGetColumnStatistics
+ * 		Get the optimizer statistics for a column of an Oracle table.
+ * 		"frequency" is set to 1 if the column has a frequency histogram,
+ * 		that is, a histogram that contains values with their row counts.
+ * 		Returns 0 if the column has no statistics, else 1.
+ */
+int
+oracleGetColumnStatistics(oracleSession *session, char *schema, char *table, char *column, double *num_distinct, double *num_nulls, int *avg_col_len, double *sample_size, int *frequency)
+{
+	const char * const stat_query =
+		"SELECT num_distinct, nvl(num_nulls, 0), nvl(avg_col_len, 0), nvl(sample_size, 0),\n"
+		"       CASE WHEN histogram IN ('FREQUENCY', 'TOP-FREQUENCY') THEN 1 ELSE 0 END\n"
+		"FROM all_tab_col_statistics\n"
+		"WHERE owner = nvl(:owner, sys_context('USERENV', 'CURRENT_SCHEMA'))\n"
+		"  AND table_name = :tab AND column_name = :col AND num_distinct IS NOT NULL";
+	dvoid *res[5] = { (dvoid *)num_distinct, (dvoid *)num_nulls, (dvoid *)avg_col_len,
+					  (dvoid *)sample_size, (dvoid *)frequency };
+	sb4 res_size[5] = { sizeof(double), sizeof(double), sizeof(int), sizeof(double), sizeof(int) };
+	ub2 res_type[5] = { SQLT_FLT, SQLT_FLT, SQLT_INT, SQLT_FLT, SQLT_INT }, res_len[5];
+	sb2 res_ind[5];
+	OCIStmt *stmthp = NULL;
+	sword result;
+
+	result = oracleStatisticsQuery(session, &stmthp, stat_query, schema, table, column,
+								   5, res, res_size, res_type, res_len, res_ind);
+
+	/* close the statement */
+	freeStmt(stmthp, session->connp, session->envp->errhp);
+
+	return (result != OCI_NO_DATA);
+}
+
+/*
+ * oracleGetHistogram
+ * 		Get the next histogram entry for a column of an Oracle table.
+ * 		The entries are ordered by "endpoint", which is the cumulative
+ * 		row count for frequency histograms.
+ * 		"value" is set to the endpoint value as a string, or to NULL if Oracle
+ * 		does not store it or stores only a prefix of it (the first 32 bytes,
+ * 		from Oracle 12c on 64 bytes).  "type" determines how the value is converted.
+ * 		Returns 0 if there are no more entries, else 1.
+ */
+int
+oracleGetHistogram(oracleSession *session, char *schema, char *table, char *column, oraType type, double *endpoint, char **value)
+{
+	/* the static variables will contain data returned to the caller */
+	static double s_endpoint;
+	static char s_value[4001];
+	static sb2 s_ind[2];
+	static ub2 s_len[2];
+	const char * const hist_query_template =
+		"SELECT endpoint_number, %s FROM all_tab_histograms\n"
+		"WHERE owner = nvl(:owner, sys_context('USERENV', 'CURRENT_SCHEMA'))\n"
+		"  AND table_name = :tab AND column_name = :col\n"
+		"ORDER BY endpoint_number";
+	const char *value_expr;
+	char *hist_query, actual_value_expr[100];
+	dvoid *res[2] = { (dvoid *)&s_endpoint, (dvoid *)s_value };
+	sb4 res_size[2] = { sizeof(double), sizeof(s_value) };
+	ub2 res_type[2] = { SQLT_FLT, SQLT_STR };
+	sword result;
+
+	/* when first called, run the query */
+	if (session->stmthp == NULL)
+	{
+		/*
+		 * Numbers and datetime values are stored in ENDPOINT_VALUE,
+		 * the latter as Julian day with the time of day as fraction.
+		 */
+		switch (type)
+		{
+			case ORA_TYPE_NUMBER:
+			case ORA_TYPE_FLOAT:
+			case ORA_TYPE_BINARYFLOAT:
+			case ORA_TYPE_BINARYDOUBLE:
+				value_expr = "to_char(endpoint_value, 'TM9', 'NLS_NUMERIC_CHARACTERS=''.,''')";
+				break;
+			case ORA_TYPE_DATE:
+			case ORA_TYPE_TIMESTAMP:
+				value_expr = "to_char(to_date(to_char(trunc(endpoint_value)), 'J')"
+							 " + (endpoint_value - trunc(endpoint_value)), 'YYYY-MM-DD HH24:MI:SS')";
+				break;
+			default:
+				/* a value of maximal length may be truncated */
+				snprintf(actual_value_expr, sizeof(actual_value_expr),
+						 "CASE WHEN lengthb(endpoint_actual_value) < %d THEN endpoint_actual_value END",
+						 (session->server_version[0] >= 12) ? 64 : 32);
+				value_expr = actual_value_expr;
+		}
+
+		hist_query = oracleAlloc(strlen(hist_query_template) + strlen(value_expr) + 1);
+		sprintf(hist_query, hist_query_template, value_expr);
+
+		result = oracleStatisticsQuery(session, &(session->stmthp), hist_query, schema, table, column,
+									   2, res, res_size, res_type, s_len, s_ind);
+
+		oracleFree(hist_query);
+	}
+	else
+	{
+		/* fetch the next result row */
+		result = checkerr(
+			OCIStmtFetch2(session->stmthp, session->envp->errhp, 1, OCI_FETCH_NEXT, 0, OCI_DEFAULT),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+
+		if (result != OCI_SUCCESS && result != OCI_NO_DATA)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error importing statistics: OCIStmtFetch2 failed to fetch next result row",
+				oraMessage);
+		}
+	}
+
+	if (result == OCI_NO_DATA)
+	{
+		oracleCloseStatement(session);
+		return 0;
+	}
+
+	*endpoint = s_endpoint;
+	*value = (s_ind[1] == OCI_IND_NOTNULL) ? s_value : NULL;
+
+	return 1;
+}
+
+/*
+ * oracleStatisticsQuery
+ * 		This is a utility function called by the functions that
+ * 		get optimizer statistics from the Oracle data dictionary.
+ * 		Prepares "query" in "stmthp", binds :owner, :tab and
+ * 		(if "column" is not NULL) :col, defines the result values
+ * 		and executes the statement to get the first result row.
+ * 		Returns OCI_NO_DATA if there is no result row.
+ */
+sword
+oracleStatisticsQuery(oracleSession *session, OCIStmt **stmthp, const char *query, char *schema, char *table, char *column, int nres, dvoid **res, sb4 *res_size, ub2 *res_type, ub2 *res_len, sb2 *res_ind)
+{
+	OCIDefine *defnhp;
+	OCIBind *bndhp;
+	sb2 ind_owner, ind_tab = 0, ind_col = 0;
+	ub4 prefetch_rows = 50;
+	sword result;
+	int i;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	/* prepare the query */
+	if (checkerr(
+		OCIStmtPrepare2(session->connp->svchp, stmthp, session->envp->errhp,
+			(text *)query, (ub4)strlen(query), (text *)NULL, (ub4)0,
+			(ub4) OCI_NTV_SYNTAX, (ub4) OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error importing statistics: OCIStmtPrepare2 failed to prepare statistics query",
+			oraMessage);
+	}
+
+	/* register statement handle */
+	registerStmt(*stmthp, session->envp->envhp, session->connp);
+
+	/* set prefetch options */
+	if (checkerr(
+		OCIAttrSet((dvoid *)*stmthp, OCI_HTYPE_STMT, (dvoid *)&prefetch_rows, 0,
+			OCI_ATTR_PREFETCH_ROWS, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error importing statistics: OCIAttrSet failed to set number of prefetched rows in statement handle",
+			oraMessage);
+	}
+
+	/* bind the parameters, a NULL owner stands for the current schema */
+	bndhp = NULL;
+	ind_owner = (schema == NULL) ? -1 : 0;
+	if (checkerr(
+		OCIBindByName(*stmthp, &bndhp, session->envp->errhp, (text *)":owner",
+			(sb4)6, (dvoid *)schema, (sb4)((schema == NULL) ? 0 : strlen(schema) + 1),
+			SQLT_STR, (dvoid *)&ind_owner,
+			NULL, NULL, (ub4)0, NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error importing statistics: OCIBindByName failed to bind parameter",
+			oraMessage);
+	}
+
+	bndhp = NULL;
+	if (checkerr(
+		OCIBindByName(*stmthp, &bndhp, session->envp->errhp, (text *)":tab",
+			(sb4)4, (dvoid *)table, (sb4)(strlen(table) + 1),
+			SQLT_STR, (dvoid *)&ind_tab,
+			NULL, NULL, (ub4)0, NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error importing statistics: OCIBindByName failed to bind parameter",
+			oraMessage);
+	}
+
+	if (column != NULL)
+	{
+		bndhp = NULL;
+		if (checkerr(
+			OCIBindByName(*stmthp, &bndhp, session->envp->errhp, (text *)":col",
+				(sb4)4, (dvoid *)column, (sb4)(strlen(column) + 1),
+				SQLT_STR, (dvoid *)&ind_col,
+				NULL, NULL, (ub4)0, NULL, OCI_DEFAULT),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error importing statistics: OCIBindByName failed to bind parameter",
+				oraMessage);
+		}
+	}
+
+	/* define result values */
+	for (i=0; i<nres; ++i)
+	{
+		defnhp = NULL;
+		if (checkerr(
+			OCIDefineByPos(*stmthp, &defnhp, session->envp->errhp, (ub4)(i + 1),
+				(dvoid *)res[i], res_size[i],
+				res_type[i], (dvoid *)&res_ind[i],
+				&res_len[i], NULL, OCI_DEFAULT),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error importing statistics: OCIDefineByPos failed to define result value",
+				oraMessage);
 		}
-		else if (strcmp(typename, "RAW") == 0)
-			*type = ORA_TYPE_RAW;
-		else if (strcmp(typename, "BLOB") == 0)
-			*type = ORA_TYPE_BLOB;
-		else if (strcmp(typename, "CLOB") == 0)
-			*type = ORA_TYPE_CLOB;
-		else if (strcmp(typename, "NCLOB") == 0)
-			*type = ORA_TYPE_NCLOB;
-		else if (strcmp(typename, "BFILE") == 0)
-			*type = ORA_TYPE_BFILE;
-		else if (strcmp(typename, "LONG") == 0)
-			*type = ORA_TYPE_LONG;
-		else if (strcmp(typename, "LONG RAW") == 0)
-			*type = ORA_TYPE_LONGRAW;
-		else if (strcmp(typename, "SDO_GEOMETRY") == 0
-				&& ind_typeowner == OCI_IND_NOTNULL && strcmp(typeowner, "MDSYS") == 0)
-			*type = ORA_TYPE_GEOMETRY;
-		else if (strcmp(typename, "XMLTYPE") == 0
-				&& ind_typeowner == OCI_IND_NOTNULL
-				&& (strcmp(typeowner, "PUBLIC") == 0 || strcmp(typeowner, "SYS") == 0))
-			*type = ORA_TYPE_XMLTYPE;
-		else if (strcmp(typename, "FLOAT") == 0)
-			*type = ORA_TYPE_FLOAT;
-		else if (strncmp(typename, "NVARCHAR", 8) == 0)
-			*type = ORA_TYPE_NVARCHAR2;
-		else if (strcmp(typename, "NCHAR") == 0)
-			*type = ORA_TYPE_NCHAR;
-		else if (strncmp(typename, "INTERVAL DAY", 12) == 0)
-			*type = ORA_TYPE_INTERVALD2S;
-		else if (strncmp(typename, "INTERVAL YEAR", 13) == 0)
-			*type = ORA_TYPE_INTERVALY2M;
-		else if (strcmp(typename, "BINARY_FLOAT") == 0)
-			*type = ORA_TYPE_BINARYFLOAT;
-		else if (strcmp(typename, "BINARY_DOUBLE") == 0)
-			*type = ORA_TYPE_BINARYDOUBLE;
-		else
-			*type = ORA_TYPE_OTHER;
+	}
 
-		/* set character length, precision and scale to 0 if it was a NULL value */
-		if (ind_charlen != OCI_IND_NOTNULL)
-			*charlen = 0;
-		if (ind_precision != OCI_IND_NOTNULL)
-			*typeprec = 0;
-		if (ind_scale != OCI_IND_NOTNULL)
-			*typescale = 0;
+	/* execute the query and get the first result row */
+	result = checkerr(
+		OCIStmtExecute(session->connp->svchp, *stmthp, session->envp->errhp, (ub4)1, (ub4)0,
+			(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+
+	if (result != OCI_SUCCESS && result != OCI_NO_DATA)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error importing statistics: OCIStmtExecute failed to execute statistics query",
+			oraMessage);
 	}
 
-	return 1;
+	return result;
 }
 
 /*
@@ -3047,6 +4395,10 @@ closeSession(OCIEnv *envhp, OCIServer *srvhp, OCISession *userhp, int disconnect
 			oracleError(FDW_ERROR, "closeSession internal error: user handle not found in cache");
 	}
 
+	/* abort a direct path load that was not finished */
+	if (connp->dirpath != NULL)
+		freeDirPath(connp, envp->errhp, 1);
+
 	/* terminate the session */
 	if (checkerr(
 		OCISessionEnd(connp->svchp, envp->errhp, connp->userhp, OCI_DEFAULT),
@@ -3229,91 +4581,450 @@ registerStmt(OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp)
 	/* add the handle to the linked list */
 	entry->stmthp = stmthp;
 	entry->loclist = NULL;
+	entry->fetch_srvp = NULL;
+	entry->exec_svchp = NULL;
+	entry->fetch_rows = 0;
+	entry->rows_fetched = 0;
+	entry->no_data = 0;
+	entry->exec_envhp = NULL;
+	entry->exec_indicators = NULL;
+	entry->exec_collections = NULL;
+	entry->exec_params = 0;
 	entry->next = connp->stmtlist;
 	connp->stmtlist = entry;
 }
 
 /*
- * allocLobLocator
- * 		Allocate an Oracle LOB locator, store it in the statement's linked list.
+ * allocLobLocator
+ * 		Allocate an Oracle LOB locator, store it in the statement's linked list.
+ */
+
+void
+allocLobLocator(OCILobLocator **locpp, OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp, oraError error, const char *errmsg)
+{
+	allocDescriptor((void **)locpp, OCI_DTYPE_LOB, stmthp, envhp, connp, error, errmsg);
+}
+
+/*
+ * allocDescriptor
+ * 		Allocate an Oracle descriptor of type "dtype", store it in the statement's linked list.
+ */
+
+void
+allocDescriptor(void **descpp, ub4 dtype, OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp, oraError error, const char *errmsg)
+{
+	struct stmtHandleEntry *entry;
+	struct lobLocatorEntry *locentry;
+
+	/* find the statement handle in the linked list */
+	for (entry = connp->stmtlist; entry != NULL; entry = entry->next)
+		if (entry->stmthp == stmthp)
+			break;
+
+	if (entry == NULL)
+		oracleError(FDW_ERROR, "internal error allocating descriptor: statement not found in list");
+
+	/* create entry for the linked list */
+	if ((locentry = malloc(sizeof(struct lobLocatorEntry))) == NULL)
+	{
+		oracleError_i(FDW_OUT_OF_MEMORY,
+			"error allocating handle: failed to allocate %d bytes of memory",
+			sizeof(struct lobLocatorEntry));
+	}
+
+	if (OCIDescriptorAlloc((const dvoid *)envhp, descpp, dtype, (size_t)0, NULL) != OCI_SUCCESS)
+	{
+		free(locentry);
+		oracleError(error, errmsg);
+	}
+
+	/* add the handle to the linked list */
+	locentry->lobloc = *descpp;
+	locentry->dtype = dtype;
+	locentry->next = entry->loclist;
+	entry->loclist = locentry;
+}
+
+/*
+ * freeStmt
+ * 		Free an Oracle statement handle and all its LOB locators.
+ */
+
+void
+freeStmt(OCIStmt *stmthp, struct connEntry *connp, OCIError *errhp)
+{
+	struct stmtHandleEntry *entry, *preventry = NULL;
+	struct lobLocatorEntry *locentry;
+
+	/* find it in the linked list */
+	for (entry = connp->stmtlist; entry != NULL; entry = entry->next)
+	{
+		if (entry->stmthp == stmthp)
+			break;
+
+		preventry = entry;
+	}
+
+	if (entry == NULL)
+		oracleError(FDW_ERROR, "internal error freeing statement handle: not found in list");
+
+	/* interrupt a non-blocking fetch on the statement */
+	if (entry->fetch_srvp != NULL)
+		cancelFetch(entry->fetch_srvp, errhp);
+	freeExecuteParams(entry, errhp);
+
+	/* free all the LOB locators and other descriptors */
+	while (entry->loclist != NULL)
+	{
+		(void)OCIDescriptorFree(entry->loclist->lobloc, entry->loclist->dtype);
+		locentry = entry->loclist->next;
+		free(entry->loclist);
+		entry->loclist = locentry;
+	}
+
+	/* free the statement handle */
+	(void)OCIStmtRelease(stmthp, errhp, (const OraText *)NULL, (ub4)0, OCI_DEFAULT);
+
+	/* remove it */
+	if (preventry == NULL)
+		connp->stmtlist = entry->next;
+	else
+		preventry->next = entry->next;
+
+	free(entry);
+}
+
+/*
+ * findStmt
+ * 		Find the entry for a statement handle in the connection's linked list.
+ */
+struct stmtHandleEntry *
+findStmt(OCIStmt *stmthp, struct connEntry *connp)
+{
+	struct stmtHandleEntry *entry;
+
+	for (entry = connp->stmtlist; entry != NULL; entry = entry->next)
+		if (entry->stmthp == stmthp)
+			return entry;
+
+	oracleError(FDW_ERROR, "internal error: statement handle not found in list");
+	return NULL;  /* unreachable, keeps the compiler quiet */
+}
+
+/*
+ * setNonblocking
+ * 		Put the server connection into non-blocking mode or back
+ * 		into blocking mode.  Setting the attribute toggles the mode,
+ * 		so we have to check the current mode first.
+ */
+sword
+setNonblocking(struct srvEntry *srvp, OCIError *errhp, int on)
+{
+	ub1 mode = 0;
+	sword result;
+
+	result = OCIAttrGet((dvoid *)srvp->srvhp, (ub4)OCI_HTYPE_SERVER,
+				(dvoid *)&mode, (ub4 *)0,
+				(ub4)OCI_ATTR_NONBLOCKING_MODE, errhp);
+	if (result != OCI_SUCCESS)
+		return result;
+
+	if ((mode != 0) == (on != 0))
+		return OCI_SUCCESS;
+
+	return OCIAttrSet((dvoid *)srvp->srvhp, (ub4)OCI_HTYPE_SERVER,
+				(dvoid *)0, (ub4)0,
+				(ub4)OCI_ATTR_NONBLOCKING_MODE, errhp);
+}
+
+/*
+ * defineResultBuffer
+ * 		Redefine the result columns of a double buffered query
+ * 		so that the next fetch stores the rows in "buffer" (0 or 1).
+ */
+void
+defineResultBuffer(oracleSession *session, unsigned int buffer)
+{
+	const struct oraTable *oraTable = session->oraTable;
+	unsigned int offset = buffer * session->buffer_rows;
+	const ub1 nchar = SQLCS_NCHAR;
+	int i, col_pos = 0;
+
+	for (i=0; i<oraTable->ncols; ++i)
+	{
+		struct oraColumn *col = oraTable->cols[i];
+
+		if (!col->used)
+			continue;
+
+		/* reuse the define handle from oraclePrepareQuery */
+		if (checkerr(
+			OCIDefineByPos(session->stmthp, &session->defines[i], session->envp->errhp, (ub4)++col_pos,
+				(dvoid *)(col->val + offset * col->val_size), (sb4)col->val_size,
+				getDefineType(col), (dvoid *)(col->val_null + offset),
+				(ub2 *)(col->val_len + offset), NULL, OCI_DEFAULT),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error fetching result: OCIDefineByPos failed to define result value",
+				oraMessage);
+		}
+
+		if (session->have_nchar
+			&& (col->oratype == ORA_TYPE_NVARCHAR2 || col->oratype == ORA_TYPE_NCHAR)
+			&& checkerr(
+				OCIAttrSet((void *)session->defines[i], OCI_HTYPE_DEFINE, (void *)&nchar, 0,
+					OCI_ATTR_CHARSET_FORM, session->envp->errhp),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error fetching result: OCIAttrSet failed to set charset form on result value",
+				oraMessage);
+		}
+	}
+}
+
+/*
+ * startFetch
+ * 		Start a non-blocking fetch of "rows" rows into the result buffer
+ * 		that is not in use.  The fetch is completed by finishFetch,
+ * 		either when the rows are needed or before anything else
+ * 		is done on the server connection.
+ */
+void
+startFetch(oracleSession *session, ub4 rows)
+{
+	struct stmtHandleEntry *entry = findStmt(session->stmthp, session->connp);
+	sword result;
+
+	/* there can be only one operation in progress on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	defineResultBuffer(session, 1 - session->buffer);
+
+	if (checkerr(
+		setNonblocking(session->srvp, session->envp->errhp, 1),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCIAttrSet failed to set non-blocking mode",
+			oraMessage);
+	}
+
+	entry->fetch_srvp = session->srvp;
+	entry->fetch_rows = rows;
+	session->srvp->pending_fetch = entry;
+
+	/* this sends the request and normally returns OCI_STILL_EXECUTING */
+	result = OCIStmtFetch2(session->stmthp, session->envp->errhp, rows, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+
+	if (result != OCI_STILL_EXECUTING)
+		finishFetch(session->srvp, session->envp->errhp, result);
+}
+
+/*
+ * switchBuffer
+ * 		Wait for the non-blocking fetch, unless someone else already did,
+ * 		and make the buffer with the fetched rows the current one.
+ * 		Then start fetching the next rows into the other buffer.
+ */
+void
+switchBuffer(oracleSession *session, unsigned int prefetch)
+{
+	struct stmtHandleEntry *entry = findStmt(session->stmthp, session->connp);
+
+	if (entry->fetch_srvp != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	session->buffer = 1 - session->buffer;
+	session->last_batch = entry->no_data;
+	session->fetched_rows = entry->rows_fetched;
+	session->current_row = 0;
+
+	if (!session->last_batch)
+		startFetch(session, (ub4)prefetch);
+}
+
+/*
+ * startExecute
+ * 		Start executing a query in non-blocking mode without fetching rows.
+ * 		It is completed by finishFetch like a non-blocking fetch,
+ * 		so that the first rows can be fetched with startFetch.
+ */
+void
+startExecute(oracleSession *session)
+{
+	struct stmtHandleEntry *entry = findStmt(session->stmthp, session->connp);
+	sword result;
+
+	/* there can be only one operation in progress on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	if (checkerr(
+		setNonblocking(session->srvp, session->envp->errhp, 1),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error executing query: OCIAttrSet failed to set non-blocking mode",
+			oraMessage);
+	}
+
+	entry->fetch_srvp = session->srvp;
+	entry->exec_svchp = session->connp->svchp;
+	entry->fetch_rows = 0;
+	session->srvp->pending_fetch = entry;
+
+	result = OCIStmtExecute(session->connp->svchp, session->stmthp, session->envp->errhp, (ub4)0, (ub4)0,
+				(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT);
+
+	if (result != OCI_STILL_EXECUTING)
+		finishFetch(session->srvp, session->envp->errhp, result);
+}
+
+/*
+ * pollFetch
+ * 		Repeat the call that started the non-blocking operation
+ * 		on the statement, as OCI requires.
  */
+sword
+pollFetch(struct stmtHandleEntry *entry, OCIError *errhp)
+{
+	if (entry->exec_svchp != NULL)
+		return OCIStmtExecute(entry->exec_svchp, entry->stmthp, errhp, (ub4)0, (ub4)0,
+					(CONST OCISnapshot *)NULL, (OCISnapshot *)NULL, OCI_DEFAULT);
+	else
+		return OCIStmtFetch2(entry->stmthp, errhp, entry->fetch_rows, OCI_FETCH_NEXT, 0, OCI_DEFAULT);
+}
 
+/*
+ * finishFetch
+ * 		Complete the non-blocking fetch or execution on the server connection,
+ * 		"result" is the status of the last call to OCIStmtFetch2 or OCIStmtExecute.
+ * 		The number of rows fetched is stored in the statement's entry,
+ * 		and the connection is put back into blocking mode.
+ */
 void
-allocLobLocator(OCILobLocator **locpp, OCIStmt *stmthp, OCIEnv *envhp, struct connEntry *connp, oraError error, const char *errmsg)
+finishFetch(struct srvEntry *srvp, OCIError *errhp, sword result)
 {
-	struct stmtHandleEntry *entry;
-	struct lobLocatorEntry *locentry;
+	struct stmtHandleEntry *entry = srvp->pending_fetch;
+	int is_execute = (entry->exec_svchp != NULL);
+	ub4 rowcount;
+	long wait = 100L;
 
-	/* find the statement handle in the linked list */
-	for (entry = connp->stmtlist; entry != NULL; entry = entry->next)
-		if (entry->stmthp == stmthp)
-			break;
+	/*
+	 * A call in non-blocking mode has to be repeated until it is done.
+	 * Short calls should not be delayed much, but for long ones we don't
+	 * want to spin, so double the wait time up to 10 milliseconds.
+	 */
+	while (result == OCI_STILL_EXECUTING)
+	{
+		oracleSleep(wait);
+		if (wait < 10000L)
+			wait *= 2;
 
-	if (entry == NULL)
-		oracleError(FDW_ERROR, "internal error allocating LOB locator: statement not found in list");
+		result = pollFetch(entry, errhp);
+	}
 
-	/* create entry for the linked list */
-	if ((locentry = malloc(sizeof(struct lobLocatorEntry))) == NULL)
+	srvp->pending_fetch = NULL;
+	entry->fetch_srvp = NULL;
+	entry->exec_svchp = NULL;
+
+	/* get the error message before anything else overwrites it */
+	result = checkerr(result, (dvoid *)errhp, OCI_HTYPE_ERROR);
+
+	(void)setNonblocking(srvp, errhp, 0);
+
+	/* OCI doesn't need the parameters of the execution any more */
+	if (is_execute)
+		freeExecuteParams(entry, errhp);
+
+	if (is_execute && result != OCI_SUCCESS)
 	{
-		oracleError_i(FDW_OUT_OF_MEMORY,
-			"error allocating handle: failed to allocate %d bytes of memory",
-			sizeof(struct lobLocatorEntry));
+		oracleError_d(err_code == 8177 ? FDW_SERIALIZATION_FAILURE : FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error executing query: OCIStmtExecute failed to execute remote query",
+			oraMessage);
 	}
 
-	if (OCIDescriptorAlloc((const dvoid *)envhp, (void **)locpp, OCI_DTYPE_LOB, (size_t)0, NULL) != OCI_SUCCESS)
+	if (result != OCI_SUCCESS && result != OCI_NO_DATA)
 	{
-		free(locentry);
-		oracleError(error, errmsg);
+		oracleError_d(err_code == 8177 ? FDW_SERIALIZATION_FAILURE : FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCIStmtFetch2 failed to fetch next result rows",
+			oraMessage);
 	}
 
-	/* add the handle to the linked list */
-	locentry->lobloc = *locpp;
-	locentry->next = entry->loclist;
-	entry->loclist = locentry;
+	/* no rows have been fetched yet */
+	if (is_execute)
+	{
+		entry->no_data = 0;
+		entry->rows_fetched = 0;
+		return;
+	}
+
+	/* get the number of rows fetched */
+	if (checkerr(
+		OCIAttrGet((dvoid *)entry->stmthp, (ub4)OCI_HTYPE_STMT,
+			(dvoid *)&rowcount, (ub4 *)0,
+			(ub4)OCI_ATTR_ROWS_FETCHED, errhp),
+		(dvoid *)errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error fetching result: OCIAttrGet failed to get number of affected rows",
+			oraMessage);
+	}
+
+	entry->no_data = (result == OCI_NO_DATA);
+	entry->rows_fetched = (unsigned int)rowcount;
 }
 
 /*
- * freeStmt
- * 		Free an Oracle statement handle and all its LOB locators.
+ * cancelFetch
+ * 		Interrupt the non-blocking fetch on the server connection
+ * 		and put the connection back into blocking mode, ignoring errors.
  */
-
 void
-freeStmt(OCIStmt *stmthp, struct connEntry *connp, OCIError *errhp)
+cancelFetch(struct srvEntry *srvp, OCIError *errhp)
 {
-	struct stmtHandleEntry *entry, *preventry = NULL;
-	struct lobLocatorEntry *locentry;
+	struct stmtHandleEntry *entry = srvp->pending_fetch;
 
-	/* find it in the linked list */
-	for (entry = connp->stmtlist; entry != NULL; entry = entry->next)
-	{
-		if (entry->stmthp == stmthp)
-			break;
+	(void)OCIBreak(srvp->srvhp, errhp);
+	(void)OCIReset(srvp->srvhp, errhp);
 
-		preventry = entry;
+	srvp->pending_fetch = NULL;
+	if (entry != NULL)
+	{
+		freeExecuteParams(entry, errhp);
+		entry->fetch_srvp = NULL;
+		entry->exec_svchp = NULL;
+		entry->no_data = 1;
+		entry->rows_fetched = 0;
 	}
 
-	if (entry == NULL)
-		oracleError(FDW_ERROR, "internal error freeing statement handle: not found in list");
+	(void)setNonblocking(srvp, errhp, 0);
+}
 
-	/* free all the LOB descriptors */
-	while (entry->loclist != NULL)
-	{
-		(void)OCIDescriptorFree(entry->loclist->lobloc, OCI_DTYPE_LOB);
-		locentry = entry->loclist->next;
-		free(entry->loclist);
-		entry->loclist = locentry;
-	}
+/*
+ * freeExecuteParams
+ * 		Free the indicators and collections of a non-blocking execute.
+ */
+void
+freeExecuteParams(struct stmtHandleEntry *entry, OCIError *errhp)
+{
+	int i;
 
-	/* free the statement handle */
-	(void)OCIStmtRelease(stmthp, errhp, (const OraText *)NULL, (ub4)0, OCI_DEFAULT);
+	if (entry->exec_indicators == NULL)
+		return;
 
-	/* remove it */
-	if (preventry == NULL)
-		connp->stmtlist = entry->next;
-	else
-		preventry->next = entry->next;
+	for (i=0; i<entry->exec_params; ++i)
+		if (entry->exec_collections[i] != NULL)
+			(void)OCIObjectFree(entry->exec_envhp, errhp, entry->exec_collections[i], 0);
 
-	free(entry);
+	free(entry->exec_indicators);
+	free(entry->exec_collections);
+	entry->exec_indicators = NULL;
+	entry->exec_collections = NULL;
+	entry->exec_params = 0;
 }
 
 /*
@@ -3347,6 +5058,63 @@ getOraType(oraType arg)
 	}
 }
 
+/*
+ * getDefineType
+ * 		Find the Oracle data type in which the values of a column are retrieved.
+ */
+ub2
+getDefineType(const struct oraColumn *column)
+{
+	switch (column->fetchtype)
+	{
+		case FETCH_NUMBER:
+			return SQLT_VNU;
+		case FETCH_BFLOAT:
+			return SQLT_BFLOAT;
+		case FETCH_BDOUBLE:
+			return SQLT_BDOUBLE;
+		case FETCH_DATE:
+			return SQLT_DAT;
+		case FETCH_TIMESTAMP:
+			return SQLT_TIMESTAMP;
+		case FETCH_TIMESTAMPTZ:
+			return SQLT_TIMESTAMP_TZ;
+		case FETCH_INTERVALYM:
+			return SQLT_INTERVAL_YM;
+		case FETCH_INTERVALDS:
+			return SQLT_INTERVAL_DS;
+		default:
+			/* the type input function will interpret the string value of a uuid correctly */
+			if (column->pgtype == UUIDOID)
+				return SQLT_STR;
+
+			return getOraType(column->oratype);
+	}
+}
+
+/*
+ * getDescriptorType
+ * 		Return the type of descriptor that has to be allocated for the values
+ * 		of a column, or 0 if the values are stored directly in "val".
+ */
+ub4
+getDescriptorType(const struct oraColumn *column)
+{
+	switch (column->fetchtype)
+	{
+		case FETCH_TIMESTAMP:
+			return OCI_DTYPE_TIMESTAMP;
+		case FETCH_TIMESTAMPTZ:
+			return OCI_DTYPE_TIMESTAMP_TZ;
+		case FETCH_INTERVALYM:
+			return OCI_DTYPE_INTERVAL_YM;
+		case FETCH_INTERVALDS:
+			return OCI_DTYPE_INTERVAL_DS;
+		default:
+			return 0;
+	}
+}
+
 /*
  * bind_out_callback
  * 		Point Oracle to where it should write the value for the output parameter.
@@ -3366,6 +5134,12 @@ bind_out_callback(void *octxp, OCIBind *bindp, ub4 iter, ub4 index, void **bufpp
 		*bufpp = *((OCILobLocator **)column->val);
 		*indp = column->val_null;
 	}
+	else if (getDescriptorType(column) != 0)
+	{
+		/* for datetime and interval values, data should be written to the descriptor */
+		*bufpp = *((void **)column->val);
+		*indp = column->val_null;
+	}
 	else if (column->oratype == ORA_TYPE_GEOMETRY)
 	{
 		ora_geometry *geom = (ora_geometry *)column->val;
@@ -3436,3 +5210,299 @@ setNullGeometry(oracleSession *session, ora_geometry *geom)
 	geom->geometry = null_geometry.geometry;
 	geom->indicator = null_geometry.indicator;
 }
+
+/*
+ * textToNumber
+ * 		Convert the string representation of a PostgreSQL number to an OCINumber.
+ */
+void
+textToNumber(oracleSession *session, const char *value, OCINumber *number)
+{
+	ub4 value_len = (ub4)strlen(value);
+	char *num_format;
+	const char *pos;
+
+	/*
+	 * Construct number format.
+	 */
+	num_format = oracleAlloc(value_len + 3);
+	/* fill everything with '9' */
+	memset(num_format, '9', value_len);
+	num_format[value_len] = '\0';
+	/* write 'D' in the decimal point position */
+	if ((pos = strchr(value, '.')) != NULL)
+		num_format[pos - value] = 'D';
+	/* replace the scientific notation part with 'EEEE' */
+	if ((pos = strchr(value, 'e')) != NULL)
+	{
+		memset(num_format + (pos - value), 'E', 4);
+		num_format[(pos - value) + 4] = '\0';
+	}
+
+	if (checkerr(
+		OCINumberFromText(session->envp->errhp, (const OraText *)value,
+			value_len, (const OraText *)num_format, (ub4)strlen(num_format),
+			(const OraText *)NULL, (ub4)0, number),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error executing query: OCINumberFromText failed to convert parameter",
+			oraMessage);
+	}
+	oracleFree(num_format);
+}
+
+/*
+ * executeErrorState
+ * 		Map the Oracle error code of a failed statement execution
+ * 		to the matching SQLSTATE.
+ */
+oraError
+executeErrorState(sb4 code)
+{
+	switch (code)
+	{
+		case 1:
+			return FDW_UNIQUE_VIOLATION;
+		case 60:
+			return FDW_DEADLOCK_DETECTED;
+		case 1400:
+			return FDW_NOT_NULL_VIOLATION;
+		case 2290:
+			return FDW_CHECK_VIOLATION;
+		case 2291:
+		case 2292:
+			return FDW_FOREIGN_KEY_VIOLATION;
+		case 8177:
+			return FDW_SERIALIZATION_FAILURE;
+		default:
+			return FDW_UNABLE_TO_CREATE_EXECUTION;
+	}
+}
+
+/*
+ * loadDirPathRows
+ * 		Convert the rows in the column array of a direct path load
+ * 		to a stream and send it to Oracle.
+ * 		If the stream is full before all rows are converted, the conversion
+ * 		continues after the stream has been loaded.
+ * 		Returns the number of rows sent.
+ */
+unsigned int
+loadDirPathRows(oracleSession *session)
+{
+	struct dirPathEntry *dirpath = session->connp->dirpath;
+	ub4 rowoff = 0, converted;
+	unsigned int rows;
+	sword result;
+
+	/* finish a non-blocking fetch on the connection */
+	if (session->srvp->pending_fetch != NULL)
+		finishFetch(session->srvp, session->envp->errhp, OCI_STILL_EXECUTING);
+
+	do
+	{
+		result = checkerr(
+			OCIDirPathColArrayToStream(dirpath->dpca, dirpath->dpctx, dirpath->dpstr,
+				session->envp->errhp, dirpath->rows, rowoff),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR);
+
+		if (result != OCI_SUCCESS && result != OCI_CONTINUE)
+		{
+			oracleError_d(executeErrorState(err_code),
+				"error loading data: OCIDirPathColArrayToStream failed to convert rows",
+				oraMessage);
+		}
+
+		if (checkerr(
+			OCIDirPathLoadStream(dirpath->dpctx, dirpath->dpstr, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(executeErrorState(err_code),
+				"error loading data: OCIDirPathLoadStream failed to load rows",
+				oraMessage);
+		}
+
+		/* the stream was full, continue after the rows converted so far */
+		if (result == OCI_CONTINUE)
+		{
+			if (checkerr(
+				OCIAttrGet((dvoid *)dirpath->dpca, OCI_HTYPE_DIRPATH_COLUMN_ARRAY, (dvoid *)&converted, (ub4 *)0,
+					OCI_ATTR_ROW_COUNT, session->envp->errhp),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+			{
+				oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+					"error loading data: OCIAttrGet failed to get number of converted rows",
+					oraMessage);
+			}
+			rowoff += converted;
+		}
+
+		if (checkerr(
+			OCIDirPathStreamReset(dirpath->dpstr, session->envp->errhp),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error loading data: OCIDirPathStreamReset failed to reset stream",
+				oraMessage);
+		}
+	} while (result == OCI_CONTINUE);
+
+	if (checkerr(
+		OCIDirPathColArrayReset(dirpath->dpca, session->envp->errhp),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error loading data: OCIDirPathColArrayReset failed to reset column array",
+			oraMessage);
+	}
+
+	rows = (unsigned int)dirpath->rows;
+	dirpath->rows = 0;
+
+	return rows;
+}
+
+/*
+ * freeDirPath
+ * 		Free the handles of the direct path load of a connection.
+ * 		If "abort" is true, the load is aborted first.  Errors are ignored.
+ */
+void
+freeDirPath(struct connEntry *connp, OCIError *errhp, int abort)
+{
+	struct dirPathEntry *dirpath = connp->dirpath;
+
+	if (abort && dirpath->dpctx != NULL)
+		(void)OCIDirPathAbort(dirpath->dpctx, errhp);
+
+	if (dirpath->dpstr != NULL)
+		(void)OCIHandleFree((dvoid *)dirpath->dpstr, OCI_HTYPE_DIRPATH_STREAM);
+	if (dirpath->dpca != NULL)
+		(void)OCIHandleFree((dvoid *)dirpath->dpca, OCI_HTYPE_DIRPATH_COLUMN_ARRAY);
+	if (dirpath->dpctx != NULL)
+		(void)OCIHandleFree((dvoid *)dirpath->dpctx, OCI_HTYPE_DIRPATH_CTX);
+
+	free(dirpath);
+	connp->dirpath = NULL;
+}
+
+/*
+ * getCollectionType
+ * 		Get the collection type used to bind an array parameter:
+ * 		SYS.ODCINUMBERLIST for numbers and SYS.ODCIVARCHAR2LIST for strings.
+ * 		The result is cached in the session's connEntry.
+ */
+OCIType *
+getCollectionType(oracleSession *session, oraBindType bindType)
+{
+	OCIType **type;
+	const char *name;
+
+	if (bindType == BIND_NUMBER_ARRAY)
+	{
+		type = &session->connp->numlisttype;
+		name = "ODCINUMBERLIST";
+	}
+	else
+	{
+		type = &session->connp->strlisttype;
+		name = "ODCIVARCHAR2LIST";
+	}
+
+	if (*type == NULL)
+	{
+		/* type is not cached, get it */
+		if (checkerr(
+			OCITypeByName(session->envp->envhp, session->envp->errhp, session->connp->svchp,
+				(const oratext *)"SYS", 3, (const oratext *)name, (ub4)strlen(name), NULL, 0,
+				OCI_DURATION_SESSION, OCI_TYPEGET_HEADER,
+				type), (dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_sd(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: cannot get type SYS.%s",
+				name, oraMessage);
+		}
+	}
+
+	return *type;
+}
+
+/*
+ * buildCollection
+ * 		Create a collection object with the elements of an array parameter.
+ * 		"value" starts with the number of elements in the first four bytes,
+ * 		followed by the elements as zero-terminated strings.  Empty strings
+ * 		represent NULL values, like everywhere in Oracle.
+ * 		The object lives until it is freed or the transaction ends.
+ */
+OCIColl *
+buildCollection(oracleSession *session, oraBindType bindType, const char *value)
+{
+	OCIColl *coll = NULL;
+	OCIString *str = NULL;
+	OCINumber number;
+	OCIInd ind;
+	sb4 count = *((sb4 *)value), i;
+	const char *elem = value + 4;
+
+	if (checkerr(
+		OCIObjectNew(session->envp->envhp, session->envp->errhp, session->connp->svchp,
+			OCI_TYPECODE_VARRAY, getCollectionType(session, bindType), (dvoid *)NULL,
+			OCI_DURATION_TRANS, TRUE, (dvoid **)&coll),
+		(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+	{
+		oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+			"error executing query: OCIObjectNew failed to allocate collection",
+			oraMessage);
+	}
+
+	for (i=0; i<count; ++i)
+	{
+		size_t len = strlen(elem);
+		dvoid *element;
+
+		ind = (len == 0) ? OCI_IND_NULL : OCI_IND_NOTNULL;
+
+		if (bindType == BIND_NUMBER_ARRAY)
+		{
+			if (len > 0)
+				textToNumber(session, elem, &number);
+			else
+				OCINumberSetZero(session->envp->errhp, &number);
+			element = (dvoid *)&number;
+		}
+		else
+		{
+			if (checkerr(
+				OCIStringAssignText(session->envp->envhp, session->envp->errhp,
+					(const oratext *)elem, (ub4)len, &str),
+				(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+			{
+				oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+					"error executing query: OCIStringAssignText failed to convert array element",
+					oraMessage);
+			}
+			element = (dvoid *)str;
+		}
+
+		/* this fails if the array has more elements than the collection type allows */
+		if (checkerr(
+			OCICollAppend(session->envp->envhp, session->envp->errhp,
+				(CONST dvoid *)element, (CONST dvoid *)&ind, coll),
+			(dvoid *)session->envp->errhp, OCI_HTYPE_ERROR) != OCI_SUCCESS)
+		{
+			oracleError_d(FDW_UNABLE_TO_CREATE_EXECUTION,
+				"error executing query: OCICollAppend failed to append array element",
+				oraMessage);
+		}
+
+		elem += len + 1;
+	}
+
+	/* free the temporary string */
+	if (str != NULL)
+		(void)OCIStringResize(session->envp->envhp, session->envp->errhp, 0, &str);
+
+	return coll;
+}
@@ -390,6 +390,80 @@ EXPLAIN (VERBOSE on, COSTS off) SELECT * FROM shorty;
 -- this should fetch all columns from the foreign table
 EXPLAIN (COSTS off) SELECT typetest1 FROM typetest1;
 
+/*
+ * Test direct modification.
+ */
+
+BEGIN;
+-- UPDATE and DELETE without RETURNING are executed as a single statement
+EXPLAIN (COSTS off) UPDATE typetest1 SET num = num + 1, vc = 'updated' WHERE id > 1;
+UPDATE typetest1 SET num = num + 1, vc = 'updated' WHERE id > 1;
+SELECT id, vc, num FROM typetest1 ORDER BY id;
+EXPLAIN (COSTS off) DELETE FROM typetest1 WHERE id = 4;
+DELETE FROM typetest1 WHERE id = 4;
+SELECT id FROM typetest1 ORDER BY id;
+ROLLBACK;
+
+/*
+ * Test batched INSERT, UPDATE and DELETE.
+ */
+
+ALTER FOREIGN TABLE shorty OPTIONS (ADD batch_size '3');
+BEGIN;
+EXPLAIN (COSTS off) INSERT INTO shorty (id, c) SELECT i, 'batch ' || i FROM generate_series(10, 14) AS i;
+INSERT INTO shorty (id, c) SELECT i, 'batch ' || i FROM generate_series(10, 14) AS i;
+SELECT id, c FROM shorty WHERE id >= 10 ORDER BY id;
+ROLLBACK;
+-- the error message names the failing row of the batch
+BEGIN;
+INSERT INTO shorty (id, c) VALUES (20, 'new'), (1, 'duplicate'), (21, 'new');
+ROLLBACK;
+-- UPDATE and DELETE that are not executed as a single statement use batches too
+BEGIN;
+INSERT INTO shorty (id, c) SELECT i, 'batch ' || i FROM generate_series(10, 14) AS i;
+EXPLAIN (COSTS off) UPDATE shorty SET c = 'updated' WHERE id >= 10 AND random() >= 0;
+UPDATE shorty SET c = 'updated' WHERE id >= 10 AND random() >= 0;
+SELECT id, c FROM shorty WHERE id >= 10 ORDER BY id;
+EXPLAIN (COSTS off) DELETE FROM shorty WHERE id >= 10 AND random() >= 0;
+DELETE FROM shorty WHERE id >= 10 AND random() >= 0;
+SELECT id, c FROM shorty WHERE id >= 10 ORDER BY id;
+ROLLBACK;
+ALTER FOREIGN TABLE shorty OPTIONS (DROP batch_size);
+-- values for LOB columns are not sent in batches
+BEGIN;
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD batch_size '3');
+INSERT INTO typetest1 (id, lc) SELECT i, repeat('x', i * 1000) FROM generate_series(10, 13) AS i;
+SELECT id, length(lc) FROM typetest1 WHERE id >= 10 ORDER BY id;
+ROLLBACK;
+
+/*
+ * Test INSERT ... ON CONFLICT DO NOTHING.
+ */
+
+BEGIN;
+-- rows that conflict on the key columns are skipped
+EXPLAIN (COSTS off) INSERT INTO shorty (id, c) VALUES (1, 'conflict'), (30, 'new') ON CONFLICT DO NOTHING;
+INSERT INTO shorty (id, c) VALUES (1, 'conflict'), (30, 'new') ON CONFLICT DO NOTHING;
+SELECT id, c FROM shorty WHERE id IN (1, 30) ORDER BY id;
+ROLLBACK;
+-- this should fail, MERGE cannot return values
+INSERT INTO shorty (id, c) VALUES (31, 'returned') ON CONFLICT DO NOTHING RETURNING id;
+-- this should fail, LOB values cannot be used in MERGE
+INSERT INTO typetest1 (id) VALUES (1) ON CONFLICT DO NOTHING;
+-- only the inserted rows of a batch are counted
+ALTER FOREIGN TABLE shorty OPTIONS (ADD batch_size '3');
+BEGIN;
+DO $$DECLARE
+   n bigint;
+BEGIN
+   INSERT INTO shorty (id, c) VALUES (40, 'new'), (1, 'conflict'), (41, 'new') ON CONFLICT DO NOTHING;
+   GET DIAGNOSTICS n = ROW_COUNT;
+   RAISE NOTICE '% rows inserted', n;
+END;$$;
+SELECT id, c FROM shorty WHERE id IN (1, 40, 41) ORDER BY id;
+ROLLBACK;
+ALTER FOREIGN TABLE shorty OPTIONS (DROP batch_size);
+
 /*
  * Test parameters.
  */
@@ -456,6 +530,34 @@ COPY typetest1 FROM STDIN;
 \.
 ROLLBACK;
 
+/*
+ * Test COPY with direct path load
+ */
+
+CREATE FOREIGN TABLE loady (
+   id  integer OPTIONS (key 'yes') NOT NULL,
+   vc  character varying(10),
+   d   date,
+   ts  timestamp with time zone
+) SERVER oracle OPTIONS (table 'TYPETEST1', load_mode 'direct_path');
+-- the loaded rows are committed in Oracle
+COPY loady FROM STDIN;
+100	direct	2019-05-01	2050-04-01 19:30:00.123456+02
+101	\N	1968-10-20	\N
+\.
+SELECT id, vc, d, ts FROM loady WHERE id >= 100 ORDER BY id;
+-- Oracle DATE loaded from "timestamp" uses a conventional INSERT
+ALTER FOREIGN TABLE loady ALTER d TYPE timestamp;
+BEGIN;
+COPY loady FROM STDIN;
+102	conv	2019-05-01 12:34:56	\N
+\.
+SELECT id, vc, d FROM loady WHERE id = 102;
+ROLLBACK;
+SELECT id FROM loady WHERE id >= 100 ORDER BY id;
+DELETE FROM loady WHERE id >= 100;
+DROP FOREIGN TABLE loady;
+
 /*
  * Test foreign table as a partition.
  */
@@ -535,6 +637,31 @@ EXPLAIN (COSTS off) SELECT id FROM typetest1 ORDER BY id, vc;
 EXPLAIN (COSTS off) SELECT id FROM typetest1 ORDER BY length(vc), CASE WHEN vc IS NULL THEN 0 ELSE 1 END, ts DESC NULLS FIRST FOR UPDATE;
 SELECT id FROM typetest1 ORDER BY length(vc), CASE WHEN vc IS NULL THEN 0 ELSE 1 END, ts DESC NULLS FIRST FOR UPDATE;
 
+/*
+ * Test aggregate pushdown.
+ */
+
+-- aggregates without GROUP BY
+EXPLAIN (COSTS off) SELECT count(*), count(d), min(id), max(id), sum(num) FROM typetest1;
+SELECT count(*), count(d), min(id), max(id), sum(num) FROM typetest1;
+-- GROUP BY a condition and HAVING
+EXPLAIN (COSTS off) SELECT id > 2 AS big, count(*), sum(id) FROM typetest1 GROUP BY id > 2 HAVING count(*) > 1;
+SELECT id > 2 AS big, count(*), sum(id) FROM typetest1 GROUP BY id > 2 HAVING count(*) > 1;
+-- min and max are not pushed down for strings
+EXPLAIN (COSTS off) SELECT max(vc) FROM typetest1;
+SELECT max(vc) FROM typetest1;
+
+/*
+ * Test LIMIT and OFFSET pushdown.
+ */
+
+-- push down LIMIT and OFFSET with ORDER BY
+EXPLAIN (COSTS off) SELECT id FROM typetest1 WHERE id > 1 ORDER BY id LIMIT 1 OFFSET 1;
+SELECT id FROM typetest1 WHERE id > 1 ORDER BY id LIMIT 1 OFFSET 1;
+-- don't push down LIMIT if Oracle cannot sort
+EXPLAIN (COSTS off) SELECT id FROM typetest1 ORDER BY vc DESC LIMIT 1;
+SELECT id FROM typetest1 ORDER BY vc DESC LIMIT 1;
+
 /*
  * Test that incorrect type mapping throws an error.
  */
@@ -574,6 +701,26 @@ EXECUTE stmt('{varlena,nonsense}');
 EXECUTE stmt('{varlena,nonsense}');
 DEALLOCATE stmt;
 
+/*
+ * Test array parameters bound as Oracle collections
+ */
+
+BEGIN;
+SET LOCAL plan_cache_mode = force_generic_plan;
+PREPARE stmt(integer[]) AS SELECT id, vc FROM typetest1 WHERE id = ANY ($1) ORDER BY id;
+EXPLAIN (COSTS off) EXECUTE stmt('{1,4,42}');
+EXECUTE stmt('{1,4,42}');
+DEALLOCATE stmt;
+PREPARE stmt(text[]) AS SELECT id FROM typetest1 WHERE vc = ANY ($1) ORDER BY id;
+EXECUTE stmt('{short,varlena}');
+DEALLOCATE stmt;
+-- "character" arrays are not pushed down because of the trailing blanks
+PREPARE stmt(character(10)[]) AS SELECT id FROM typetest1 WHERE c = ANY ($1) ORDER BY id;
+EXPLAIN (COSTS off) EXECUTE stmt('{short}');
+EXECUTE stmt('{short}');
+DEALLOCATE stmt;
+ROLLBACK;
+
 
 /* test ANALYZE */
 
@@ -643,3 +790,296 @@ SELECT * FROM typetest2 ORDER BY id;
 COMMIT;
 -- we need to re-establish the connection after changing "timezone"
 SELECT oracle_close_connections();
+
+/* test binary conversion of NUMBER to numeric against the string conversion */
+
+DO
+$$BEGIN
+   SELECT oracle_execute('oracle', 'DROP TABLE scott.numtest PURGE');
+EXCEPTION
+   WHEN OTHERS THEN
+      NULL;
+END;$$;
+SELECT oracle_execute(
+          'oracle',
+          E'CREATE TABLE scott.numtest (\n'
+          '   id  NUMBER(5) PRIMARY KEY,\n'
+          '   num NUMBER\n'
+          ') SEGMENT CREATION IMMEDIATE'
+       );
+SELECT oracle_execute(
+          'oracle',
+          E'INSERT INTO scott.numtest (id, num)\n'
+          '   SELECT 1, 0 FROM dual UNION ALL\n'
+          '   SELECT 2, 1 FROM dual UNION ALL\n'
+          '   SELECT 3, -1 FROM dual UNION ALL\n'
+          '   SELECT 4, 0.5 FROM dual UNION ALL\n'
+          '   SELECT 5, -0.5 FROM dual UNION ALL\n'
+          '   SELECT 6, 123.45 FROM dual UNION ALL\n'
+          '   SELECT 7, -98765.4321 FROM dual UNION ALL\n'
+          '   SELECT 8, 0.000000000123 FROM dual UNION ALL\n'
+          '   SELECT 9, 12345678901234567890.123 FROM dual UNION ALL\n'
+          '   SELECT 10, -99999999999999999999999999999999999999 FROM dual UNION ALL\n'
+          '   SELECT 11, 1000000.01 FROM dual UNION ALL\n'
+          '   SELECT 12, 1E30 FROM dual UNION ALL\n'
+          '   SELECT 13, NULL FROM dual'
+       );
+CREATE FOREIGN TABLE numtest (
+   id  integer OPTIONS (key 'yes') NOT NULL,
+   num numeric
+) SERVER oracle OPTIONS (table 'NUMTEST');
+CREATE FOREIGN TABLE numtest_text (
+   id  integer OPTIONS (key 'yes') NOT NULL,
+   num text
+) SERVER oracle OPTIONS (table 'NUMTEST');
+CREATE FOREIGN TABLE numtest_mod (
+   id  integer OPTIONS (key 'yes') NOT NULL,
+   num numeric(10,2)
+) SERVER oracle OPTIONS (table 'NUMTEST');
+SELECT id, num FROM numtest ORDER BY id;
+-- should return no rows
+SELECT id, n.num, t.num
+FROM numtest AS n JOIN numtest_text AS t USING (id)
+WHERE n.num::text IS DISTINCT FROM t.num::numeric::text;
+-- the type modifier is applied
+SELECT id, num FROM numtest_mod WHERE id < 8 ORDER BY id;
+-- this should fail
+SELECT id, num FROM numtest_mod WHERE id = 9;
+-- fetch the rows in batches determined by a memory limit
+ALTER FOREIGN TABLE numtest OPTIONS (ADD fetch_memory '1kB');
+SELECT id, num FROM numtest WHERE id < 4 ORDER BY id;
+-- this should fail
+ALTER FOREIGN TABLE numtest OPTIONS (SET fetch_memory '2GB');
+DROP FOREIGN TABLE numtest;
+DROP FOREIGN TABLE numtest_text;
+DROP FOREIGN TABLE numtest_mod;
+SELECT oracle_execute('oracle', 'DROP TABLE scott.numtest PURGE');
+
+/* test binary conversion of NUMBER to integer and floating point types */
+
+CREATE FOREIGN TABLE inttest (
+   id integer,
+   i2 smallint,
+   i4 integer,
+   i8 bigint,
+   f4 real,
+   f8 double precision
+) SERVER oracle OPTIONS (table '(SELECT 1 AS id, 32767 AS i2, 2147483647 AS i4, 9223372036854775807 AS i8, 3.5 AS f4, 0.1 AS f8 FROM dual UNION ALL SELECT 2, -32768, -2147483648, -9223372036854775808, -1E-30, -1E100 FROM dual UNION ALL SELECT 3, NULL, NULL, NULL, NULL, NULL FROM dual)');
+CREATE FOREIGN TABLE intoverflow (
+   i2       smallint,
+   i4       integer,
+   i8       bigint,
+   f4       real,
+   fraction integer
+) SERVER oracle OPTIONS (table '(SELECT 32768 AS i2, -2147483649 AS i4, 9223372036854775808 AS i8, 1E39 AS f4, 1.5 AS fraction FROM dual)');
+SELECT id, i2, i4, i8, f4, f8 FROM inttest ORDER BY id;
+-- these should fail
+SELECT i2 FROM intoverflow;
+SELECT i4 FROM intoverflow;
+SELECT i8 FROM intoverflow;
+SELECT f4 FROM intoverflow;
+SELECT fraction FROM intoverflow;
+DROP FOREIGN TABLE inttest;
+DROP FOREIGN TABLE intoverflow;
+
+/* test binary conversion of DATE, TIMESTAMP and INTERVAL with a round trip */
+
+DO
+$$BEGIN
+   SELECT oracle_execute('oracle', 'DROP TABLE scott.dttest PURGE');
+EXCEPTION
+   WHEN OTHERS THEN
+      NULL;
+END;$$;
+SELECT oracle_execute(
+          'oracle',
+          E'CREATE TABLE scott.dttest (\n'
+          '   id   NUMBER(5) PRIMARY KEY,\n'
+          '   d    DATE,\n'
+          '   ts   TIMESTAMP(6),\n'
+          '   tstz TIMESTAMP(6) WITH TIME ZONE,\n'
+          '   iym  INTERVAL YEAR(9) TO MONTH,\n'
+          '   ids  INTERVAL DAY(9) TO SECOND(6)\n'
+          ') SEGMENT CREATION IMMEDIATE'
+       );
+CREATE FOREIGN TABLE dttest (
+   id   integer OPTIONS (key 'yes') NOT NULL,
+   d    timestamp,
+   ts   timestamp,
+   tstz timestamp with time zone,
+   iym  interval,
+   ids  interval
+) SERVER oracle OPTIONS (table 'DTTEST');
+CREATE TEMP TABLE dtvalues (LIKE dttest);
+INSERT INTO dtvalues VALUES
+   (1, '2024-02-29 23:59:59', '2024-02-29 23:59:59.999999', '2024-02-29 23:59:59.999999+05:30', '-3 years -7 months', '-2 days -03:04:05.678901'),
+   (2, '0044-03-15 12:00:00 BC', '0044-03-15 12:00:00.000001 BC', '1970-01-01 00:00:00+00', '999999 years 11 months', '123456 days 23:59:59.999999'),
+   (3, '1900-01-01 00:00:00', '2100-12-31 00:00:00.5', '2050-07-01 12:00:00-08', '0 months', '0 seconds'),
+   (4, NULL, NULL, NULL, NULL, NULL);
+INSERT INTO dttest SELECT * FROM dtvalues;
+-- should return no rows
+(SELECT * FROM dttest EXCEPT SELECT * FROM dtvalues)
+UNION ALL
+(SELECT * FROM dtvalues EXCEPT SELECT * FROM dttest);
+-- this should fail
+CREATE FOREIGN TABLE dtoverflow (
+   id  integer,
+   iym interval
+) SERVER oracle OPTIONS (table '(SELECT 1 AS id, INTERVAL ''999999999-11'' YEAR(9) TO MONTH AS iym FROM dual)');
+SELECT id, iym FROM dtoverflow;
+DROP FOREIGN TABLE dtoverflow;
+DROP FOREIGN TABLE dttest;
+DROP TABLE dtvalues;
+SELECT oracle_execute('oracle', 'DROP TABLE scott.dttest PURGE');
+
+/* test TRUNCATE */
+
+DO
+$$BEGIN
+   SELECT oracle_execute('oracle', 'DROP TABLE scott.trunctest PURGE');
+EXCEPTION
+   WHEN OTHERS THEN
+      NULL;
+END;$$;
+SELECT oracle_execute(
+          'oracle',
+          E'CREATE TABLE scott.trunctest (\n'
+          '   id NUMBER(5) PRIMARY KEY\n'
+          ') SEGMENT CREATION IMMEDIATE'
+       );
+CREATE FOREIGN TABLE trunctest (
+   id integer OPTIONS (key 'yes') NOT NULL
+) SERVER oracle OPTIONS (table 'TRUNCTEST');
+INSERT INTO trunctest SELECT generate_series(1, 3);
+-- this should fail
+TRUNCATE trunctest;
+ALTER FOREIGN TABLE trunctest OPTIONS (ADD truncatable 'true');
+-- this should fail, because TRUNCATE would commit the INSERT
+BEGIN;
+INSERT INTO trunctest VALUES (4);
+TRUNCATE trunctest;
+ROLLBACK;
+TRUNCATE trunctest;
+SELECT count(*) FROM trunctest;
+DROP FOREIGN TABLE trunctest;
+SELECT oracle_execute('oracle', 'DROP TABLE scott.trunctest PURGE');
+
+/* test a pipelined fetch next to a normal scan on the same connection */
+
+CREATE FOREIGN TABLE pipey (id integer)
+   SERVER oracle OPTIONS (table '(SELECT LEVEL AS id FROM dual CONNECT BY LEVEL <= 10)', prefetch '2', pipeline_fetch 'true');
+CREATE FOREIGN TABLE plainy (id integer)
+   SERVER oracle OPTIONS (table '(SELECT LEVEL AS id FROM dual CONNECT BY LEVEL <= 10)', prefetch '2');
+BEGIN;
+SET LOCAL enable_hashjoin = off;
+SET LOCAL enable_nestloop = off;
+-- the merge join fetches from both scans in turn
+EXPLAIN (COSTS off) SELECT a.id FROM pipey a JOIN plainy b ON a.id = b.id WHERE b.id / 1 > 0 ORDER BY a.id;
+SELECT a.id FROM pipey a JOIN plainy b ON a.id = b.id WHERE b.id / 1 > 0 ORDER BY a.id;
+ROLLBACK;
+DROP FOREIGN TABLE pipey;
+DROP FOREIGN TABLE plainy;
+
+/* test an asynchronous Append with a synchronous partition on the same server */
+
+CREATE TABLE seqparts (id integer) PARTITION BY RANGE (id);
+CREATE FOREIGN TABLE seqpart1 PARTITION OF seqparts FOR VALUES FROM (1) TO (11)
+   SERVER oracle OPTIONS (table '(SELECT LEVEL AS id FROM dual CONNECT BY LEVEL <= 10)', prefetch '2', async_capable 'true');
+CREATE FOREIGN TABLE seqpart2 PARTITION OF seqparts FOR VALUES FROM (11) TO (21)
+   SERVER oracle OPTIONS (table '(SELECT LEVEL + 10 AS id FROM dual CONNECT BY LEVEL <= 10)', prefetch '2');
+EXPLAIN (COSTS off) SELECT id FROM seqparts;
+SELECT count(*), sum(id) FROM seqparts;
+DROP TABLE seqparts;
+
+/* test a parallel foreign scan against a serial scan */
+
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD parallel_workers '2');
+BEGIN;
+SET LOCAL parallel_setup_cost = 0;
+SET LOCAL parallel_tuple_cost = 0;
+SET LOCAL max_parallel_workers_per_gather = 2;
+EXPLAIN (COSTS off) SELECT id, vc FROM typetest1;
+CREATE TEMP TABLE parallel_scan AS SELECT id, vc FROM typetest1;
+SET LOCAL max_parallel_workers_per_gather = 0;
+-- should return no rows
+(SELECT id, vc FROM parallel_scan EXCEPT ALL SELECT id, vc FROM typetest1)
+UNION ALL
+(SELECT id, vc FROM typetest1 EXCEPT ALL SELECT id, vc FROM parallel_scan);
+SELECT count(*) FROM parallel_scan;
+ROLLBACK;
+ALTER FOREIGN TABLE typetest1 OPTIONS (DROP parallel_workers);
+
+/* test repeated execution of the same Oracle statement */
+
+BEGIN;
+SET LOCAL plan_cache_mode = force_generic_plan;
+PREPARE stmt(integer) AS SELECT id, vc FROM typetest1 WHERE id = $1;
+EXECUTE stmt(1);
+EXECUTE stmt(4);
+EXECUTE stmt(1);
+DEALLOCATE stmt;
+-- the scan on the inner side of the nested loop is executed again for each row
+CREATE TEMP TABLE keys (k integer);
+INSERT INTO keys VALUES (1), (3), (4);
+EXPLAIN (COSTS off) SELECT k, id FROM keys, LATERAL (SELECT id FROM typetest1 WHERE id / k = 1) AS t ORDER BY k, id;
+SELECT k, id FROM keys, LATERAL (SELECT id FROM typetest1 WHERE id / k = 1) AS t ORDER BY k, id;
+ROLLBACK;
+
+/* test a parameterized foreign scan on the inner side of a nested loop */
+
+CREATE FOREIGN TABLE squares (id integer, square integer)
+   SERVER oracle OPTIONS (table '(SELECT LEVEL AS id, LEVEL * LEVEL AS square FROM dual CONNECT BY LEVEL <= 1000)');
+ANALYZE squares;
+BEGIN;
+CREATE TEMP TABLE keys (k integer);
+INSERT INTO keys VALUES (12);
+ANALYZE keys;
+SET LOCAL enable_hashjoin = off;
+SET LOCAL enable_mergejoin = off;
+SET LOCAL enable_material = off;
+EXPLAIN (COSTS off) SELECT k, square FROM keys JOIN squares ON id = k;
+SELECT k, square FROM keys JOIN squares ON id = k;
+ROLLBACK;
+DROP FOREIGN TABLE squares;
+
+/* test the option "use_remote_estimate" */
+-- this should fail
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD use_remote_estimate 'maybe');
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD use_remote_estimate 'on');
+EXPLAIN (COSTS off) SELECT id, vc FROM typetest1 WHERE id = 1;
+SELECT id, vc FROM typetest1 WHERE id = 1;
+ALTER FOREIGN TABLE typetest1 OPTIONS (DROP use_remote_estimate);
+
+/* test the option "import_statistics" */
+-- this should fail
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD import_statistics 'maybe');
+SELECT oracle_execute(
+          'oracle',
+          E'BEGIN\n'
+          '   DBMS_STATS.GATHER_TABLE_STATS (''SCOTT'', ''TYPETEST1'', estimate_percent => 100, method_opt => ''FOR COLUMNS ID SIZE 254'');\n'
+          'END;'
+       );
+ALTER FOREIGN TABLE typetest1 OPTIONS (ADD import_statistics 'on');
+ANALYZE typetest1;
+-- the frequency histogram becomes a list of most common values
+SELECT null_frac, n_distinct,
+       ARRAY(SELECT v FROM unnest(most_common_vals::text::integer[]) AS v ORDER BY v) AS most_common_vals
+FROM pg_stats WHERE tablename = 'typetest1' AND attname = 'id';
+ALTER FOREIGN TABLE typetest1 OPTIONS (DROP import_statistics);
+
+/* test the sample size chosen from outdated Oracle statistics */
+SELECT oracle_execute(
+          'oracle',
+          E'BEGIN\n'
+          '   DBMS_STATS.SET_TABLE_STATS (''SCOTT'', ''TYPETEST1'', numrows => 1000000);\n'
+          'END;'
+       );
+-- the sample is too small, so the whole table is read
+ANALYZE typetest1;
+SELECT reltuples FROM pg_class WHERE relname = 'typetest1';
+SELECT oracle_execute(
+          'oracle',
+          E'BEGIN\n'
+          '   DBMS_STATS.GATHER_TABLE_STATS (''SCOTT'', ''TYPETEST1'', NULL, 100);\n'
+          'END;'
+       );
@@ -60,6 +60,17 @@ SELECT t1.id, t2.id FROM typetest1  t1 RIGHT JOIN typetest1  t2 ON t1.d = t2.d W
 EXPLAIN (COSTS off)
 SELECT t1.id, t2.id FROM typetest1  t1 FULL  JOIN typetest1  t2 ON t1.d = t2.d WHERE t1.id > 1 ORDER BY t1.id, t2.id;
 SELECT t1.id, t2.id FROM typetest1  t1 FULL  JOIN typetest1  t2 ON t1.d = t2.d WHERE t1.id > 1 ORDER BY t1.id, t2.id;
+-- semi-join, pushed down as EXISTS
+EXPLAIN (COSTS off)
+SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
+SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
+EXPLAIN (COSTS off)
+SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d AND t2.id > 1) ORDER BY t1.id;
+SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d AND t2.id > 1) ORDER BY t1.id;
+-- anti-join, pushed down as NOT EXISTS
+EXPLAIN (COSTS off)
+SELECT t1.id FROM typetest1  t1 WHERE NOT EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
+SELECT t1.id FROM typetest1  t1 WHERE NOT EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
 
 /*
  * Cases that should not be pushed down.
@@ -110,14 +121,6 @@ ON subq1.c1 = subq2.c2 ORDER BY subq2.c3;
 EXPLAIN (COSTS off)
 SELECT 1 FROM (SELECT 1 FROM typetest1  WHERE false) AS subq1 RIGHT JOIN typetest1  AS ref1 ON NULL ORDER BY ref1.id;
 SELECT 1 FROM (SELECT 1 FROM typetest1  WHERE false) AS subq1 RIGHT JOIN typetest1  AS ref1 ON NULL ORDER BY ref1.id;
--- semi-join, not pushed down
-EXPLAIN (COSTS off)
-SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
-SELECT t1.id FROM typetest1  t1 WHERE EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
--- anti-join, not pushed down
-EXPLAIN (COSTS off)
-SELECT t1.id FROM typetest1  t1 WHERE NOT EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
-SELECT t1.id FROM typetest1  t1 WHERE NOT EXISTS (SELECT 1 FROM typetest1  t2 WHERE t1.d = t2.d) ORDER BY t1.id;
 -- cross join, not pushed down
 EXPLAIN (COSTS off)
 SELECT t1.id, t2.id FROM typetest1  t1 CROSS JOIN typetest1  t2 ORDER BY t1.id, t2.id;
@@ -151,7 +154,7 @@ SELECT t1.id, t2.id FROM typetest1  t1 FULL  JOIN (SELECT * FROM typetest1  WHER
 SELECT t1.id, t2.id FROM typetest1  t1 FULL  JOIN (SELECT * FROM typetest1  WHERE vc = 'short') t2 ON true ORDER BY t1.id, t2.id;
 -- update statement, not pushed down
 EXPLAIN (COSTS off) UPDATE typetest1 t1 SET c = NULL FROM typetest1 t2 WHERE t1.vc = t2.vc AND t2.num = 3.14159;
--- join with FOR UPDATE, not pushed down
+-- join with FOR UPDATE, pushed down with a local join for EvalPlanQual
 EXPLAIN (COSTS off) SELECT t1.id FROM typetest1 t1, typetest1 t2 WHERE t1.id = t2.id FOR UPDATE;
 -- join in CTE
 WITH t (t1_id, t2_id) AS (SELECT t1.id, t2.id FROM typetest1  t1 JOIN typetest1  t2 ON t1.d = t2.d) SELECT t1_id, t2_id FROM t ORDER BY t1_id, t2_id;
@@ -171,7 +174,11 @@ SELECT t1, t1.ctid FROM shorty t1 FULL  JOIN longy t2 ON t1.id = t2.id ORDER BY
 EXPLAIN (COSTS off)
 SELECT t1, t1.ctid FROM shorty t1 CROSS JOIN longy t2 ORDER BY t1.id;
 SELECT t1, t1.ctid FROM shorty t1 CROSS JOIN longy t2 ORDER BY t1.id;
--- only part of a three-way join will be pushed down
+-- whole-row reference of the nullable side of an outer join
+EXPLAIN (COSTS off)
+SELECT t1.id, t2 FROM shorty t1 LEFT JOIN shorty t2 ON t1.id = t2.id + 2 ORDER BY t1.id;
+SELECT t1.id, t2 FROM shorty t1 LEFT JOIN shorty t2 ON t1.id = t2.id + 2 ORDER BY t1.id;
+-- joins of three tables are pushed down completely
 ---- inner join three tables
 EXPLAIN (COSTS off)
 SELECT t1.id, t3.id FROM typetest1  t1 JOIN typetest1  t2 USING (nvc) JOIN typetest1  t3 ON t2.db = t3.db ORDER BY t1.id, t3.id;
@@ -239,6 +246,10 @@ SELECT t1.id, t2.id, t3.id FROM typetest1  t1 FULL  JOIN typetest1  t2 ON t1.d =
 EXPLAIN (COSTS off)
 SELECT t1.id, t2.id, t3.id FROM typetest1  t1 FULL  JOIN typetest1  t2 ON t1.d = t2.d RIGHT JOIN typetest1  t3 ON t2.d = t3.d ORDER BY t1.id, t2.id;
 SELECT t1.id, t2.id, t3.id FROM typetest1  t1 FULL  JOIN typetest1  t2 ON t1.d = t2.d RIGHT JOIN typetest1  t3 ON t2.d = t3.d ORDER BY t1.id, t2.id;
+-- join of four tables
+EXPLAIN (COSTS off)
+SELECT t1.id, t4.id FROM typetest1  t1 JOIN typetest1  t2 ON t1.id = t2.id JOIN typetest1  t3 ON t2.c = t3.c JOIN typetest1  t4 ON t3.d = t4.d ORDER BY t1.id, t4.id;
+SELECT t1.id, t4.id FROM typetest1  t1 JOIN typetest1  t2 ON t1.id = t2.id JOIN typetest1  t3 ON t2.c = t3.c JOIN typetest1  t4 ON t3.d = t4.d ORDER BY t1.id, t4.id;
 -- join with LATERAL reference
 EXPLAIN (COSTS off)
 SELECT t1.id, sl.c FROM typetest1  t1, LATERAL (SELECT DISTINCT s.c FROM shorty s,   longy l WHERE s.id = l.id AND l.c = t1.c) sl ORDER BY t1.id, sl.c;